@@ -0,0 +1,226 @@
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+//
+// CCL parser throughput benchmark. This measures the number of tokens
+// (words) per second processed by the CCL parser. This is not part of the
+// parser. It is built by 'make bench' (in the top directory) and run as:
+//
+// cclbench <input file> [<number of passes>]
+//
+// The input file is read as plain text with one utterance per line and
+// the words separated by white space (there is no punctuation processing,
+// so punctuation marks should be separated from the words or removed).
+// The following are measured, each over <number of passes> passes over
+// the whole input (default 1):
+//
+// units: only creating the units (looking up the words and labels in
+//        the lexicon and constructing the unit objects). The utterance
+//        is cleared without being processed. This is measured once with
+//        an empty lexicon (new words) and once with the lexicon after
+//        learning (mostly existing words).
+// learn: learning from each utterance.
+// parse: parsing each utterance (with the lexicon learned).
+// lookup: only looking up the (lower case version of) each word in the
+//         lexicon after learning, once by converting a copy of the word to
+//         lower case and looking up this copy ('copy') and once through
+//         the case folding lookup used when creating units ('fold').
+// parse (compacted): parsing again, after compacting the lexicon (see
+//                    CCCLLexicon::Compact()). The time taken by the
+//                    compaction is also printed.
+//
+
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include "StringUtil.h"
+#include "CCLParser.h"
+
+using namespace std;
+
+// current time in nanoseconds
+
+static double
+NowNs()
+{
+    struct timespec Time;
+
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    return Time.tv_sec * 1e9 + Time.tv_nsec;
+}
+
+// the input utterances
+typedef vector<vector<string> > tUtterances;
+
+static unsigned int
+ReadUtterances(char const* pFileName, tUtterances& Utterances)
+{
+    ifstream In(pFileName);
+    string Line;
+    unsigned int TokenNum = 0;
+
+    while(getline(In, Line)) {
+        istringstream Words(Line);
+        string Word;
+        vector<string> Utterance;
+
+        while(Words >> Word)
+            Utterance.push_back(Word);
+
+        if(Utterance.empty())
+            continue;
+
+        TokenNum += Utterance.size();
+        Utterances.push_back(Utterance);
+    }
+
+    return TokenNum;
+}
+
+// Pushes all utterances (PassNum times) through the parser. If bProcess
+// is false, the units are only created (and the utterance cleared).
+// Returns the number of tokens per second.
+
+static double
+RunPasses(CCCLParser* pParser, tUtterances& Utterances, unsigned int TokenNum,
+          unsigned int PassNum, bool bProcess)
+{
+    vector<string> Labels; // no labels
+    double Time = NowNs();
+
+    for(unsigned int Pass = 0 ; Pass < PassNum ; Pass++) {
+        for(tUtterances::iterator Iter = Utterances.begin() ;
+            Iter != Utterances.end() ; Iter++) {
+            for(vector<string>::iterator WIter = Iter->begin() ;
+                WIter != Iter->end() ; WIter++)
+                pParser->PushInputUnit(*WIter, Labels);
+            if(bProcess)
+                pParser->PushInputPunct(eEoUtterance);
+            pParser->ClearUtterance();
+        }
+    }
+
+    Time = NowNs() - Time;
+
+    return Time > 0 ? (double)TokenNum * PassNum * 1e9 / Time : 0;
+}
+
+// Looks up all words (PassNum times) in the lexicon. If bFold is false,
+// the word is copied and converted to lower case before lookup. Returns
+// the number of tokens per second.
+
+static double
+RunLookups(CCCLLexicon* pLexicon, tUtterances& Utterances,
+           unsigned int TokenNum, unsigned int PassNum, bool bFold)
+{
+    unsigned int Found = 0;
+    double Time = NowNs();
+
+    for(unsigned int Pass = 0 ; Pass < PassNum ; Pass++) {
+        for(tUtterances::iterator Iter = Utterances.begin() ;
+            Iter != Utterances.end() ; Iter++) {
+            for(vector<string>::iterator WIter = Iter->begin() ;
+                WIter != Iter->end() ; WIter++) {
+                if(bFold) {
+                    CCCLLexEntry* pEntry;
+                    if(pLexicon->FindEntryByLowerString(*WIter, pEntry))
+                        Found++;
+                } else {
+                    string LCName = *WIter;
+                    ToLower(LCName);
+                    CpCCCLLexEntry pEntry;
+                    if(pLexicon->GetEntryByString(LCName, pEntry))
+                        Found++;
+                }
+            }
+        }
+    }
+
+    Time = NowNs() - Time;
+
+    if(Found != TokenNum * PassNum)
+        fprintf(stderr, "lookup: %u of %u tokens found\n", Found,
+                TokenNum * PassNum);
+
+    return Time > 0 ? (double)TokenNum * PassNum * 1e9 / Time : 0;
+}
+
+int
+main(int ac, char** av)
+{
+    if(ac < 2) {
+        fprintf(stderr, "usage: %s <input file> [<number of passes>]\n",
+                av[0]);
+        return 1;
+    }
+
+    unsigned int PassNum = ac > 2 ? atoi(av[2]) : 1;
+    tUtterances Utterances;
+    unsigned int TokenNum = ReadUtterances(av[1], Utterances);
+
+    if(!PassNum)
+        PassNum = 1;
+
+    if(!TokenNum) {
+        fprintf(stderr, "no tokens in '%s'\n", av[1]);
+        return 1;
+    }
+
+    printf("%u utterances, %u tokens, %u passes\n\n",
+           (unsigned int)Utterances.size(), TokenNum, PassNum);
+    printf("%-22s %14s\n", "", "tokens/sec");
+
+    CpCCCLParser pParser = new CCCLParser(NULL);
+
+    pParser->SetLearnCycle(false);
+    pParser->SetParseCycle(false);
+    printf("%-22s %14.0f\n", "units (new lexicon)",
+           RunPasses(pParser, Utterances, TokenNum, 1, false));
+
+    CpCCCLLexicon pLexicon = new CCCLLexicon();
+
+    pParser = new CCCLParser(pLexicon);
+    pParser->SetLearnCycle(true);
+    printf("%-22s %14.0f\n", "learn",
+           RunPasses(pParser, Utterances, TokenNum, PassNum, true));
+
+    pParser->SetLearnCycle(false);
+    printf("%-22s %14.0f\n", "units (learned)",
+           RunPasses(pParser, Utterances, TokenNum, PassNum, false));
+
+    pParser->SetParseCycle(true);
+    printf("%-22s %14.0f\n", "parse",
+           RunPasses(pParser, Utterances, TokenNum, PassNum, true));
+
+    printf("%-22s %14.0f\n", "lookup (copy)",
+           RunLookups(pLexicon, Utterances, TokenNum, PassNum, false));
+    printf("%-22s %14.0f\n", "lookup (fold)",
+           RunLookups(pLexicon, Utterances, TokenNum, PassNum, true));
+
+    double Time = NowNs();
+    pLexicon->Compact();
+    Time = NowNs() - Time;
+
+    printf("%-22s %14.0f\n", "parse (compacted)",
+           RunPasses(pParser, Utterances, TokenNum, PassNum, true));
+    printf("\ncompaction: %.3f sec\n", Time * 1e-9);
+
+    return 0;
+}
@@ -218,7 +218,7 @@ CCCLBrackets::UpdateBrackets()
             
             // do not extend the bracket
             m_CoverLast.back()->m_End[RIGHT] = LastNode() - 1;
-            pMaxNotExtended = m_CoverLast.back();
+            pMaxNotExtended = MOVE_PTR(m_CoverLast.back());
             m_CoverLast.pop_back();
         } else
             break;
@@ -233,7 +233,7 @@ CCCLBrackets::UpdateBrackets()
                 break;
             m_MaxNotEnd.pop_back();
         }
-        m_MaxNotEnd.push_back(pMaxNotExtended);
+        m_MaxNotEnd.push_back(MOVE_PTR(pMaxNotExtended));
     }
     
     // Check whether a depth 1 link from the prefix to the last node
@@ -254,7 +254,7 @@ CCCLBrackets::UpdateBrackets()
         }
         pNew->m_Dominated.push_back(m_B1x[Inbound.m_End]);
         
-        m_CoverLast.push_back(pNew);
+        m_CoverLast.push_back(MOVE_PTR(pNew));
     }
 
     // Add brackets which are generated by the last word
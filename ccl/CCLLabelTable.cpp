@@ -55,14 +55,19 @@ CCCLLabelTable::SetUnitLabel(CStrKey* pString, float Strg,
         yPError(ERR_OUT_OF_RANGE, "invalid side");
 
     // flip the label before adding it
-    CpCLabel pLabel = new CLabel(LB_OTHER_SIDE, pString);
+    CLabel Label(LB_OTHER_SIDE, pString);
 
-    CpCLabelVal pVal;
-    
     if(Side == BOTH_SIDES) {
-        pVal = AddLabel(pLabel, LEFT, Strg);
-        AddLabel(pVal, RIGHT, Strg);
+        CStrgPos Pos = Find(Label);
+        if(!Pos) {
+            // new label: add it to both top lists
+            Pos = IncStrength(Label, LEFT, Strg);
+            AddLabel(Pos.Key(), Pos.Val(), RIGHT, Strg);
+        } else {
+            AddLabel(Pos.Val(), LEFT, Strg);
+            AddLabel(Pos.Val(), RIGHT, Strg);
+        }
     } else {
-        AddLabel(pLabel, Side, Strg);
+        AddLabel(Label, Side, Strg);
     }
 }
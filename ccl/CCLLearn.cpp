@@ -103,6 +103,11 @@ CCCLLearn::Learn()
                                                      CCCLStat::eLearn);
         }
     }
+
+    // units created from now on must use a new copy of the statistics
+    pStat->IncVersion();
+    if(m_AdjPos.m_Pos == 0)
+        m_pUnit->GetAdjStats(Side)->UpdateStatCopy();
 }
 
 ////////////////////
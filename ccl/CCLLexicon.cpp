@@ -14,9 +14,18 @@
 // You should have received a copy of the GNU General Public License
 // along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <vector>
+#include <sstream>
+#include <algorithm>
 #include "Globals.h"
+#include "ObjStats.h"
+#include "Pool.h"
+#include "BinIO.h"
 #include "ListPrint.h"
+#include "yError.h"
+#include "Intern.h"
 #include "CCLLexicon.h"
+#include "CCLMappedLexicon.h"
 
 using namespace std;
 
@@ -30,8 +39,8 @@ CCCLLexEntry::CCCLLexEntry(unsigned int InitialCount) :
 #ifdef DETAILED_DEBUG
     IncObjCount();
 #endif
-    m_Stats[LEFT] = new CCCLStat();
-    m_Stats[RIGHT] = new CCCLStat();
+    m_Stats[LEFT] = new CCCLAdjStats();
+    m_Stats[RIGHT] = new CCCLAdjStats();
 }
 
 CCCLLexEntry::~CCCLLexEntry()
@@ -41,6 +50,41 @@ CCCLLexEntry::~CCCLLexEntry()
 #endif
 }
 
+void
+CCCLLexEntry::Merge(CCCLLexEntry* pEntry)
+{
+    if(!pEntry) {
+        yPError(ERR_MISSING, "lexical entry missing");
+    }
+
+    m_Count += pEntry->m_Count;
+
+    for(unsigned int Side = LEFT ; Side <= RIGHT ; Side++) {
+        CCCLAdjStats* pOther = pEntry->m_Stats[Side];
+        
+        for(unsigned int Pos = 0 ; Pos < pOther->Length() ; Pos++)
+            m_Stats[Side]->GetStat(Pos, true)->Merge(pOther->GetStat(Pos));
+        m_Stats[Side]->UpdateStatCopy();
+    }
+}
+
+void
+CCCLLexEntry::MarkStrings()
+{
+    for(unsigned int Side = LEFT ; Side <= RIGHT ; Side++)
+        for(unsigned int Pos = 0 ; Pos < m_Stats[Side]->Length() ; Pos++)
+            m_Stats[Side]->GetStat(Pos)->MarkStrings();
+}
+
+void
+CCCLLexEntry::Freeze()
+{
+    for(unsigned int Side = LEFT ; Side <= RIGHT ; Side++)
+        m_Stats[Side]->Freeze();
+
+    MakeImmortal();
+}
+
 void
 CCCLLexEntry::PrintObj(CRefOStream* pOut, unsigned int Indent,
                        unsigned int SubIndent, eFormat Format,
@@ -55,16 +99,15 @@ CCCLLexEntry::PrintObj(CRefOStream* pOut, unsigned int Indent,
     LexEntryList.IncIndent(1);
 
     for(unsigned int Side = LEFT ; Side <= RIGHT ; Side++) {
-        CpCCCLStat m_pStat = m_Stats[Side];
-        unsigned int Count = 1;
-        
-        while(m_pStat && !m_pStat->IsEmpty()) {
-            LexEntryList << (Side == LEFT ? "Left" : "Right")
-                         << " " << Count << ":";
-            LexEntryList.PrintNextEntry(m_pStat.Ptr(),0);
+        for(unsigned int Pos = 0 ; Pos < m_Stats[Side]->Length() ; Pos++) {
+            CCCLStat* pStat = m_Stats[Side]->GetStat(Pos);
 
-            m_pStat = m_pStat->GetNext(false);
-            Count++;
+            if(pStat->IsEmpty())
+                break;
+            
+            LexEntryList << (Side == LEFT ? "Left" : "Right")
+                         << " " << Pos + 1 << ":";
+            LexEntryList.PrintNextEntry(pStat, 0);
         }
     }
 
@@ -75,14 +118,27 @@ CCCLLexEntry::PrintObj(CRefOStream* pOut, unsigned int Indent,
 // Lexicon //
 /////////////
 
-CCCLLexicon::CCCLLexicon()
+set<CCCLLexicon*>* CCCLLexicon::m_pLexicons = NULL;
+bool CCCLLexicon::m_bCollectStrings = false;
+bool CCCLLexicon::m_bAnyShared = false;
+CMutex CCCLLexicon::m_LexiconsMutex;
+
+CCCLLexicon::CCCLLexicon() :
+        m_bShared(false), m_PruneNum(0), m_EvictedNum(0)
 {
 #ifdef DETAILED_DEBUG
     IncObjCount();
 #endif
+    CMutexLock Lock(m_LexiconsMutex);
+    
+    if(!m_pLexicons)
+        m_pLexicons = new set<CCCLLexicon*>();
+    m_pLexicons->insert(this);
+    
     if(g_LexMinPrint) {
-        m_PrintBound.first = new CStrKey("");
-        m_PrintBound.second = new CCCLLexEntry(g_LexMinPrint);
+        m_PrintBound.first = m_pPrintBoundKey = new CStrKey("");
+        m_PrintBound.second = m_pPrintBoundEntry =
+            new CCCLLexEntry(g_LexMinPrint);
     }
 }
 
@@ -91,11 +147,26 @@ CCCLLexicon::~CCCLLexicon()
 #ifdef DETAILED_DEBUG
     DecObjCount();
 #endif
+    CMutexLock Lock(m_LexiconsMutex);
+    
+    m_pLexicons->erase(this);
+    // the strings of this lexicon may no longer be used
+    m_bCollectStrings = true;
 }
 
 CStrKey*
 CCCLLexicon::GetEntryByString(string const& Name, CpCCCLLexEntry& pEntry)
 {
+    if(m_bShared) {
+        yPError(ERR_OUT_OF_RANGE, "a shared lexicon cannot be modified");
+    }
+
+    if(m_pShared) {
+        CStrKey* pSharedKey = m_pShared->FindEntryByString(Name, pEntry);
+        if(pSharedKey)
+            return pSharedKey;
+    }
+    
     CpCLexEntry pGenericEntry;
     CpCStrKey pKey = CStrLexicon::GetEntryByString(Name, pGenericEntry);
 
@@ -108,13 +179,72 @@ CCCLLexicon::GetEntryByString(string const& Name, CpCCCLLexEntry& pEntry)
     return pKey;
 }
 
+CStrKey*
+CCCLLexicon::FindEntryByString(string const& Name, CpCCCLLexEntry& pEntry)
+{
+    if(m_pShared) {
+        CStrKey* pSharedKey = m_pShared->FindEntryByString(Name, pEntry);
+        if(pSharedKey)
+            return pSharedKey;
+    }
+    
+    CpCLexEntry pGenericEntry;
+    CStrKey* pKey = CStrLexicon::FindEntryByString(Name, pGenericEntry);
+
+    pEntry = (CCCLLexEntry*)(pGenericEntry.Ptr());
+    return pKey;
+}
+
+CStrKey*
+CCCLLexicon::FindOrMapEntryByString(string const& Name,
+                                    CpCCCLLexEntry& pEntry)
+{
+    CStrKey* pKey = FindEntryByString(Name, pEntry);
+
+    if(pKey || !m_pMapped || !m_pMapped->FindEntry(Name))
+        return pKey;
+
+    return GetEntryByString(Name, pEntry);
+}
+
+CStrKey*
+CCCLLexicon::FindEntryByLowerString(string const& Name, CCCLLexEntry*& pEntry)
+{
+    if(m_pShared) {
+        CStrKey* pSharedKey = m_pShared->FindEntryByLowerString(Name, pEntry);
+        if(pSharedKey)
+            return pSharedKey;
+    }
+    
+    CLexEntry* pGenericEntry;
+    CStrKey* pKey = CStrLexicon::FindEntryByLowerString(Name, pGenericEntry);
+
+    pEntry = (CCCLLexEntry*)pGenericEntry;
+    return pKey;
+}
+
+// Entries are printed in decreasing order of their count. Entries with
+// the same count are ordered by their strings, so that the order does not
+// depend on the order of the entries in the table. The empty string (the
+// key of the print bound, see PrintBound()) is ordered after all other
+// strings, so that the entries whose count is equal to the bound are
+// printed.
 static bool
 LexMoreFreqComp(LexPair const& pA, LexPair const& pB)
 {
     if(!pA.second)
         return false;
-    
-    return (!pB.second || pA.second->Count() > pB.second->Count());
+
+    if(!pB.second)
+        return true;
+
+    if(pA.second->Count() != pB.second->Count())
+        return pA.second->Count() > pB.second->Count();
+
+    if(!pB.first->Length())
+        return pA.first->Length() != 0;
+
+    return (pA.first->Length() && *pA.first < *pB.first);
 }
 
 tLexComp
@@ -135,3 +265,311 @@ CCCLLexicon::NewEmptyLexEntry()
 {
     return new CCCLLexEntry();
 }
+
+CLexEntry*
+CCCLLexicon::NewLexEntry(string const& Name)
+{
+    CCCLLexEntry* pEntry = new CCCLLexEntry();
+
+    if(m_pMapped) {
+        size_t Offset = m_pMapped->FindEntry(Name);
+        if(Offset && !m_pMapped->ReadEntry(Offset, pEntry)) {
+            // the entry is corrupt, so the word is treated as new
+            delete pEntry;
+            pEntry = new CCCLLexEntry();
+        }
+    }
+
+    return pEntry;
+}
+
+void
+CCCLLexicon::SetMapped(CCCLMappedLexicon* pMapped)
+{
+    m_pMapped = pMapped;
+}
+
+/////////////
+// Sharing //
+/////////////
+
+void
+CCCLLexicon::Share()
+{
+    if(m_bShared)
+        return;
+    
+    if(m_pMapped || m_pShared) {
+        yPError(ERR_OUT_OF_RANGE,
+                "a lexicon backed by another lexicon cannot be shared");
+    }
+
+    // the properties read when parsing are added before the statistics
+    // are extended to all properties
+    CCCLStat::AddParseProps();
+    
+    FreezeEntries();
+    
+    m_bShared = true;
+    
+    CMutexLock Lock(m_LexiconsMutex);
+    m_bAnyShared = true;
+}
+
+void
+CCCLLexicon::SetShared(CCCLLexicon* pShared)
+{
+    if(pShared && !pShared->IsShared()) {
+        yPError(ERR_OUT_OF_RANGE, "the backing lexicon was not shared");
+    }
+    
+    m_pShared = pShared;
+}
+
+/////////////
+// Pruning //
+/////////////
+
+// Percentage of the budget (or, for the memory budget, of the current
+// number of entries) kept after pruning.
+#define LEX_PRUNE_KEEP_PERCENT 90
+
+void
+CCCLLexicon::EnforceBudget()
+{
+    unsigned int Num = NumElements();
+
+    if(g_LexMaxEntries && Num > g_LexMaxEntries)
+        Prune(Num - (unsigned int)(((unsigned long long)g_LexMaxEntries *
+                                    LEX_PRUNE_KEEP_PERCENT) / 100));
+    else if(g_LexMaxMemory && EntryBytes() > ((size_t)g_LexMaxMemory << 20))
+        Prune(Num - (unsigned int)(((unsigned long long)Num *
+                                    LEX_PRUNE_KEEP_PERCENT) / 100));
+}
+
+size_t
+CCCLLexicon::EntryBytes()
+{
+    return CObjStats::Bytes(eOSLexEntry) + CObjStats::Bytes(eOSCCLStat) +
+        CObjStats::Bytes(eOSCCLVal) + CObjStats::Bytes(eOSTopEntry) +
+        CObjStats::Bytes(eOSStatCopy) + CObjStats::Bytes(eOSIdHashSlots);
+}
+
+// Usefulness of an entry: its count and the number of learning events
+// on both its sides.
+typedef std::pair<std::pair<int, float>, CStrKey*> LexUsefulness;
+
+// Entries which are equally useful are ordered by their strings, so that
+// the entries evicted do not depend on the order of the entries in the
+// table (which may differ between a lexicon and its reloaded snapshot).
+static bool
+LexLessUsefulComp(LexUsefulness const& A, LexUsefulness const& B)
+{
+    if(A.first != B.first)
+        return A.first < B.first;
+
+    return *A.second < *B.second;
+}
+
+unsigned int
+CCCLLexicon::Prune(unsigned int Num)
+{
+    if(!Num || m_bShared)
+        return 0;
+    
+    vector<LexUsefulness> Entries;
+
+    Entries.reserve(NumElements());
+    
+    for(CpCLexIter pIter = Begin() ; *pIter ; ++(*pIter)) {
+        CCCLLexEntry* pEntry = (CCCLLexEntry*)pIter->GetVal();
+        float Learn = 0;
+
+        if(pEntry) {
+            for(unsigned int Side = 0 ; Side < SIDE_NUM ; Side++)
+                if(pEntry->GetCCLStats()[Side])
+                    Learn += (*pEntry->GetCCLStats()[Side]->GetStat(0))
+                        [CCCLStat::eLearn];
+        }
+        
+        Entries.push_back(make_pair(make_pair(pEntry ? pEntry->Count() : 0,
+                                              Learn), pIter->GetKey()));
+    }
+
+    if(Num < Entries.size())
+        nth_element(Entries.begin(), Entries.begin() + Num, Entries.end(),
+                    LexLessUsefulComp);
+    else
+        Num = Entries.size();
+
+    // The keys are not released by the table before they are deleted
+    // from it, so the pointers remain valid until then.
+    for(unsigned int i = 0 ; i < Num ; i++)
+        Delete(*(Entries[i].second));
+
+    m_PruneNum++;
+    m_EvictedNum += Num;
+    // the strings of the evicted entries may no longer be used
+    CMutexLock Lock(m_LexiconsMutex);
+    m_bCollectStrings = true;
+    
+    return Num;
+}
+
+void
+CCCLLexicon::PrintPruneStats(ostream& Out, string const& Prefix)
+{
+    if(!m_EvictedNum)
+        return;
+
+    Out << Prefix << "Lexicon entries evicted: " << m_EvictedNum
+        << " (in " << m_PruneNum << " prunings), remaining entries: "
+        << NumElements() << endl;
+
+    m_PruneNum = 0;
+    m_EvictedNum = 0;
+}
+
+///////////////////////
+// String collection //
+///////////////////////
+
+void
+CCCLLexicon::MarkStrings()
+{
+    for(CpCLexIter pIter = Begin() ; *pIter ; ++(*pIter)) {
+        CInternTable::Mark(pIter->GetKey()->GetId());
+        if(pIter->GetVal())
+            ((CCCLLexEntry*)pIter->GetVal())->MarkStrings();
+    }
+
+    if(m_pMapped)
+        m_pMapped->MarkStrings();
+}
+
+unsigned int
+CCCLLexicon::CollectStrings()
+{
+    CMutexLock Lock(m_LexiconsMutex);
+    
+    // the strings of a shared lexicon may be used by other threads at
+    // any time
+    if(!m_bCollectStrings || m_bAnyShared)
+        return 0;
+
+    m_bCollectStrings = false;
+    
+    CInternTable::BeginCollect();
+
+    if(m_pLexicons)
+        for(set<CCCLLexicon*>::iterator Iter = m_pLexicons->begin() ;
+            Iter != m_pLexicons->end() ; Iter++)
+            (*Iter)->MarkStrings();
+
+    return CInternTable::EndCollect();
+}
+
+////////////////
+// Compaction //
+////////////////
+
+// Entries are compacted in decreasing order of their count. Entries with
+// the same count are ordered by their strings, so that the order does not
+// depend on the order of the entries in the table.
+static bool
+LexCompactComp(LexPair const& A, LexPair const& B)
+{
+    int CountA = A.second ? A.second->Count() : 0;
+    int CountB = B.second ? B.second->Count() : 0;
+
+    if(CountA != CountB)
+        return CountA > CountB;
+
+    return *A.first < *B.first;
+}
+
+// The entries are copied within the same process, so the string IDs
+// written by the entries are already intern table IDs.
+
+class CIdentityStrIds : public CStrIdMap
+{
+public:
+    unsigned int InternId(unsigned int FileId) { return FileId; }
+};
+
+bool
+CCCLLexicon::Compact()
+{
+    if(m_bShared)
+        return false; // the entries of a shared lexicon are never replaced
+    
+    CpCLexIter pIter = Begin();
+
+    if(!*pIter)
+        return false;
+
+    vector<LexPair> Entries;
+
+    Entries.reserve(NumElements());
+
+    for( ; *pIter ; ++(*pIter))
+        Entries.push_back(make_pair(pIter->GetKey(), pIter->GetVal()));
+
+    pIter = NULL;
+    sort(Entries.begin(), Entries.end(), LexCompactComp);
+
+    // Copy the entries (in this order) into a region. Each entry is copied
+    // by writing it to a buffer and reading it back into a new entry, as
+    // when saving and loading a snapshot. The new entries are held here
+    // until they replace the old entries in the table.
+
+    vector<CpCStrKey> Keys;
+    vector<CpCLexEntry> NewEntries;
+    // (the buffer keeps its memory, so the heap objects of the new
+    // entries are not interleaved with buffer allocations)
+    stringstream Buffer(ios::in | ios::out | ios::binary);
+    CIdentityStrIds StrIds;
+
+    Keys.reserve(Entries.size());
+    NewEntries.reserve(Entries.size());
+
+    CPoolAlloc::BeginRegion();
+
+    for(vector<LexPair>::iterator Iter = Entries.begin() ;
+        Iter != Entries.end() ; Iter++) {
+
+        CCCLLexEntry* pEntry = (CCCLLexEntry*)Iter->second;
+        CCCLLexEntry* pNewEntry = NULL;
+
+        if(pEntry) {
+            Buffer.str("");
+            Buffer.clear();
+            CBinWriter Writer(Buffer);
+            pEntry->Write(Writer);
+
+            CBinReader Reader(Buffer);
+
+            pNewEntry = new CCCLLexEntry();
+            if(!pNewEntry->Read(Reader, StrIds)) {
+                CPoolAlloc::EndRegion();
+                yPError(ERR_SHOULDNT, "failed to copy lexicon entry");
+            }
+        }
+
+        Keys.push_back(Iter->first);
+        NewEntries.push_back(pNewEntry);
+    }
+
+    CPoolAlloc::EndRegion();
+
+    // Replace the old entries (this releases them). The entries are
+    // inserted in decreasing order of count, so that the most frequent
+    // words are found in the first slot of their probe sequence.
+
+    Clear();
+
+    for(unsigned int i = 0 ; i < Keys.size() ; i++)
+        SetVal(FindOrInsert(*Keys[i]), NewEntries[i]);
+
+    return true;
+}
@@ -39,11 +39,11 @@ CCCLMatch::PrintObj(CRefOStream* pOut, unsigned int Indent,
 
     ((ostream&)(*pOut)) << "{" << m_Strg;
 
-    for(list<CpCLabel>::iterator Iter = m_Labels.begin() ;
+    for(list<CLabel>::iterator Iter = m_Labels.begin() ;
         Iter != m_Labels.end() ; Iter++) {
         string LabelStr;
-        if(*Iter) {
-            (*Iter)->LabelString(LabelStr);
+        if(!Iter->IsNull()) {
+            Iter->LabelString(LabelStr);
             ((ostream&)(*pOut)) << " " << LabelStr;
         }
     }
@@ -169,6 +169,43 @@ CCCLLink::CalcBestMatch(CCCLStat* pStats, unsigned int Side,
         yPError(ERR_MISSING, "labels missing");
     }
     
+    MatchLabels(pStats, Side, pLabels, BestMatches);
+
+    // Calculate the linking implied by the best matched label
+    // (if there is a unique best matching label).
+    
+    if(BestMatches.m_Labels.size() == 1) {
+        // exactly one best match
+        BestMatches.m_bClassMatch =
+            !(1 & BestMatches.m_Labels.front().GetType());
+
+        string Name = BestMatches.m_Labels.front().GetStr();
+    
+        // The entry is not created if it does not exist (e.g. if it was
+        // evicted), as this would undo the eviction. There are then no
+        // statistics for the best match.
+        CpCCCLLexEntry pLEntry;
+        m_pLexicon->FindOrMapEntryByString(Name, pLEntry);
+
+        BestMatches.m_pStatCopy = !pLEntry ? NULL :
+            pLEntry->GetCCLStats()[BestMatches.m_bClassMatch ?
+                                   Side : OP(Side)]->GetStatCopy();
+    } else {
+        BestMatches.m_pStatCopy = NULL;
+    }
+    
+    return BestMatches.m_Strg;
+}
+
+// The labels of the statistics are traversed in decreasing order of
+// strength and each is looked up in the labels of the unit (on the opposite
+// side). The traversal stops when the label strength drops below the best
+// match found or below 'Block'.
+
+float
+CCCLLink::MatchLabels(CCCLStat* pStats, unsigned int Side,
+                      CCCLLabelTable* pLabels, CCCLMatch& BestMatches)
+{
     BestMatches.m_Labels.clear();
     BestMatches.m_Strg = 0;
 
@@ -197,26 +234,6 @@ CCCLLink::CalcBestMatch(CCCLStat* pStats, unsigned int Side,
         }
     }
 
-    // Calculate the linking implied by the best matched label
-    // (if there is a unique best matching label).
-    
-    if(BestMatches.m_Labels.size() == 1) {
-        // exactly one best match
-        BestMatches.m_bClassMatch =
-            !(1 & (unsigned int)*(BestMatches.m_Labels.front()));
-
-        string Name = (string const&)*(BestMatches.m_Labels.front());
-    
-        CpCCCLLexEntry pLEntry;
-        m_pLexicon->GetEntryByString(Name, pLEntry);
-
-        BestMatches.m_pStatCopy =
-            new CCCLStatCopy(pLEntry->GetCCLStats()[BestMatches.m_bClassMatch ?
-                                                    Side : OP(Side)]);
-    } else {
-        BestMatches.m_pStatCopy = NULL;
-    }
-    
     return BestMatches.m_Strg;
 }
 
@@ -0,0 +1,362 @@
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "yError.h"
+#include "Intern.h"
+#include "CCLMappedLexicon.h"
+
+using namespace std;
+
+// The file begins with a header of the following words:
+//
+// <magic> <version> <number of strings> <number of entries>
+// <number of index slots> <string offsets offset> <string characters offset>
+// <index offset> <entries offset> <file size> <header checksum> <0>
+//
+// (all offsets are in bytes from the beginning of the file). This is
+// followed by:
+//
+// string offsets: one word for each string (beginning with ID 1) holding
+//    the offset of its characters relative to the string characters and one
+//    additional word holding the end of the last string.
+// string characters: the characters of all strings (not terminated),
+//    padded to a word boundary.
+// index: for each slot, the offset of the entry stored in it (0 if empty).
+//    The slot of a string is its FNV-1a hash (modulo the number of slots),
+//    collisions are resolved by linear probing.
+// entries: each entry is <key string ID> followed by the entry as
+//    written by CCCLLexEntry::Write().
+//
+// The strings are those of the intern table at the time the file was
+// written (so their IDs are the ones used by the labels in the entries).
+
+#define MAPPED_LEX_MAGIC 0x4d4c4343 // 'CCLM'
+#define MAPPED_LEX_VERSION 1
+#define MAPPED_LEX_HEADER_WORDS 10  // number of words before the checksum
+#define MAPPED_LEX_HEADER_SIZE 48   // including checksum and padding
+
+bool
+CCCLMappedLexicon::Write(CCCLLexicon* pLexicon, string const& FileName,
+                         string& Error)
+{
+    if(!pLexicon) {
+        yPError(ERR_MISSING, "lexicon missing");
+    }
+
+    // The entries are first written to a buffer, to determine their offsets
+
+    ostringstream Entries(ios::out | ios::binary);
+    CBinWriter EntryWriter(Entries);
+    vector<pair<CStrKey*, size_t> > Keys; // key and offset in 'Entries'
+
+    for(CpCLexIter pIter = pLexicon->Begin() ; *pIter ; ++(*pIter)) {
+        Keys.push_back(make_pair(pIter->GetKey(), (size_t)Entries.tellp()));
+        EntryWriter.PutU32(CInternTable::Intern(pIter->GetKey()));
+        ((CCCLLexEntry*)pIter->GetVal())->Write(EntryWriter);
+    }
+
+    // string characters size
+
+    unsigned int StrNum = CInternTable::Size();
+    size_t CharsSize = 0;
+
+    // (the ID of a released string has an empty string)
+    for(unsigned int Id = 1 ; Id <= StrNum ; Id++)
+        if(CInternTable::GetKey(Id))
+            CharsSize += CInternTable::GetKey(Id)->Length();
+
+    size_t PaddedCharsSize = (CharsSize + 3) & ~(size_t)3;
+
+    // number of index slots: a power of 2, at least twice the number
+    // of entries
+
+    unsigned int SlotNum = 2;
+
+    while(SlotNum < 2 * Keys.size())
+        SlotNum <<= 1;
+
+    // layout
+
+    size_t StrOffsets = MAPPED_LEX_HEADER_SIZE;
+    size_t StrChars = StrOffsets + 4 * (StrNum + 1);
+    size_t Index = StrChars + PaddedCharsSize;
+    size_t EntriesOffset = Index + 4 * (size_t)SlotNum;
+    size_t Size = EntriesOffset + Entries.str().size();
+
+    if(Size != (unsigned int)Size) {
+        Error = "lexicon too large for the mapped lexicon format";
+        return false;
+    }
+
+    // build the index
+
+    vector<unsigned int> Slots(SlotNum, 0);
+
+    for(vector<pair<CStrKey*, size_t> >::iterator Iter = Keys.begin() ;
+        Iter != Keys.end() ; Iter++) {
+        CStrKey* pKey = Iter->first;
+        unsigned int Slot =
+            BinIOHash(pKey->GetStr(), pKey->Length()) & (SlotNum - 1);
+        while(Slots[Slot])
+            Slot = (Slot + 1) & (SlotNum - 1);
+        Slots[Slot] = EntriesOffset + Iter->second;
+    }
+
+    // write the file (to a temporary file which then replaces the
+    // original, since other processes may have the original mapped)
+
+    string TmpFileName = FileName + ".tmp";
+    ofstream Out(TmpFileName.c_str(), ios::out | ios::binary | ios::trunc);
+
+    if(!Out) {
+        Error = "could not open mapped lexicon file '" + TmpFileName +
+            "' for writing";
+        return false;
+    }
+
+    CBinWriter Header(Out);
+
+    Header.PutU32(MAPPED_LEX_MAGIC);
+    Header.PutU32(MAPPED_LEX_VERSION);
+    Header.PutU32(StrNum);
+    Header.PutU32(Keys.size());
+    Header.PutU32(SlotNum);
+    Header.PutU32(StrOffsets);
+    Header.PutU32(StrChars);
+    Header.PutU32(Index);
+    Header.PutU32(EntriesOffset);
+    Header.PutU32(Size);
+    Header.PutChecksum();
+    Header.PutU32(0);
+
+    CBinWriter Writer(Out);
+    size_t CharsOffset = 0;
+
+    for(unsigned int Id = 1 ; Id <= StrNum ; Id++) {
+        Writer.PutU32(CharsOffset);
+        if(CInternTable::GetKey(Id))
+            CharsOffset += CInternTable::GetKey(Id)->Length();
+    }
+    Writer.PutU32(CharsOffset);
+
+    for(unsigned int Id = 1 ; Id <= StrNum ; Id++) {
+        CStrKey* pKey = CInternTable::GetKey(Id);
+        if(pKey)
+            Writer.PutBytes(pKey->GetStr(), pKey->Length());
+    }
+    Writer.PutBytes("\0\0\0", PaddedCharsSize - CharsSize);
+
+    for(vector<unsigned int>::iterator Iter = Slots.begin() ;
+        Iter != Slots.end() ; Iter++)
+        Writer.PutU32(*Iter);
+
+    Writer.PutBytes(Entries.str().data(), Entries.str().size());
+    Out.close();
+
+    if(Header.IsError() || Writer.IsError() || Out.fail()) {
+        Error = "error while writing mapped lexicon file '" + TmpFileName +
+            "'";
+        remove(TmpFileName.c_str());
+        return false;
+    }
+
+    if(rename(TmpFileName.c_str(), FileName.c_str())) {
+        Error = "could not rename mapped lexicon file '" + TmpFileName +
+            "' to '" + FileName + "'";
+        remove(TmpFileName.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+CCCLMappedLexicon::CCCLMappedLexicon(string const& FileName) :
+        m_FileName(FileName), m_pBase(NULL), m_Size(0), m_StrNum(0),
+        m_EntryNum(0), m_SlotNum(0), m_StrOffsets(0), m_StrChars(0),
+        m_Index(0), m_bWarned(false), m_Error(false)
+{
+#ifdef DETAILED_DEBUG
+    IncObjCount();
+#endif
+
+    int Fd = open(FileName.c_str(), O_RDONLY);
+
+    if(Fd < 0) {
+        SetError("could not open mapped lexicon file '" + FileName + "'");
+        return;
+    }
+
+    struct stat Stat;
+
+    if(fstat(Fd, &Stat) || Stat.st_size < MAPPED_LEX_HEADER_SIZE) {
+        close(Fd);
+        SetError("'" + FileName + "' is not a mapped lexicon file");
+        return;
+    }
+
+    void* pMap = mmap(NULL, Stat.st_size, PROT_READ, MAP_SHARED, Fd, 0);
+    close(Fd);
+
+    if(pMap == MAP_FAILED) {
+        SetError("could not map lexicon file '" + FileName + "'");
+        return;
+    }
+
+    m_pBase = (char const*)pMap;
+    m_Size = Stat.st_size;
+
+    if(Word(0) != MAPPED_LEX_MAGIC ||
+       Word(4 * MAPPED_LEX_HEADER_WORDS) !=
+       BinIOHash(m_pBase, 4 * MAPPED_LEX_HEADER_WORDS)) {
+        SetError("'" + FileName + "' is not a mapped lexicon file");
+        return;
+    }
+
+    if(Word(4) != MAPPED_LEX_VERSION) {
+        SetError("mapped lexicon file '" + FileName +
+                 "' has an unsupported version");
+        return;
+    }
+
+    m_StrNum = Word(8);
+    m_EntryNum = Word(12);
+    m_SlotNum = Word(16);
+    m_StrOffsets = Word(20);
+    m_StrChars = Word(24);
+    m_Index = Word(28);
+
+    // check that the sections are within the file
+
+    if(Word(36) != m_Size || !m_SlotNum || (m_SlotNum & (m_SlotNum - 1)) ||
+       m_StrOffsets != MAPPED_LEX_HEADER_SIZE ||
+       m_StrChars != m_StrOffsets + 4 * ((size_t)m_StrNum + 1) ||
+       m_Index < m_StrChars || (m_Index & 3) ||
+       m_Index + 4 * (size_t)m_SlotNum != Word(32) || Word(32) > m_Size) {
+        SetError("mapped lexicon file '" + FileName + "' is corrupt");
+        return;
+    }
+
+    m_InternIds.resize(m_StrNum + 1, 0);
+}
+
+CCCLMappedLexicon::~CCCLMappedLexicon()
+{
+#ifdef DETAILED_DEBUG
+    DecObjCount();
+#endif
+    if(m_pBase)
+        munmap((void*)m_pBase, m_Size);
+}
+
+bool
+CCCLMappedLexicon::GetStr(unsigned int FileId, char const*& pStr,
+                          unsigned int& Len)
+{
+    if(!FileId || FileId > m_StrNum)
+        return false;
+
+    unsigned int Begin = Word(m_StrOffsets + 4 * (FileId - 1));
+    unsigned int End = Word(m_StrOffsets + 4 * FileId);
+
+    if(End < Begin || m_StrChars + End > m_Index)
+        return false;
+
+    pStr = m_pBase + m_StrChars + Begin;
+    Len = End - Begin;
+    return true;
+}
+
+size_t
+CCCLMappedLexicon::FindEntry(string const& Name)
+{
+    if(m_Error)
+        return 0;
+
+    unsigned int Mask = m_SlotNum - 1;
+    unsigned int Slot = BinIOHash(Name.data(), Name.size()) & Mask;
+
+    for(unsigned int Probe = 0 ; Probe < m_SlotNum ; Probe++) {
+        size_t Offset = Word(m_Index + 4 * Slot);
+        char const* pStr;
+        unsigned int Len;
+
+        if(!Offset || Offset + 4 > m_Size)
+            return 0;
+
+        if(GetStr(Word(Offset), pStr, Len) && Len == Name.size() &&
+           !Name.compare(0, Len, pStr, Len))
+            return Offset;
+
+        Slot = (Slot + 1) & Mask;
+    }
+
+    return 0;
+}
+
+bool
+CCCLMappedLexicon::ReadEntry(size_t Offset, CCCLLexEntry* pEntry)
+{
+    if(!pEntry || !Offset || Offset + 4 > m_Size)
+        return false;
+
+    CBinReader Reader(m_pBase + Offset + 4, m_Size - Offset - 4);
+
+    if(pEntry->Read(Reader, *this))
+        return true;
+
+    if(!m_bWarned) {
+        m_bWarned = true;
+        yPWarn(ERR_FILE, ("invalid entry in mapped lexicon file '" +
+                          m_FileName + "' (skipped)").c_str());
+    }
+
+    return false;
+}
+
+unsigned int
+CCCLMappedLexicon::InternId(unsigned int FileId)
+{
+    if(!FileId || FileId > m_StrNum)
+        return 0;
+
+    if(!m_InternIds[FileId]) {
+        char const* pStr;
+        unsigned int Len;
+
+        if(!GetStr(FileId, pStr, Len))
+            return 0;
+
+        m_InternIds[FileId] = CInternTable::Intern(pStr, Len);
+    }
+
+    return m_InternIds[FileId];
+}
+
+void
+CCCLMappedLexicon::MarkStrings()
+{
+    for(vector<unsigned int>::iterator Iter = m_InternIds.begin() ;
+        Iter != m_InternIds.end() ; Iter++)
+        CInternTable::Mark(*Iter);
+}
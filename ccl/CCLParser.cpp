@@ -20,6 +20,7 @@
 #include "CCLParser.h"
 #include "CCLUnit.h"
 #include "CCLLink.h"
+#include "CCLMappedLexicon.h"
 #include "yError.h"
 
 using namespace std;
@@ -33,6 +34,13 @@ CCCLParser::CCCLParser(CCCLLexicon* pLexicon) :
     
     if(!m_pLexicon) // if no external lexicon is given, create one (empty)
         m_pLexicon = new CCCLLexicon();
+    else if(m_pLexicon->IsShared()) {
+        // strings not in the shared lexicon are added to a lexicon of
+        // this parser
+        CpCCCLLexicon pShared = m_pLexicon;
+        m_pLexicon = new CCCLLexicon();
+        m_pLexicon->SetShared(pShared);
+    }
 
     m_pCCLBrackets = new CCCLBrackets(m_pTracing);
 }
@@ -44,45 +52,74 @@ CCCLParser::~CCCLParser()
 #endif
 }
 
-CUnit*
-CCCLParser::CreateUnit(string const& Name, vector<string>& Labels)
+// Returns the key of the lexicon entry for the lower case version of the
+// given string (creating the entry if it does not exist yet) and the entry
+// itself in 'pEntry'. The key and entry are owned by the lexicon.
+// Existing entries are found without copying the string.
+
+static CStrKey*
+GetLowerEntry(CCCLLexicon* pLexicon, string const& Name,
+              CCCLLexEntry*& pEntry)
 {
-    // convert to lower-case
+    CStrKey* pKey = pLexicon->FindEntryByLowerString(Name, pEntry);
+
+    if(pKey || Name == "")
+        return pKey;
+
+    // not in the lexicon yet
     string LCName = Name;
     ToLower(LCName);
 
-    // Get the name from the lexicon
+    CpCCCLLexEntry pNewEntry;
+    pKey = pLexicon->GetEntryByString(LCName, pNewEntry);
+    pEntry = pNewEntry;
+    
+    return pKey;
+}
+
+CUnit*
+CCCLParser::CreateUnit(string const& Name, vector<string>& Labels)
+{
+    // Get the (lower case) name from the lexicon
+
+    if(m_bLearnCycle && m_pLexicon->GetShared()) {
+        yPError(ERR_OUT_OF_RANGE, "cannot learn with a shared lexicon");
+    }
 
-    CpCCCLLexEntry pLEntry;
-    CpCStrKey pName = m_pLexicon->GetEntryByString(LCName, pLEntry);
+    CCCLLexEntry* pLEntry;
+    CStrKey* pName = GetLowerEntry(m_pLexicon, Name, pLEntry);
 
     if(m_bLearnCycle)
         pLEntry->IncCount();
     
-    // Create the list of labels
-    vector<CpCStrKey> UnitLabels;
+    // Create the list of labels (the vector is reused, so that its
+    // storage is not allocated again for every unit)
 
     // The name of the unit itself is always a label of itself
-    UnitLabels.push_back(pName);
+    m_UnitLabels.push_back(pName);
 
     for(vector<string>::iterator Iter = Labels.begin() ;
         Iter != Labels.end() ; Iter++) {
-        // convert to lower case
-        string LCLabel = *Iter;
-        ToLower(LCLabel);
 
-        if(LCLabel == "" || LCLabel == LCName)
+        if(*Iter == "")
             continue;
 
         // To conserve memory, we store also the labels in the lexicon
         // (though they are not necessarily lexical items)
-        CpCStrKey pLabel = m_pLexicon->GetKeyByString(LCLabel);
-        UnitLabels.push_back(pLabel);
+        CCCLLexEntry* pLabelEntry;
+        CStrKey* pLabel = GetLowerEntry(m_pLexicon, *Iter, pLabelEntry);
+        
+        if(pLabel != pName)
+            m_UnitLabels.push_back(pLabel);
     }
 
     // Create a unit and return it
 
-    return new CSCCLUnit(pName, UnitLabels, pLEntry->GetCCLStats());
+    CUnit* pUnit = new CSCCLUnit(pName, m_UnitLabels, pLEntry->GetCCLStats());
+
+    m_UnitLabels.clear();
+    
+    return pUnit;
 }
 
 void
@@ -90,6 +127,10 @@ CCCLParser::ClearDerivedParser()
 {
     if(m_pCCLBrackets)
         m_pCCLBrackets->Clear();
+
+    // no labels are held outside the lexicons anymore, so the strings of
+    // discarded lexicons and evicted entries can be released
+    CCCLLexicon::CollectStrings();
 }
 
 //////////////////////////////
@@ -182,6 +223,9 @@ CCCLParser::Terminate()
         // the utterance
         LearnRight(m_pCCLBrackets->LastNode()+1);
         m_LearnQueue.Realize();
+        // the units of this utterance hold their own references to the
+        // entries they use, so evicting entries here is safe.
+        m_pLexicon->EnforceBudget();
     } else
         m_LearnQueue.Clear();
 }
@@ -203,7 +247,7 @@ GetStrongestMatch(list<CpCCCLLink>& Links, CCCLLink* pLastLink)
 {
     bool bBestIsUsed = true;
     float BestPrefix = 0;
-    CpCCCLLink pBest;
+    CCCLLink* pBest = NULL; // the links are owned by the list
         
     for(list<CpCCCLLink>::iterator Iter = Links.begin() ;
         Iter != Links.end() ; Iter++) {
@@ -242,7 +286,7 @@ GetStrongestPotentialMatch(list<CpCCCLLink>& Links, CCCLLink* pLastLink)
 {
     unsigned int BestStrong = 0;
     float BestMax = 0;
-    CpCCCLLink pBest;
+    CCCLLink* pBest = NULL; // the links are owned by the list
     SCCLAdjPos AdjPos(RIGHT,0);
         
     for(list<CpCCCLLink>::iterator Iter = Links.begin() ;
@@ -606,6 +650,80 @@ CCCLParser::GetSynStruct()
     return m_pCCLBrackets ? m_pCCLBrackets->GetSynStruct() : NULL;
 }
 
+bool
+CCCLParser::SaveLexicon(string const& FileName, string& Error)
+{
+    return m_pLexicon->Save(FileName, Error);
+}
+
+bool
+CCCLParser::LoadLexicon(string const& FileName, string& Error)
+{
+    // load into a new lexicon, so that the current lexicon remains
+    // unchanged if loading fails
+    CpCCCLLexicon pLexicon = new CCCLLexicon();
+
+    if(!pLexicon->Load(FileName, Error))
+        return false;
+
+    m_pLexicon = pLexicon;
+    return true;
+}
+
+bool
+CCCLParser::SaveMappedLexicon(string const& FileName, string& Error)
+{
+    return CCCLMappedLexicon::Write(m_pLexicon, FileName, Error);
+}
+
+bool
+CCCLParser::MapLexicon(string const& FileName, string& Error)
+{
+    CpCCCLMappedLexicon pMapped = new CCCLMappedLexicon(FileName);
+
+    if(pMapped->IsError()) {
+        Error = pMapped->GetErrorStr();
+        return false;
+    }
+
+    CpCCCLLexicon pLexicon = new CCCLLexicon();
+    pLexicon->SetMapped(pMapped);
+    m_pLexicon = pLexicon;
+    return true;
+}
+
+bool
+CCCLParser::CompactLexicon()
+{
+    ClearUtterance();
+    return m_pLexicon->Compact();
+}
+
+bool
+CCCLParser::SaveCheckpoint(ostream& Out, string const& FileName,
+                           string& Error)
+{
+    if(m_pLexicon->IsMapped()) {
+        Error = "a lexicon backed by a mapped lexicon cannot be checkpointed";
+        return false;
+    }
+    
+    return m_pLexicon->Save(Out, FileName, Error);
+}
+
+bool
+CCCLParser::LoadCheckpoint(istream& In, string const& FileName,
+                           string& Error)
+{
+    CpCCCLLexicon pLexicon = new CCCLLexicon();
+
+    if(!pLexicon->Load(In, FileName, Error))
+        return false;
+
+    m_pLexicon = pLexicon;
+    return true;
+}
+
 ///////////////////////
 // Printing Routines //
 ///////////////////////
@@ -0,0 +1,726 @@
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <queue>
+#include <algorithm>
+#include "yError.h"
+#include "BinIO.h"
+#include "Intern.h"
+#include "CCLLexicon.h"
+
+using namespace std;
+
+//
+// Binary lexicon snapshots
+//
+
+// A snapshot file has the following structure (every value is a 32 bit
+// word, see BinIO.h):
+//
+// <magic> <version>
+// <number of strings> <string> ... <string>
+// <entry> ... <entry> <0> <number of entries>
+// <checksum>
+//
+// The strings are those of the intern table, in ID order (string number i
+// in the file has ID i, beginning at 1). Lexicon keys and labels refer to
+// their strings by this ID. Each entry has the structure:
+//
+// <key string ID> <count> <left statistics> <right statistics>
+//
+// The entries are sorted by their key strings (so that snapshots can be
+// merged by a single pass over each of them, see MergeSnapshots()). The
+// list of entries is terminated by a 0 string ID, followed by the number
+// of entries (so that the entries can be written while they are
+// produced). In version 1 files, the entries are not sorted and the
+// number of entries appears before the entries (and there is no 0
+// terminating them). These files can still be loaded, but not merged.
+//
+// where the statistics of each side are the number of adjacency
+// positions (see CCCLAdjStats) followed by the statistics object of each
+// of these positions, as written by CCCLStat::Write():
+//
+// <number of vector values> (<property> <value>) ...
+// <number of labels> (<type> <string ID> <size> <value> ... <value>) ...
+// <number of top lists> (<length> (<label number> <strength>) ...) ...
+//
+// The label values are written as stored, including the top list
+// positions coded into them (see Strength.h). The top lists are written
+// in order, with each entry referring to a label by its number in the
+// label list above, so that they can be restored exactly.
+
+#define LEX_SNAPSHOT_MAGIC 0x584c4343 // 'CCLX'
+#define LEX_SNAPSHOT_VERSION 2
+
+// bounds on values read from the file (to detect corrupt files before
+// allocating memory for them)
+#define LEX_SNAPSHOT_MAX_PROP (1 << 16)
+
+void
+CCCLStat::Write(CBinWriter& Writer)
+{
+    // vector statistics
+
+    Writer.PutU32(LocalSize());
+    for(unsigned int Code = 0 ; Code < LocalSize() ; Code++) {
+        Writer.PutU32(LocalCodeProp(Code));
+        Writer.PutFloat(LocalVal(Code));
+    }
+
+    // label statistics. The labels are numbered in the order in which
+    // they are written, so that the top lists can refer to them.
+
+    vector<CLabel> Labels;
+    map<unsigned int, unsigned int> LabelNums; // by packed label
+
+    for(CPtr<CStrgIter> pIter = GetFullIter() ; *pIter ; ++(*pIter)) {
+        LabelNums[pIter->GetKey().GetPacked()] = Labels.size();
+        Labels.push_back(pIter->GetKey());
+    }
+
+    Writer.PutU32(Labels.size());
+    for(vector<CLabel>::iterator Iter = Labels.begin() ;
+        Iter != Labels.end() ; Iter++) {
+        CCCLVal* pVal = GetVal(*Iter);
+        Writer.PutU32(Iter->GetType());
+        Writer.PutU32(Iter->GetId());
+        Writer.PutU32(pVal->size());
+        for(unsigned int Prop = 0 ; Prop < pVal->size() ; Prop++)
+            Writer.PutFloat((*pVal)[Prop]);
+    }
+
+    // top lists (by local code)
+
+    unsigned int TopNum = CStrengths<CLabel, CCCLVal>::GetTopNum();
+
+    Writer.PutU32(TopNum);
+    for(unsigned int Prop = 0 ; Prop < TopNum ; Prop++) {
+        Writer.PutU32(CStrengths<CLabel, CCCLVal>::GetTopLength(Prop));
+        for(CPtr<CTopIter<CLabel, CCCLVal> > pIter =
+                CStrengths<CLabel, CCCLVal>::GetIter(Prop) ;
+            *pIter ; ++(*pIter)) {
+            map<unsigned int, unsigned int>::iterator Found =
+                LabelNums.find(pIter->Data().GetPacked());
+            if(Found == LabelNums.end()) {
+                yPError(ERR_SHOULDNT, "top list label not in table");
+            }
+            Writer.PutU32(Found->second);
+            Writer.PutFloat(pIter->Strg());
+        }
+    }
+}
+
+bool
+CCCLStat::Read(CBinReader& Reader, CStrIdMap& StrIds)
+{
+    unsigned int Num;
+
+    // vector statistics
+
+    if(!Reader.GetU32(Num))
+        return false;
+
+    for(unsigned int i = 0 ; i < Num ; i++) {
+        unsigned int Prop;
+        float Val;
+        if(!Reader.GetU32(Prop) || !Reader.GetFloat(Val) ||
+           Prop >= LEX_SNAPSHOT_MAX_PROP)
+            return false;
+        (*this)[Prop] = Val;
+    }
+
+    // label statistics
+
+    if(!Reader.GetU32(Num))
+        return false;
+
+    vector<CLabel> Labels;
+    vector<CCCLVal*> Vals;
+
+    for(unsigned int i = 0 ; i < Num ; i++) {
+        unsigned int Type, Id, Size;
+        if(!Reader.GetU32(Type) || !Reader.GetU32(Id) ||
+           !Reader.GetU32(Size))
+            return false;
+        if(Type > LB_TYPE_MASK || Size > m_TableConv.GetPropNum() ||
+           !(Id = StrIds.InternId(Id)))
+            return false;
+
+        CCCLVal* pVal = new CCCLVal(Size);
+        CLabel Label(Type, CInternTable::GetKey(Id));
+        // the table holds the reference to the value
+        if(InsertEntry(Label, pVal).Val() != pVal ||
+           Labels.size() + 1 != CStrengths<CLabel, CCCLVal>::NumEntries())
+            return false; // label appears twice
+
+        for(unsigned int Prop = 0 ; Prop < Size ; Prop++)
+            if(!Reader.GetFloat((*pVal)[Prop]))
+                return false;
+
+        Labels.push_back(Label);
+        Vals.push_back(pVal);
+    }
+
+    // top lists
+
+    unsigned int TopNum;
+
+    if(!Reader.GetU32(TopNum) || TopNum > m_TableConv.TopListNum())
+        return false;
+
+    for(unsigned int Prop = 0 ; Prop < TopNum ; Prop++) {
+        if(!Reader.GetU32(Num))
+            return false;
+        for(unsigned int i = 0 ; i < Num ; i++) {
+            unsigned int LabelNum;
+            float Strg;
+            if(!Reader.GetU32(LabelNum) || !Reader.GetFloat(Strg) ||
+               LabelNum >= Labels.size())
+                return false;
+            if(!AppendTopEntry(Prop, Strg, Labels[LabelNum], Vals[LabelNum]))
+                return false;
+        }
+    }
+
+    // Every value which claims to be in a top list must have been appended
+    // to that list above (each appended value was checked to record its
+    // position in the list, so it only remains to check that no value
+    // records a position beyond the end of the list).
+
+    for(vector<CCCLVal*>::iterator Iter = Vals.begin() ; Iter != Vals.end() ;
+        Iter++) {
+        for(unsigned int Prop = 0 ; Prop < (*Iter)->size() ; Prop++) {
+            if((**Iter)[Prop] >= 0)
+                continue;
+            if(Prop >= TopNum ||
+               (unsigned int)CTopBase::Strg2Pos((**Iter)[Prop]) >=
+               CStrengths<CLabel, CCCLVal>::GetTopLength(Prop))
+                return false;
+        }
+    }
+
+    // the statistics changed (see CCCLAdjStats::UpdateStatCopy())
+    IncVersion();
+
+    return true;
+}
+
+void
+CCCLLexEntry::Write(CBinWriter& Writer)
+{
+    Writer.PutInt(m_Count);
+
+    for(unsigned int Side = LEFT ; Side <= RIGHT ; Side++) {
+        Writer.PutU32(m_Stats[Side]->Length());
+        for(unsigned int Pos = 0 ; Pos < m_Stats[Side]->Length() ; Pos++)
+            m_Stats[Side]->GetStat(Pos)->Write(Writer);
+    }
+}
+
+bool
+CCCLLexEntry::Read(CBinReader& Reader, CStrIdMap& StrIds)
+{
+    int Count;
+
+    if(!Reader.GetInt(Count) || Count < 0)
+        return false;
+
+    m_Count += Count;
+
+    for(unsigned int Side = LEFT ; Side <= RIGHT ; Side++) {
+        unsigned int Length;
+
+        if(!Reader.GetU32(Length) || !Length)
+            return false;
+
+        for(unsigned int Pos = 0 ; Pos < Length ; Pos++) {
+            if(!m_Stats[Side]->GetStat(Pos, true)->Read(Reader, StrIds))
+                return false;
+        }
+
+        m_Stats[Side]->UpdateStatCopy();
+    }
+
+    return true;
+}
+
+// String ID conversion for snapshots: all strings are read (and interned)
+// before the entries.
+
+class CSnapshotStrIds : public CStrIdMap
+{
+public:
+    vector<unsigned int> m_Ids; // intern IDs by file ID (no file ID 0)
+
+    CSnapshotStrIds() : m_Ids(1, 0) {}
+    unsigned int InternId(unsigned int FileId) {
+        return FileId < m_Ids.size() ? m_Ids[FileId] : 0;
+    }
+};
+
+// Reading a snapshot entry by entry (used both to load a snapshot into
+// a lexicon and to merge snapshots). The reader either reads from a given
+// stream or opens the given file itself.
+
+class CSnapshotReader : public CRef
+{
+private:
+    std::string m_FileName;
+    ifstream m_File; // only used if the reader opened the file
+    bool m_bOwnFile;
+    CBinReader m_Reader;
+    CSnapshotStrIds m_StrIds;
+    unsigned int m_Version;
+    // number of entries in the file (only known in advance in version 1)
+    unsigned int m_EntryNum;
+    unsigned int m_KeysRead;
+public:
+    CSnapshotReader(istream& In, string const& FileName) :
+            m_FileName(FileName), m_bOwnFile(false), m_Reader(In),
+            m_Version(0), m_EntryNum(0), m_KeysRead(0) {}
+    CSnapshotReader(string const& FileName) :
+            m_FileName(FileName),
+            m_File(FileName.c_str(), ios::in | ios::binary),
+            m_bOwnFile(true), m_Reader(m_File),
+            m_Version(0), m_EntryNum(0), m_KeysRead(0) {}
+
+    string const& FileName() { return m_FileName; }
+    unsigned int Version() { return m_Version; }
+    
+    // Reads the header and the strings (which are interned). Returns
+    // false (and sets 'Error') if this fails.
+    bool ReadHeader(string& Error);
+    // Reads the key of the next entry and returns it as an intern table
+    // ID. After the last entry, 0 is returned (and the number of entries
+    // and the checksum are checked). Returns false if the file is corrupt.
+    bool NextKey(unsigned int& Id);
+    // Reads the entry whose key was last returned by NextKey() into the
+    // given (new) entry. Returns false if the entry is not valid.
+    bool ReadEntry(CCCLLexEntry* pEntry) {
+        return pEntry->Read(m_Reader, m_StrIds);
+    }
+};
+
+typedef CPtr<CSnapshotReader> CpCSnapshotReader;
+
+bool
+CSnapshotReader::ReadHeader(string& Error)
+{
+    if(m_bOwnFile && !m_File) {
+        Error = "could not open lexicon snapshot file '" + m_FileName + "'";
+        return false;
+    }
+    
+    unsigned int Magic;
+
+    if(!m_Reader.GetU32(Magic) || Magic != LEX_SNAPSHOT_MAGIC) {
+        Error = "'" + m_FileName + "' is not a lexicon snapshot file";
+        return false;
+    }
+
+    if(!m_Reader.GetU32(m_Version) || !m_Version ||
+       m_Version > LEX_SNAPSHOT_VERSION) {
+        Error = "lexicon snapshot file '" + m_FileName +
+            "' has an unsupported version";
+        return false;
+    }
+
+    Error = "lexicon snapshot file '" + m_FileName + "' is corrupt";
+
+    // strings (convert the file's IDs to the intern table's IDs)
+
+    unsigned int Num;
+
+    if(!m_Reader.GetU32(Num))
+        return false;
+
+    for(unsigned int Id = 1 ; Id <= Num ; Id++) {
+        string Str;
+        if(!m_Reader.GetStr(Str))
+            return false;
+        m_StrIds.m_Ids.push_back(CInternTable::Intern(Str));
+    }
+
+    if(m_Version == 1 && !m_Reader.GetU32(m_EntryNum))
+        return false;
+    
+    Error = "";
+    return true;
+}
+
+bool
+CSnapshotReader::NextKey(unsigned int& Id)
+{
+    if(m_Version == 1) {
+        if(m_KeysRead == m_EntryNum) {
+            Id = 0;
+            return m_Reader.CheckChecksum();
+        }
+        m_KeysRead++;
+        return m_Reader.GetU32(Id) && (Id = m_StrIds.InternId(Id));
+    }
+
+    unsigned int FileId;
+
+    if(!m_Reader.GetU32(FileId))
+        return false;
+
+    if(!FileId) {
+        // end of the entries
+        unsigned int Num;
+        Id = 0;
+        return m_Reader.GetU32(Num) && Num == m_KeysRead &&
+            m_Reader.CheckChecksum();
+    }
+
+    m_KeysRead++;
+    return (Id = m_StrIds.InternId(FileId));
+}
+
+// Comparison of lexicon entries by their key strings (for sorting the
+// entries of a snapshot)
+
+typedef pair<CStrKey*, CCCLLexEntry*> tSnapshotEntry;
+
+static bool
+SnapshotEntryComp(tSnapshotEntry const& A, tSnapshotEntry const& B)
+{
+    return *A.first < *B.first;
+}
+
+bool
+CCCLLexicon::Save(string const& FileName, string& Error)
+{
+    ofstream Out(FileName.c_str(), ios::out | ios::binary | ios::trunc);
+
+    if(!Out) {
+        Error = "could not open lexicon snapshot file '" + FileName +
+            "' for writing";
+        return false;
+    }
+
+    return Save(Out, FileName, Error);
+}
+
+bool
+CCCLLexicon::Save(ostream& Out, string const& FileName, string& Error)
+{
+    CBinWriter Writer(Out);
+
+    Writer.PutU32(LEX_SNAPSHOT_MAGIC);
+    Writer.PutU32(LEX_SNAPSHOT_VERSION);
+
+    // strings (in ID order)
+
+    Writer.PutU32(CInternTable::Size());
+    for(unsigned int Id = 1 ; Id <= CInternTable::Size() ; Id++) {
+        CStrKey* pKey = CInternTable::GetKey(Id);
+        // (the ID of a released string is written as an empty string)
+        if(pKey)
+            Writer.PutStr(pKey->GetStr(), pKey->Length());
+        else
+            Writer.PutStr("", 0);
+    }
+
+    // entries (sorted by key)
+
+    vector<tSnapshotEntry> Entries;
+
+    Entries.reserve(NumElements());
+    
+    for(CpCLexIter pIter = Begin() ; *pIter ; ++(*pIter)) {
+        CCCLLexEntry* pEntry = (CCCLLexEntry*)pIter->GetVal();
+
+        if(!pEntry) {
+            yPError(ERR_MISSING, "lexicon entry missing");
+        }
+
+        Entries.push_back(tSnapshotEntry(pIter->GetKey(), pEntry));
+    }
+
+    sort(Entries.begin(), Entries.end(), SnapshotEntryComp);
+    
+    for(vector<tSnapshotEntry>::iterator Iter = Entries.begin() ;
+        Iter != Entries.end() ; Iter++) {
+        Writer.PutU32(CInternTable::Intern(Iter->first));
+        Iter->second->Write(Writer);
+    }
+
+    Writer.PutU32(0);
+    Writer.PutU32(Entries.size());
+    Writer.PutChecksum();
+    Out.flush();
+
+    if(Writer.IsError()) {
+        Error = "error while writing lexicon snapshot file '" + FileName + "'";
+        return false;
+    }
+
+    return true;
+}
+
+bool
+CCCLLexicon::Load(string const& FileName, string& Error)
+{
+    ifstream In(FileName.c_str(), ios::in | ios::binary);
+
+    if(!In) {
+        Error = "could not open lexicon snapshot file '" + FileName + "'";
+        return false;
+    }
+
+    return Load(In, FileName, Error);
+}
+
+bool
+CCCLLexicon::Load(istream& In, string const& FileName, string& Error)
+{
+    if(NumElements()) {
+        yPError(ERR_SHOULDNT, "loading a snapshot into a non-empty lexicon");
+    }
+
+    CSnapshotReader Reader(In, FileName);
+    
+    if(!Reader.ReadHeader(Error))
+        return false;
+
+    Error = "lexicon snapshot file '" + FileName + "' is corrupt";
+
+    unsigned int Id;
+    
+    while(Reader.NextKey(Id)) {
+
+        if(!Id) {
+            Error = "";
+            return true;
+        }
+        
+        unsigned int Num = NumElements();
+        CpCCCLLexEntry pEntry;
+        GetEntryByString(CInternTable::GetKey(Id)->GetString(), pEntry);
+
+        if(!pEntry || NumElements() != Num + 1)
+            return false; // empty or repeated key
+
+        if(!Reader.ReadEntry(pEntry))
+            return false;
+    }
+
+    return false;
+}
+
+//
+// Merging snapshots
+//
+
+// The inputs are merged through a priority queue holding, for each input
+// which was not yet fully read, the key string of its next entry and the
+// number of the input. The smallest key is at the top of the queue (among
+// equal keys, the one of the first input).
+
+typedef pair<CStrKey*, unsigned int> tMergeHead;
+
+class CMergeHeadComp
+{
+public:
+    bool operator()(tMergeHead const& A, tMergeHead const& B) {
+        int Comp = A.first->Compare(*B.first);
+        return Comp > 0 || (!Comp && A.second > B.second);
+    }
+};
+
+typedef priority_queue<tMergeHead, vector<tMergeHead>, CMergeHeadComp>
+    tMergeQueue;
+
+// Returns true if the two file names refer to the same (existing) file
+
+static bool
+SameFile(string const& A, string const& B)
+{
+    struct stat StatA, StatB;
+
+    if(A == B)
+        return true;
+
+    return (!stat(A.c_str(), &StatA) && !stat(B.c_str(), &StatB) &&
+            StatA.st_dev == StatB.st_dev && StatA.st_ino == StatB.st_ino);
+}
+
+// The merged snapshot is written to a temporary file, which is renamed to
+// the output file only after it was completely written. The following
+// object removes the temporary file when the merge fails.
+
+class CMergeTmpFile
+{
+private:
+    string m_FileName;
+public:
+    CMergeTmpFile(string const& FileName) : m_FileName(FileName) {}
+    ~CMergeTmpFile() {
+        if(!m_FileName.empty())
+            remove(m_FileName.c_str());
+    }
+    // the file was renamed (and should not be removed)
+    void Release() { m_FileName.clear(); }
+};
+
+bool
+CCCLLexicon::MergeSnapshots(vector<string> const& InFiles,
+                            string const& OutFile, string& Error)
+{
+    // open the inputs and read their strings (these must all be interned
+    // before the strings of the output are written)
+
+    vector<CpCSnapshotReader> Inputs;
+    // the intern table ID of the next key of each input (0 when all
+    // entries of the input were read)
+    vector<unsigned int> Keys(InFiles.size(), 0);
+    tMergeQueue Heads;
+
+    // the output replaces its file only at the end, so an input which is
+    // also the output would not be read correctly
+    for(unsigned int i = 0 ; i < InFiles.size() ; i++) {
+        if(SameFile(InFiles[i], OutFile)) {
+            Error = "the output lexicon snapshot file '" + OutFile +
+                "' is also an input";
+            return false;
+        }
+    }
+    
+    for(unsigned int i = 0 ; i < InFiles.size() ; i++) {
+        
+        Inputs.push_back(new CSnapshotReader(InFiles[i]));
+        
+        if(!Inputs.back()->ReadHeader(Error))
+            return false;
+
+        if(Inputs.back()->Version() < 2) {
+            Error = "lexicon snapshot file '" + InFiles[i] + "' was written "
+                "by an older version (its entries are not sorted). Load it "
+                "and save it again before merging it";
+            return false;
+        }
+        
+        if(!Inputs.back()->NextKey(Keys[i])) {
+            Error = "lexicon snapshot file '" + InFiles[i] + "' is corrupt";
+            return false;
+        }
+
+        if(Keys[i])
+            Heads.push(tMergeHead(CInternTable::GetKey(Keys[i]), i));
+    }
+
+    string TmpFile = OutFile + ".tmp";
+    ofstream Out(TmpFile.c_str(), ios::out | ios::binary | ios::trunc);
+
+    if(!Out) {
+        Error = "could not open lexicon snapshot file '" + TmpFile +
+            "' for writing";
+        return false;
+    }
+
+    CMergeTmpFile TmpFileRemover(TmpFile);
+
+    CBinWriter Writer(Out);
+
+    Writer.PutU32(LEX_SNAPSHOT_MAGIC);
+    Writer.PutU32(LEX_SNAPSHOT_VERSION);
+
+    Writer.PutU32(CInternTable::Size());
+    for(unsigned int Id = 1 ; Id <= CInternTable::Size() ; Id++) {
+        CStrKey* pKey = CInternTable::GetKey(Id);
+        // (the ID of a released string is written as an empty string)
+        if(pKey)
+            Writer.PutStr(pKey->GetStr(), pKey->Length());
+        else
+            Writer.PutStr("", 0);
+    }
+
+    // merge the entries (in key order)
+    
+    unsigned int EntryNum = 0;
+    
+    while(!Heads.empty()) {
+
+        unsigned int Id = Keys[Heads.top().second];
+        CpCCCLLexEntry pEntry;
+
+        // read the entries of this key from all inputs which have it
+
+        while(!Heads.empty() && Keys[Heads.top().second] == Id) {
+            
+            unsigned int Input = Heads.top().second;
+            CpCCCLLexEntry pInEntry = new CCCLLexEntry();
+
+            Heads.pop();
+
+            Error = "lexicon snapshot file '" + InFiles[Input] +
+                "' is corrupt";
+            
+            if(!Inputs[Input]->ReadEntry(pInEntry) ||
+               !Inputs[Input]->NextKey(Keys[Input]))
+                return false;
+            
+            if(!pEntry)
+                pEntry = pInEntry;
+            else
+                pEntry->Merge(pInEntry);
+
+            if(!Keys[Input])
+                continue; // end of input
+            
+            CStrKey* pNext = CInternTable::GetKey(Keys[Input]);
+            
+            if(pNext->Compare(*CInternTable::GetKey(Id)) <= 0) {
+                Error = "the entries of lexicon snapshot file '" +
+                    InFiles[Input] + "' are not sorted";
+                return false;
+            }
+
+            Heads.push(tMergeHead(pNext, Input));
+        }
+
+        Writer.PutU32(Id);
+        pEntry->Write(Writer);
+        EntryNum++;
+    }
+    
+    Writer.PutU32(0);
+    Writer.PutU32(EntryNum);
+    Writer.PutChecksum();
+    Out.close();
+
+    if(Writer.IsError() || Out.fail()) {
+        Error = "error while writing lexicon snapshot file '" + TmpFile + "'";
+        return false;
+    }
+
+    if(rename(TmpFile.c_str(), OutFile.c_str())) {
+        Error = "could not rename lexicon snapshot file '" + TmpFile +
+            "' to '" + OutFile + "'";
+        return false;
+    }
+
+    TmpFileRemover.Release();
+
+    Error = "";
+    return true;
+}
@@ -17,6 +17,8 @@
 #include <ostream>
 #include <sstream>
 #include <algorithm>
+#include <string.h>
+#include "yError.h"
 #include "CCLStat.h"
 #include "yVector.h"
 
@@ -34,7 +36,7 @@ CCCLVal::CCCLVal()
 }
 
 CCCLVal::CCCLVal(unsigned int Size) :
-        CRvector<float>(Size)
+        CRPropVec<CCLVAL_PROP_NUM>(Size)
 {
 #ifdef DETAILED_DEBUG
         IncObjCount();
@@ -76,12 +78,24 @@ static int pCCLStats[] = {
     (-1)
 };
 
+// Vector properties read when parsing (see CCCLLink)
+
+static int pCCLParseStats[] = {
+    CCCLStat::eLearn,
+    CCCLStat::eBlock,
+    CCCLStat::eIn,
+    CCCLStat::eOut,
+    CCCLStat::eEoL * CCCLStat::eDerived + CCCLStat::eIn,
+    (-1)
+};
+
 CPropConv CCCLStat::m_TableConv(pCCLStatsTop, pCCLStatsNoTop);
 CPropConv CCCLStat::m_VecConv(NULL, pCCLStats, true);
 
 CCCLStat::CCCLStat() :
         CStat<CLabel, CCCLVal>(m_TableConv.TopListNum(), CCLST_TOP_LENGTH,
-                               CCLST_DEFAULT_HASH_SIZE, false, 2)
+                               CCLST_DEFAULT_HASH_SIZE, false, 2),
+        m_Version(0)
 {
 #ifdef DETAILED_DEBUG
     IncObjCount();
@@ -95,14 +109,6 @@ CCCLStat::~CCCLStat()
 #endif
 }
 
-CCCLStat*
-CCCLStat::GetNext(bool bCreate)
-{
-    if(bCreate && !m_pNext)
-        m_pNext = new CCCLStat();
-
-    return m_pNext;
-}
 
 CCCLStatIter*
 CCCLStat::GetIter(unsigned int Stat)
@@ -110,6 +116,57 @@ CCCLStat::GetIter(unsigned int Stat)
     return new CCCLStatIter(this, Stat);
 }
 
+void
+CCCLStat::Merge(CCCLStat* pStat)
+{
+    if(!pStat) {
+        yPError(ERR_MISSING, "statistics object missing");
+    }
+
+    // vector statistics
+    
+    for(unsigned int Code = 0 ; Code < pStat->LocalSize() ; Code++)
+        (*this)[pStat->LocalCodeProp(Code)] += pStat->LocalVal(Code);
+
+    // label statistics. As when learning, a label is only added to a top
+    // list if its strength was incremented for that property (a label in
+    // a top list of the merged object may have a zero strength).
+
+    for(CPtr<CStrgIter> pIter = pStat->GetFullIter() ; *pIter ; ++(*pIter)) {
+        CCCLVal* pVal = pIter->GetVal();
+        for(unsigned int Code = 0 ; Code < pVal->size() ; Code++) {
+            float Strg = pStat->GetStrengthFromVec(pVal, Code);
+            IncStrength(pIter->GetKey(), Code, Strg,
+                        Strg > 0 || IsInTheTopList(pVal, Code));
+        }
+    }
+
+    IncVersion();
+}
+
+void
+CCCLStat::AddParseProps()
+{
+    for(int* pProp = pCCLParseStats ; *pProp >= 0 ; pProp++)
+        m_VecConv.GetPropCode(*pProp);
+}
+
+void
+CCCLStat::Freeze()
+{
+    Extend();
+    FreezeEntries();
+    MakeImmortal();
+}
+
+void
+CCCLStat::MarkStrings()
+{
+    // the labels in the top lists are also in the table
+    for(CPtr<CStrgIter> pIter = GetFullIter() ; *pIter ; ++(*pIter))
+        CInternTable::Mark(pIter->GetKey().GetId());
+}
+
 //
 // Printing auxiliary functions
 //
@@ -228,6 +285,79 @@ CCCLStat::GetPrintIter(unsigned int Stat)
     return (CStatIterPrintObj*)GetIter(Stat);
 }
 
+//////////////////////////////////////////
+// Statistics of all adjacency positions //
+//////////////////////////////////////////
+
+CCCLAdjStats::CCCLAdjStats() :
+        m_pStats(NULL), m_Length(0), m_CopyVersion(0)
+{
+#ifdef DETAILED_DEBUG
+    IncObjCount();
+#endif
+    Extend(1);
+    UpdateStatCopy();
+}
+
+CCCLAdjStats::~CCCLAdjStats()
+{
+#ifdef DETAILED_DEBUG
+    DecObjCount();
+#endif
+    for(unsigned int Pos = 0 ; Pos < m_Length ; Pos++)
+        if(m_pStats[Pos]->UnRef() <= 0)
+            delete m_pStats[Pos];
+
+    if(m_pStats)
+        CPoolAlloc::Free(m_pStats, m_Length * sizeof(CCCLStat*));
+}
+
+CCCLStat*
+CCCLAdjStats::Extend(unsigned int Length)
+{
+    if(Length <= m_Length)
+        return m_Length ? m_pStats[m_Length-1] : NULL;
+
+    CCCLStat** pStats =
+        (CCCLStat**)CPoolAlloc::Alloc(Length * sizeof(CCCLStat*));
+
+    if(m_pStats) {
+        memcpy(pStats, m_pStats, m_Length * sizeof(CCCLStat*));
+        CPoolAlloc::Free(m_pStats, m_Length * sizeof(CCCLStat*));
+    }
+
+    for(unsigned int Pos = m_Length ; Pos < Length ; Pos++) {
+        pStats[Pos] = new CCCLStat();
+        pStats[Pos]->Ref();
+    }
+
+    m_pStats = pStats;
+    m_Length = Length;
+
+    return m_pStats[m_Length-1];
+}
+
+void
+CCCLAdjStats::UpdateStatCopy()
+{
+    if(!m_pCopy || m_CopyVersion != m_pStats[0]->Version()) {
+        m_pCopy = new CCCLStatCopy(m_pStats[0]);
+        m_CopyVersion = m_pStats[0]->Version();
+    }
+}
+
+void
+CCCLAdjStats::Freeze()
+{
+    for(unsigned int Pos = 0 ; Pos < m_Length ; Pos++)
+        m_pStats[Pos]->Freeze();
+
+    UpdateStatCopy();
+    m_pCopy->Extend();
+    m_pCopy->MakeImmortal();
+    MakeImmortal();
+}
+
 ///////////////////////////////////
 // Vector statistics copy object //
 ///////////////////////////////////
@@ -379,8 +509,8 @@ CCCLStatCopy::Strongest(CCCLStat::eLabelStat LabelStat)
 string const&
 CCCLStatIter::EntryName()
 {
-    if(Data())
-        Data()->LabelString(m_EntryName);
+    if(!Data().IsNull())
+        Data().LabelString(m_EntryName);
     else
         m_EntryName = "<NULL>";
 
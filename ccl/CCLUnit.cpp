@@ -124,9 +124,10 @@ CSCCLUnit::CSCCLUnit(CStrKey* pName, vector<CpCStrKey>& UnitLabels,
     // Store the statistics
     m_Stats[LEFT] = CCLStats[LEFT];
     m_Stats[RIGHT] = CCLStats[RIGHT];
-    // create a copy of the first statistics
-    m_StatCopy[LEFT] = new CCCLStatCopy(m_Stats[LEFT]);
-    m_StatCopy[RIGHT] = new CCCLStatCopy(m_Stats[RIGHT]);
+    // get a copy of the first statistics (shared with the other units
+    // of the same lexical entry created since the statistics last changed)
+    m_StatCopy[LEFT] = m_Stats[LEFT]->GetStatCopy();
+    m_StatCopy[RIGHT] = m_Stats[RIGHT]->GetStatCopy();
     // mark all adjacencies as unused
     m_AdjUsed[LEFT] = m_AdjUsed[RIGHT] = 0;
     
@@ -140,8 +141,8 @@ CSCCLUnit::CSCCLUnit(CStrKey* pName, vector<CpCStrKey>& UnitLabels,
         pLabels->SetUnitLabel(*Iter);
     
     // Add adjacency labels (derived from statistics) to the label list
-    GetLabels()->SetAdjacencyLabels(LEFT, CCLStats[LEFT]);
-    GetLabels()->SetAdjacencyLabels(RIGHT, CCLStats[RIGHT]);
+    GetLabels()->SetAdjacencyLabels(LEFT, CCLStats[LEFT]->GetStat(0));
+    GetLabels()->SetAdjacencyLabels(RIGHT, CCLStats[RIGHT]->GetStat(0));
 }
 
 CSCCLUnit::~CSCCLUnit()
@@ -166,14 +167,7 @@ CSCCLUnit::GetStats(SCCLAdjPos const& AdjPos, bool bCreate)
     if(AdjPos.m_Pos < 0)
         return NULL;
     
-    CpCCCLStat pStats = m_Stats[AdjPos.m_Side];
-        
-    for(int Pos = AdjPos.m_Pos ; Pos > 0 ; Pos--) {
-        if(!(pStats = pStats->GetNext(bCreate)))
-            return NULL;
-    }
-
-    return pStats;
+    return m_Stats[AdjPos.m_Side]->GetStat(AdjPos.m_Pos, bCreate);
 }
 
 CCCLStatCopy*
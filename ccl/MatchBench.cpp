@@ -0,0 +1,661 @@
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+//
+// Label matching check and benchmark. This compares the matching of the
+// labels as sorted lists (CSortedMatcher below, based on CLabelStrgs) with
+// the lookup used by the parser, which looks up each label
+// (CCCLLink::MatchLabels()), on randomly generated statistics and label
+// tables, and measures the time each of them takes. The sorted matching
+// is not used by the parser: the label table of a unit is matched only
+// a few times, so sorting its labels costs more than it saves. This is not
+// part of the parser. It is built by 'make bench' (in the top directory)
+// and run as:
+//
+// matchbench [<number of cases> [<number of passes>]]
+//
+// <number of cases> (default 20000) pairs of a statistics object and a
+// label table are generated. The labels are drawn from a small set of
+// labels and the strengths are small integers, so that many labels match
+// and many matches are tied. The following is done:
+//
+// 1. CLabelStrgs::Match() is compared with CLabelStrgs::MatchScalar()
+//    on random lists of all lengths up to three times the block length.
+// 2. The time per match is measured for:
+//    sorted (new): one pass of the sorted matching over all cases, which
+//                  also creates the sorted label lists of the label
+//                  tables (as the parser would have to).
+//    sorted:       the sorted matching over <number of passes> (default
+//                  20) passes, with the sorted label lists already created.
+//    lookup:       MatchLabels() over <number of passes> passes.
+// 3. The sorted matching is compared with MatchLabels() on each case (the
+//    strength of the match and the list of best matching labels).
+//
+// The program prints the number of differences found and exits with
+// a non-zero status if there were any.
+//
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "Pool.h"
+#include "CCLLink.h"
+
+using namespace std;
+
+// number of different label strings
+#define MB_LABEL_STRINGS 24
+
+// current time in nanoseconds
+
+static double
+NowNs()
+{
+    struct timespec Time;
+
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    return Time.tv_sec * 1e9 + Time.tv_nsec;
+}
+
+// Simple pseudo random number generator (as in hashbench)
+
+class CBenchRand
+{
+private:
+    unsigned long long m_State;
+public:
+    CBenchRand(unsigned long long Seed) : m_State(Seed) {}
+    unsigned int Next() {
+        m_State = m_State * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (unsigned int)(m_State >> 33);
+    }
+    // uniform in [0,N)
+    unsigned int Next(unsigned int N) { return Next() % N; }
+};
+
+// Returns a random label (with a random type)
+
+static CLabel
+RandLabel(CBenchRand& Rand, vector<string>& Strings)
+{
+    return CLabel(Rand.Next(4), Strings[Rand.Next(Strings.size())]);
+}
+
+// Creates random statistics (on the 'eSeen' property)
+
+static CCCLStat*
+RandStat(CBenchRand& Rand, vector<string>& Strings)
+{
+    CCCLStat* pStat = new CCCLStat();
+    unsigned int Num = Rand.Next(2 * CCLST_TOP_LENGTH);
+
+    (*pStat)[CCCLStat::eLearn] = 1 + Rand.Next(4);
+    (*pStat)[CCCLStat::eBlock] = Rand.Next(3);
+
+    for(unsigned int i = 0 ; i < Num ; i++) {
+        pStat->IncStrg(RandLabel(Rand, Strings), CCCLStat::eSeen,
+                       1 + Rand.Next(4));
+    }
+
+    return pStat;
+}
+
+// Creates a random label table (both sides)
+
+static CCCLLabelTable*
+RandLabels(CBenchRand& Rand, vector<string>& Strings)
+{
+    CCCLLabelTable* pLabels = new CCCLLabelTable();
+    unsigned int Num = Rand.Next(3 * CCLLT_MAX_LABELS);
+
+    for(unsigned int i = 0 ; i < Num ; i++) {
+        pLabels->AddLabel(RandLabel(Rand, Strings), Rand.Next(SIDE_NUM),
+                          0.25 * (1 + Rand.Next(8)));
+    }
+
+    return pLabels;
+}
+
+////////////////////////
+// Sorted Label Lists //
+////////////////////////
+
+//
+// The following class holds a list of labels, each with a strength,
+// sorted by the label. Each label is represented by an integer which is
+// unique for the label (the packed label, see CLabel::GetPacked()) and
+// may appear only once in the list.
+// Two such lists are matched by finding the labels which appear in both
+// lists (see Match()). This is the sorted matching which is compared
+// here with the lookup of each label used by the parser.
+//
+// The labels are added in any order and then sorted (by Sort()). The
+// position in which each label was added is stored, so that the results
+// of the match can be returned in the original order of the labels.
+// The sorted lists are padded to a multiple of LBM_BLOCK entries, so
+// that the match can compare a block of labels from each list at a time
+// (using SIMD instructions, if available).
+//
+
+// number of labels compared together
+#define LBM_BLOCK 4
+// label used to pad the lists (this is larger than any packed label)
+#define LBM_PAD_LABEL (0xffffffff)
+
+class CLabelStrgs
+{
+private:
+    unsigned int m_Length;   // number of labels (without padding)
+    unsigned int m_Capacity; // number of entries allocated for each array
+    // The following arrays are allocated together in a single (pool
+    // allocated) block.
+    unsigned int* m_pLabels; // the labels (sorted, padded)
+    float* m_pStrgs;         // the strength of each label
+    unsigned int* m_pPos;    // position in which each label was added
+    float* m_pMatches;       // result of the last match (in sorted order)
+public:
+    CLabelStrgs() : m_Length(0), m_Capacity(0), m_pLabels(NULL),
+                    m_pStrgs(NULL), m_pPos(NULL), m_pMatches(NULL) {}
+    ~CLabelStrgs();
+private:
+    // not copied
+    CLabelStrgs(CLabelStrgs const&);
+    CLabelStrgs& operator=(CLabelStrgs const&);
+public:
+    // Remove all labels from the list
+    void Clear() { m_Length = 0; }
+    // Allocate space for (at least) the given number of labels
+    void Reserve(unsigned int Num) {
+        if(Num > m_Capacity)
+            Grow(Num);
+    }
+    // Add a label with the given strength (the label should not yet
+    // appear in the list).
+    void Add(unsigned int Label, float Strg) {
+        if(m_Length >= m_Capacity)
+            Grow(2 * m_Length);
+        m_pLabels[m_Length] = Label;
+        m_pStrgs[m_Length] = Strg;
+        m_Length++;
+    }
+    // Sort the labels added to the list. This must be called after
+    // the labels were added and before the list is matched.
+    void Sort();
+    // Number of labels in the list
+    unsigned int Length() { return m_Length; }
+
+    // For each label in this list, sets the entry in 'pMatch' at the
+    // position in which the label was added to the minimum of the strength
+    // of the label in this list and its strength in the list 'Labels'
+    // (0 if the label does not appear in 'Labels'). Both lists must be
+    // sorted. Returns the maximal value set.
+    float Match(CLabelStrgs& Labels, float* pMatch);
+    // Same as Match(), but without using SIMD instructions. This is used
+    // when these instructions are not available and as a reference.
+    float MatchScalar(CLabelStrgs& Labels, float* pMatch);
+private:
+    // length of the list after padding
+    unsigned int Padded() {
+        return (m_Length + LBM_BLOCK - 1) & ~(LBM_BLOCK - 1);
+    }
+    // allocate space for (at least) the given number of labels (keeping
+    // the labels already in the list).
+    void Grow(unsigned int Num);
+    // copy the match results to 'pMatch' (in the order in which the
+    // labels were added) and return the maximal match.
+    float CopyMatches(float* pMatch);
+};
+
+// bytes allocated for each entry (label, strength, position and match)
+#define LBM_ENTRY_BYTES (4 * sizeof(unsigned int))
+
+CLabelStrgs::~CLabelStrgs()
+{
+    if(m_pLabels)
+        CPoolAlloc::Free(m_pLabels, m_Capacity * LBM_ENTRY_BYTES);
+}
+
+void
+CLabelStrgs::Grow(unsigned int Num)
+{
+    // a multiple of the block size, so that there is room for the padding
+    unsigned int Capacity = (Num + LBM_BLOCK - 1) & ~(LBM_BLOCK - 1);
+
+    if(Capacity < 2 * LBM_BLOCK)
+        Capacity = 2 * LBM_BLOCK;
+    
+    char* pBlock = (char*)CPoolAlloc::Alloc(Capacity * LBM_ENTRY_BYTES);
+    unsigned int* pLabels = (unsigned int*)pBlock;
+    float* pStrgs = (float*)(pBlock + Capacity * sizeof(unsigned int));
+
+    if(m_pLabels) {
+        memcpy(pLabels, m_pLabels, m_Length * sizeof(unsigned int));
+        memcpy(pStrgs, m_pStrgs, m_Length * sizeof(float));
+        CPoolAlloc::Free(m_pLabels, m_Capacity * LBM_ENTRY_BYTES);
+    }
+
+    m_Capacity = Capacity;
+    m_pLabels = pLabels;
+    m_pStrgs = pStrgs;
+    m_pPos = (unsigned int*)(pStrgs + Capacity);
+    m_pMatches = (float*)(m_pPos + Capacity);
+}
+
+// The lists are short (bounded by the length of the label and statistics
+// top lists), so insertion sort is used.
+
+void
+CLabelStrgs::Sort()
+{
+    for(unsigned int i = 0 ; i < m_Length ; i++) {
+        unsigned int Label = m_pLabels[i];
+        float Strg = m_pStrgs[i];
+        unsigned int j = i;
+
+        for( ; j > 0 && m_pLabels[j-1] > Label ; j--) {
+            m_pLabels[j] = m_pLabels[j-1];
+            m_pStrgs[j] = m_pStrgs[j-1];
+            m_pPos[j] = m_pPos[j-1];
+        }
+
+        m_pLabels[j] = Label;
+        m_pStrgs[j] = Strg;
+        m_pPos[j] = i;
+    }
+
+    // pad to a full block (the padding labels may match each other, but
+    // with a zero strength)
+
+    for(unsigned int i = m_Length ; i < Padded() ; i++) {
+        m_pLabels[i] = LBM_PAD_LABEL;
+        m_pStrgs[i] = 0;
+    }
+}
+
+float
+CLabelStrgs::CopyMatches(float* pMatch)
+{
+    float Best = 0;
+
+    for(unsigned int i = 0 ; i < m_Length ; i++) {
+        pMatch[m_pPos[i]] = m_pMatches[i];
+        if(m_pMatches[i] > Best)
+            Best = m_pMatches[i];
+    }
+
+    return Best;
+}
+
+#ifdef __SSE2__
+
+// Each block of LBM_BLOCK (4) labels of this list is compared with the
+// blocks of the other list which may contain the same labels. Two blocks
+// are compared by comparing this block with the other block rotated by
+// 0, 1, 2 and 3 positions, so that each label is compared with each label.
+// A label matches at most one label in the other list, so the minimal
+// strengths of the matching labels can be accumulated by 'or'ing them
+// (all other positions being zero). As in the merge step of a merge sort,
+// the block whose last label is smaller is then replaced by the next
+// block in its list.
+
+float
+CLabelStrgs::Match(CLabelStrgs& Labels, float* pMatch)
+{
+    if(!m_Length || !Labels.m_Length) {
+        for(unsigned int i = 0 ; i < m_Length ; i++)
+            m_pMatches[i] = 0;
+        return CopyMatches(pMatch);
+    }
+    
+    unsigned int Num = Padded();
+    unsigned int OtherNum = Labels.Padded();
+    unsigned int const* pOther = Labels.m_pLabels;
+    float const* pOtherStrgs = Labels.m_pStrgs;
+    unsigned int i = 0;
+    unsigned int j = 0;
+
+    __m128i Block = _mm_loadu_si128((__m128i const*)m_pLabels);
+    __m128 Strgs = _mm_loadu_ps(m_pStrgs);
+    __m128 Matches = _mm_setzero_ps();
+
+    while(1) {
+        __m128i Other = _mm_loadu_si128((__m128i const*)(pOther + j));
+        __m128 OtherStrgs = _mm_loadu_ps(pOtherStrgs + j);
+
+        for(unsigned int Rot = 0 ; Rot < LBM_BLOCK ; Rot++) {
+            __m128 Equal = _mm_castsi128_ps(_mm_cmpeq_epi32(Block, Other));
+            Matches = _mm_or_ps(Matches,
+                                _mm_and_ps(Equal,
+                                           _mm_min_ps(Strgs, OtherStrgs)));
+            Other = _mm_shuffle_epi32(Other, _MM_SHUFFLE(0,3,2,1));
+            OtherStrgs = _mm_shuffle_ps(OtherStrgs, OtherStrgs,
+                                        _MM_SHUFFLE(0,3,2,1));
+        }
+
+        unsigned int Last = m_pLabels[i + LBM_BLOCK - 1];
+        unsigned int OtherLast = pOther[j + LBM_BLOCK - 1];
+
+        if(Last <= OtherLast) {
+            _mm_storeu_ps(m_pMatches + i, Matches);
+            if((i += LBM_BLOCK) >= Num)
+                break;
+            Block = _mm_loadu_si128((__m128i const*)(m_pLabels + i));
+            Strgs = _mm_loadu_ps(m_pStrgs + i);
+            Matches = _mm_setzero_ps();
+        }
+
+        if(OtherLast <= Last && (j += LBM_BLOCK) >= OtherNum) {
+            // no more matches for the remaining blocks
+            _mm_storeu_ps(m_pMatches + i, Matches);
+            while((i += LBM_BLOCK) < Num)
+                _mm_storeu_ps(m_pMatches + i, _mm_setzero_ps());
+            break;
+        }
+    }
+
+    return CopyMatches(pMatch);
+}
+
+#else /* !__SSE2__ */
+
+float
+CLabelStrgs::Match(CLabelStrgs& Labels, float* pMatch)
+{
+    return MatchScalar(Labels, pMatch);
+}
+
+#endif /* __SSE2__ */
+
+float
+CLabelStrgs::MatchScalar(CLabelStrgs& Labels, float* pMatch)
+{
+    unsigned int j = 0;
+
+    for(unsigned int i = 0 ; i < m_Length ; i++) {
+        while(j < Labels.m_Length && Labels.m_pLabels[j] < m_pLabels[i])
+            j++;
+
+        if(j < Labels.m_Length && Labels.m_pLabels[j] == m_pLabels[i])
+            m_pMatches[i] = min(m_pStrgs[i], Labels.m_pStrgs[j]);
+        else
+            m_pMatches[i] = 0;
+    }
+
+    return CopyMatches(pMatch);
+}
+
+// Sorted label list matching. This finds the same best matching labels
+// as CCCLLink::MatchLabels(). The labels of the statistics which are
+// stronger than 'Block' are matched with the labels of the unit (on the
+// opposite side) as two sorted lists. The match of each label is the
+// minimum of its strengths in the two lists. The best matching labels are
+// those with the maximal match (these are added in the order in which they
+// appear in the top list of the statistics, as in MatchLabels()).
+// The matcher holds the buffers used by each match, so that these are
+// not allocated on every call.
+
+class CSortedMatcher
+{
+private:
+    CLabelStrgs m_StatLabels;
+    vector<CLabel> m_Labels;
+    vector<float> m_Matches;
+public:
+    // Sets 'Labels' to the labels of the given side of the table, with
+    // their strengths, sorted for matching.
+    static void SortLabels(CCCLLabelTable* pTable, unsigned int Side,
+                           CLabelStrgs& Labels);
+    // Sets the best matching labels of 'pStats' (on side 'Side') in
+    // 'UnitLabels' (the sorted labels of the unit on the opposite side) in
+    // 'Best' and returns the strength of the match.
+    float Match(CCCLStat* pStats, CLabelStrgs& UnitLabels,
+                list<CLabel>& Best);
+};
+
+// The labels of a side are usually all in the top list of that side. Labels
+// are never removed from the table, so this is certain if the top list is
+// not full (no label was rejected by the top list) and all its entries
+// have their label (see CLabelTable::AddLabel()). Otherwise, the whole
+// table is searched for labels with a non-zero strength on this side.
+
+void
+CSortedMatcher::SortLabels(CCCLLabelTable* pTable, unsigned int Side,
+                           CLabelStrgs& Labels)
+{
+    Labels.Clear();
+    Labels.Reserve(pTable->NumEntries());
+
+    bool bComplete = pTable->GetTopLength(Side) < CCLLT_MAX_LABELS;
+
+    if(bComplete) {
+        for(CLabelIter Iter(pTable, Side) ; Iter ; ++Iter) {
+            if(Iter.Data().IsNull()) {
+                bComplete = false;
+                break;
+            }
+            if(Iter.Strg())
+                Labels.Add(Iter.Data().GetPacked(), Iter.Strg());
+        }
+    }
+
+    if(!bComplete) {
+        Labels.Clear();
+        for(CPtr<CCCLLabelTable::CStrgIter> pIter = pTable->GetFullIter() ;
+            *pIter ; ++(*pIter)) {
+            float Strg = pTable->GetStrengthFromVec(pIter->GetVal(), Side);
+            if(Strg)
+                Labels.Add(pIter->GetKey().GetPacked(), Strg);
+        }
+    }
+
+    Labels.Sort();
+}
+
+float
+CSortedMatcher::Match(CCCLStat* pStats, CLabelStrgs& UnitLabels,
+                      list<CLabel>& Best)
+{
+    Best.clear();
+
+    if(!pStats) // no match
+        return 0;
+
+    float Block = pStats->QtVV(CCCLStat::eBlock, CCCLStat::eLearn);
+
+    m_StatLabels.Clear();
+    m_Labels.clear();
+
+    for(CCCLStatIter Iter(pStats, CCCLStat::eSeen) ; Iter ; ++Iter) {
+
+        float StatStrg = Iter.QtV(CCCLStat::eLearn);
+
+        if(StatStrg <= Block)
+            break; // the top list is sorted, so the rest are also weaker
+
+        if(Iter.Data().IsNull())
+            continue; // cannot match
+
+        m_StatLabels.Add(Iter.Data().GetPacked(), StatStrg);
+        m_Labels.push_back(Iter.Data());
+    }
+
+    if(m_Labels.empty())
+        return 0;
+
+    m_StatLabels.Sort();
+    m_Matches.resize(m_Labels.size());
+
+    float Strg = m_StatLabels.Match(UnitLabels, &m_Matches[0]);
+
+    if(Strg == 0)
+        return 0;
+
+    for(unsigned int i = 0 ; i < m_Labels.size() ; i++)
+        if(m_Matches[i] == Strg)
+            Best.push_back(m_Labels[i]);
+
+    return Strg;
+}
+
+// Compares CLabelStrgs::Match() with CLabelStrgs::MatchScalar(). Returns
+// the number of differences.
+
+static unsigned int
+CheckKernel(CBenchRand& Rand, unsigned int CaseNum)
+{
+    unsigned int Diffs = 0;
+    CLabelStrgs Labels[2];
+    vector<float> Matches[2];
+
+    for(unsigned int Case = 0 ; Case < CaseNum ; Case++) {
+        for(unsigned int l = 0 ; l < 2 ; l++) {
+            // each label (0, ..., 4 * LBM_BLOCK - 1) is in the list
+            // with probability 1/2 (up to the length for this case)
+            Labels[l].Clear();
+            for(unsigned int Label = 0 ; Label < 4 * LBM_BLOCK ; Label++)
+                if(Rand.Next(2) &&
+                   Labels[l].Length() < Case % (3 * LBM_BLOCK + 1))
+                    Labels[l].Add(Label * 3 + Rand.Next(3),
+                                  0.5 * (1 + Rand.Next(4)));
+            Labels[l].Sort();
+        }
+
+        Matches[0].resize(Labels[0].Length() + 1);
+        Matches[1].resize(Labels[0].Length() + 1);
+
+        if(Labels[0].Match(Labels[1], &Matches[0][0]) !=
+           Labels[0].MatchScalar(Labels[1], &Matches[1][0]))
+            Diffs++;
+        else
+            for(unsigned int i = 0 ; i < Labels[0].Length() ; i++)
+                if(Matches[0][i] != Matches[1][i]) {
+                    Diffs++;
+                    break;
+                }
+    }
+
+    return Diffs;
+}
+
+int
+main(int ac, char** av)
+{
+    unsigned int CaseNum = ac > 1 ? atoi(av[1]) : 20000;
+    unsigned int PassNum = ac > 2 ? atoi(av[2]) : 20;
+
+    if(!CaseNum || !PassNum) {
+        fprintf(stderr, "usage: %s [<number of cases> "
+                "[<number of passes>]]\n", av[0]);
+        return 1;
+    }
+
+    CBenchRand Rand(17);
+    vector<string> Strings;
+    char Buf[32];
+
+    for(unsigned int i = 0 ; i < MB_LABEL_STRINGS ; i++) {
+        sprintf(Buf, "w%u", i);
+        Strings.push_back(Buf);
+    }
+
+    vector<CpCCCLStat> Stats(CaseNum);
+    vector<CpCCCLLabelTable> Labels(CaseNum);
+    vector<unsigned int> Sides(CaseNum);
+
+    for(unsigned int Case = 0 ; Case < CaseNum ; Case++) {
+        Stats[Case] = RandStat(Rand, Strings);
+        Labels[Case] = RandLabels(Rand, Strings);
+        Sides[Case] = Rand.Next(SIDE_NUM);
+    }
+
+    printf("%u cases, %u passes\n\n", CaseNum, PassNum);
+
+    // compare the kernel with the scalar version
+
+    unsigned int Diffs = CheckKernel(Rand, CaseNum);
+
+    printf("%-14s %u differences\n\n", "kernel", Diffs);
+
+    // timing
+
+    CSortedMatcher Matcher;
+    vector<CLabelStrgs*> Sorted(CaseNum);
+    list<CLabel> Best;
+    float Check[2] = { 0, 0 };
+    double Time = NowNs();
+
+    for(unsigned int Case = 0 ; Case < CaseNum ; Case++) {
+        Sorted[Case] = new CLabelStrgs();
+        CSortedMatcher::SortLabels(Labels[Case], OP(Sides[Case]),
+                                   *Sorted[Case]);
+        Matcher.Match(Stats[Case], *Sorted[Case], Best);
+    }
+
+    printf("%-14s %8.1f ns/match\n", "sorted (new)",
+           (NowNs() - Time) / CaseNum);
+
+    for(unsigned int Lookup = 0 ; Lookup < 2 ; Lookup++) {
+        Time = NowNs();
+        for(unsigned int Pass = 0 ; Pass < PassNum ; Pass++) {
+            for(unsigned int Case = 0 ; Case < CaseNum ; Case++) {
+                CCCLMatch Match;
+                Check[Lookup] += Lookup ?
+                    CCCLLink::MatchLabels(Stats[Case], Sides[Case],
+                                          Labels[Case], Match) :
+                    Matcher.Match(Stats[Case], *Sorted[Case], Best);
+            }
+        }
+        printf("%-14s %8.1f ns/match\n", Lookup ? "lookup" : "sorted",
+               (NowNs() - Time) / ((double)CaseNum * PassNum));
+    }
+
+    // compare with the lookup
+
+    unsigned int MatchDiffs = 0;
+    unsigned int Matched = 0;
+    unsigned int Tied = 0;
+
+    for(unsigned int Case = 0 ; Case < CaseNum ; Case++) {
+        CCCLMatch RefMatch;
+
+        float Strg = Matcher.Match(Stats[Case], *Sorted[Case], Best);
+        CCCLLink::MatchLabels(Stats[Case], Sides[Case], Labels[Case],
+                              RefMatch);
+
+        if(Strg != RefMatch.Strg() || Best != RefMatch.Labels())
+            MatchDiffs++;
+
+        if(RefMatch.Strg())
+            Matched++;
+        if(RefMatch.Labels().size() > 1)
+            Tied++;
+
+        delete Sorted[Case];
+    }
+
+    printf("\n%-14s %u differences (%u matched, %u tied)\n", "match",
+           MatchDiffs, Matched, Tied);
+    printf("\n(check %g %g)\n", Check[0], Check[1]);
+
+    return (Diffs + MatchDiffs) ? 1 : 0;
+}
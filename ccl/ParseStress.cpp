@@ -0,0 +1,233 @@
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+//
+// Multi-threaded parsing stress test. This checks that several threads
+// can parse at the same time with one shared lexicon (see
+// CCCLLexicon::Share()). This is not part of the parser. It must be
+// compiled with -DATOMIC_REF_COUNT (see Reference.h) and is built and run
+// by 'make stress' (in the top directory). It is run as:
+//
+// parsestress <input file> [<number of threads> [<number of passes>]]
+//
+// The input file is read as by cclbench (see CCLBench.cpp). A lexicon is
+// learned from the input and each utterance is then parsed once with this
+// lexicon, to obtain the reference parses. The lexicon is then shared and
+// the given number of threads (default 4) each parse the whole input
+// <number of passes> times (default 2) with a parser of its own, using
+// the shared lexicon. Each thread begins at a different utterance, so
+// that the threads look up different words at the same time. Every parse
+// is compared with the reference parse of the utterance and the test
+// fails (with a non-zero exit code) if any parse differs.
+//
+
+#ifndef ATOMIC_REF_COUNT
+#error "the parsing stress test must be compiled with -DATOMIC_REF_COUNT"
+#endif
+
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "RefStream.h"
+#include "CCLParser.h"
+
+using namespace std;
+
+// current time in nanoseconds
+
+static double
+NowNs()
+{
+    struct timespec Time;
+
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    return Time.tv_sec * 1e9 + Time.tv_nsec;
+}
+
+// the input utterances
+typedef vector<vector<string> > tUtterances;
+
+static unsigned int
+ReadUtterances(char const* pFileName, tUtterances& Utterances)
+{
+    ifstream In(pFileName);
+    string Line;
+    unsigned int TokenNum = 0;
+
+    while(getline(In, Line)) {
+        istringstream Words(Line);
+        string Word;
+        vector<string> Utterance;
+
+        while(Words >> Word)
+            Utterance.push_back(Word);
+
+        if(Utterance.empty())
+            continue;
+
+        TokenNum += Utterance.size();
+        Utterances.push_back(Utterance);
+    }
+
+    return TokenNum;
+}
+
+// Pushes the given utterance through the parser and returns the parse
+// printed (if the parser is in a parse cycle) in 'Parse'.
+
+static void
+ProcessUtterance(CParser* pParser, vector<string>& Utterance,
+                 string& Parse)
+{
+    vector<string> Labels; // no labels
+
+    for(vector<string>::iterator Iter = Utterance.begin() ;
+        Iter != Utterance.end() ; Iter++)
+        pParser->PushInputUnit(*Iter, Labels);
+    pParser->PushInputPunct(eEoUtterance);
+
+    if(pParser->IsParseCycle()) {
+        CpCRefOStrStream pOut = new CRefOStrStream();
+        ostringstream Out;
+
+        pParser->PrintObj(pOut, 0, 0, ParsePrintingFormat(), 0);
+        pOut->WriteTo(Out);
+        Parse = Out.str();
+    }
+
+    pParser->ClearUtterance();
+}
+
+// The work of one parsing thread
+
+struct SStressThread {
+    CCCLLexicon* m_pLexicon;     // the shared lexicon
+    tUtterances* m_pUtterances;  // the input
+    vector<string>* m_pExpected; // the reference parses
+    unsigned int m_First;        // utterance to begin with
+    unsigned int m_PassNum;      // number of passes over the input
+    unsigned int m_Diffs;        // number of parses which differ
+};
+
+static void
+StressThread(SStressThread* pRun)
+{
+    CpCCCLParser pParser = new CCCLParser(pRun->m_pLexicon);
+    unsigned int Num = pRun->m_pUtterances->size();
+    string Parse;
+
+    pParser->SetLearnCycle(false);
+    pParser->SetParseCycle(true);
+
+    for(unsigned int Pass = 0 ; Pass < pRun->m_PassNum ; Pass++) {
+        for(unsigned int i = 0 ; i < Num ; i++) {
+            unsigned int Utt = (pRun->m_First + i) % Num;
+            ProcessUtterance(pParser, (*pRun->m_pUtterances)[Utt], Parse);
+            if(Parse != (*pRun->m_pExpected)[Utt]) {
+                if(!pRun->m_Diffs)
+                    fprintf(stderr, "utterance %u: parsed\n%s\n"
+                            "instead of\n%s\n", Utt + 1, Parse.c_str(),
+                            (*pRun->m_pExpected)[Utt].c_str());
+                pRun->m_Diffs++;
+            }
+        }
+    }
+}
+
+int
+main(int ac, char** av)
+{
+    if(ac < 2) {
+        fprintf(stderr, "usage: %s <input file> [<number of threads> "
+                "[<number of passes>]]\n", av[0]);
+        return 1;
+    }
+
+    unsigned int ThreadNum = ac > 2 ? atoi(av[2]) : 4;
+    unsigned int PassNum = ac > 3 ? atoi(av[3]) : 2;
+    tUtterances Utterances;
+    unsigned int TokenNum = ReadUtterances(av[1], Utterances);
+
+    if(!ThreadNum)
+        ThreadNum = 1;
+    if(!PassNum)
+        PassNum = 1;
+
+    if(!TokenNum) {
+        fprintf(stderr, "no tokens in '%s'\n", av[1]);
+        return 1;
+    }
+
+    printf("%u utterances, %u tokens, %u threads, %u passes\n",
+           (unsigned int)Utterances.size(), TokenNum, ThreadNum, PassNum);
+
+    // learn the lexicon and parse with it (before it is shared)
+
+    CpCCCLLexicon pLexicon = new CCCLLexicon();
+    CpCCCLParser pParser = new CCCLParser(pLexicon);
+    vector<string> Expected(Utterances.size());
+
+    pParser->SetLearnCycle(true);
+    pParser->SetParseCycle(false);
+    for(unsigned int Utt = 0 ; Utt < Utterances.size() ; Utt++)
+        ProcessUtterance(pParser, Utterances[Utt], Expected[Utt]);
+
+    pParser->SetLearnCycle(false);
+    pParser->SetParseCycle(true);
+    for(unsigned int Utt = 0 ; Utt < Utterances.size() ; Utt++)
+        ProcessUtterance(pParser, Utterances[Utt], Expected[Utt]);
+
+    pParser = NULL;
+
+    // parse with the shared lexicon in several threads
+
+    pLexicon->Share();
+
+    vector<SStressThread> Runs(ThreadNum);
+    vector<thread> Threads;
+    double Time = NowNs();
+
+    for(unsigned int i = 0 ; i < ThreadNum ; i++) {
+        Runs[i].m_pLexicon = pLexicon;
+        Runs[i].m_pUtterances = &Utterances;
+        Runs[i].m_pExpected = &Expected;
+        Runs[i].m_First = (unsigned int)
+            (((unsigned long long)Utterances.size() * i) / ThreadNum);
+        Runs[i].m_PassNum = PassNum;
+        Runs[i].m_Diffs = 0;
+        Threads.push_back(thread(StressThread, &Runs[i]));
+    }
+
+    unsigned int Diffs = 0;
+
+    for(unsigned int i = 0 ; i < ThreadNum ; i++) {
+        Threads[i].join();
+        Diffs += Runs[i].m_Diffs;
+    }
+
+    Time = NowNs() - Time;
+
+    printf("%.0f tokens/sec (all threads), %u parses differ\n",
+           Time > 0 ? (double)TokenNum * PassNum * ThreadNum * 1e9 / Time : 0,
+           Diffs);
+
+    return Diffs ? 1 : 0;
+}
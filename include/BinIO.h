@@ -0,0 +1,127 @@
+#ifndef __BINIO_H__
+#define __BINIO_H__
+
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cstddef>
+#include <string>
+#include <istream>
+#include <ostream>
+
+//
+// Binary file reading and writing
+//
+
+// The following classes read and write the basic values stored in binary
+// files (such as lexicon snapshots). All values are written as 32 bit
+// little endian words (floats are written through their IEEE bit pattern)
+// so that the files do not depend on the machine which wrote them.
+// Strings are written as their length followed by their characters.
+//
+// Both classes keep a (32 bit FNV-1a) checksum of all bytes written/read
+// so far. The writer appends this checksum by PutChecksum() and the reader
+// compares it with the checksum it calculated by CheckChecksum().
+//
+// The reader can also read directly from a buffer in memory (such as
+// a memory mapped file), in which case it never reads beyond the end of
+// the buffer.
+
+// FNV-1a parameters
+#define BINIO_FNV_OFFSET 2166136261U
+#define BINIO_FNV_PRIME 16777619U
+
+// FNV-1a hash of the given bytes (the same function is used for the
+// checksums)
+inline unsigned int
+BinIOHash(char const* pBytes, unsigned int Num)
+{
+    unsigned int Hash = BINIO_FNV_OFFSET;
+
+    for(unsigned int i = 0 ; i < Num ; i++)
+        Hash = (Hash ^ (unsigned char)pBytes[i]) * BINIO_FNV_PRIME;
+
+    return Hash;
+}
+
+// Reads the 32 bit little endian word at the given address
+inline unsigned int
+BinIOWord(char const* pBytes)
+{
+    unsigned char const* p = (unsigned char const*)pBytes;
+    return (unsigned int)p[0] | ((unsigned int)p[1] << 8) |
+        ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+class CBinWriter
+{
+private:
+    std::ostream& m_Out;
+    unsigned int m_Checksum;
+public:
+    CBinWriter(std::ostream& Out) : m_Out(Out), m_Checksum(BINIO_FNV_OFFSET) {}
+
+    // write the given bytes as they are
+    void PutBytes(char const* pBytes, unsigned int Num);
+
+    void PutU32(unsigned int Val);
+    void PutInt(int Val) { PutU32((unsigned int)Val); }
+    void PutFloat(float Val);
+    void PutStr(std::string const& Str);
+    void PutStr(char const* pStr, unsigned int Len);
+    // writes the checksum of everything written so far
+    void PutChecksum();
+
+    // returns true if writing failed
+    bool IsError() { return !m_Out; }
+};
+
+class CBinReader
+{
+private:
+    std::istream* m_pIn; // NULL when reading from a buffer
+    char const* m_pBuf;
+    size_t m_BufLen;
+    size_t m_BufPos;
+    unsigned int m_Checksum;
+    bool m_bError;
+
+    bool GetBytes(char* pBytes, unsigned int Num);
+public:
+    CBinReader(std::istream& In) :
+            m_pIn(&In), m_pBuf(NULL), m_BufLen(0), m_BufPos(0),
+            m_Checksum(BINIO_FNV_OFFSET), m_bError(false) {}
+    // read the given buffer (of length BufLen)
+    CBinReader(char const* pBuf, size_t BufLen) :
+            m_pIn(NULL), m_pBuf(pBuf), m_BufLen(BufLen), m_BufPos(0),
+            m_Checksum(BINIO_FNV_OFFSET), m_bError(false) {}
+
+    // The following functions return false if the value could not be read
+    // (in which case the error flag is set and the target is not changed).
+    bool GetU32(unsigned int& Val);
+    bool GetInt(int& Val);
+    bool GetFloat(float& Val);
+    // Strings longer than MaxLen are considered an error.
+    bool GetStr(std::string& Str, unsigned int MaxLen = (1 << 24));
+    // Reads the checksum written by CBinWriter::PutChecksum() and
+    // returns true if it matches the checksum of the data read so far.
+    bool CheckChecksum();
+
+    // returns true if some read operation failed
+    bool IsError() { return m_bError; }
+};
+
+#endif /* __BINIO_H__ */
@@ -36,7 +36,8 @@
 // are attached on.
 //
 
-class CCCLLabelTable : public CLabelTable
+class CCCLLabelTable : public CLabelTable,
+                       public CCountedObj<CCCLLabelTable, eOSLabelTable>
 {
 public:
     CCCLLabelTable() :
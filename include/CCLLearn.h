@@ -31,7 +31,7 @@
 // update is used so that statistics used in parsing remain stable
 // throughout the calculation.
 
-class CCCLLearn : public CRef
+class CCCLLearn : public CRef, public CPoolObj
 {
 private:
     // The learning unit (on which the statistics are updated)
@@ -18,13 +18,17 @@
 // along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <string>
+#include <vector>
+#include <set>
 #include "PrsConst.h"
 #include "CCLStat.h"
 #include "Lexicon.h"
+#include "Mutex.h"
 
 // The lexical entry for the CCL parser
 
-class CCCLLexEntry : public CLexEntry
+class CCCLLexEntry : public CLexEntry, public CPoolObj,
+                     public CCountedObj<CCCLLexEntry, eOSLexEntry>
 {
 private:
     // A pair of statistics tables (left and right)
@@ -37,16 +41,54 @@ public:
     int Count() { return m_Count; }
     CTwoCCLStats const& GetCCLStats() { return m_Stats; }
 
+    // Write the count and statistics of this entry (see CCLSnapshot.cpp)
+    void Write(CBinWriter& Writer);
+    // Read the count and statistics written by Write() into this (new)
+    // entry. Returns false if the data is not valid.
+    bool Read(CBinReader& Reader, CStrIdMap& StrIds);
+    // Add the count and statistics of the given entry to this entry (the
+    // statistics objects of each side are merged by their adjacency
+    // position, see CCCLStat::Merge()).
+    void Merge(CCCLLexEntry* pEntry);
+    // Marks the intern table IDs of the labels of the statistics of this
+    // entry as in use (see CCCLLexicon::CollectStrings())
+    void MarkStrings();
+    // Freezes the statistics of this entry and makes it immortal (see
+    // CCCLLexicon::Share())
+    void Freeze();
+
     void PrintObj(CRefOStream* pOut, unsigned int Indent,
                   unsigned int SubIndent, eFormat Format, int Parameter);
 };
 
 typedef CPtr<CCCLLexEntry> CpCCCLLexEntry;
 
+class CCCLMappedLexicon;
+
 class CCCLLexicon : public CStrLexicon
 {
 private:
     LexPair m_PrintBound;
+    // the objects pointed at by m_PrintBound
+    CpCStrKey m_pPrintBoundKey;
+    CpCLexEntry m_pPrintBoundEntry;
+    // mapped lexicon backing this lexicon (if any)
+    CPtr<CCCLMappedLexicon> m_pMapped;
+    // shared lexicon backing this lexicon (if any, see SetShared())
+    CPtr<CCCLLexicon> m_pShared;
+    // was this lexicon shared (see Share())?
+    bool m_bShared;
+    // pruning statistics
+    unsigned int m_PruneNum;   // number of times entries were evicted
+    unsigned int m_EvictedNum; // number of entries evicted
+    // all lexicons which currently exist (created on first use)
+    static std::set<CCCLLexicon*>* m_pLexicons;
+    // was a string collection requested (see CollectStrings())?
+    static bool m_bCollectStrings;
+    // was any lexicon shared (see Share())?
+    static bool m_bAnyShared;
+    // protects the above (in multi-threaded builds, see Mutex.h)
+    static CMutex m_LexiconsMutex;
 public:
     CCCLLexicon();
     ~CCCLLexicon();
@@ -57,8 +99,162 @@ private:
     LexPair const& PrintBound();
     // returns a new (empty) lexical entry
     CLexEntry* NewEmptyLexEntry();
+    // returns a new entry for the given string, read from the mapped
+    // lexicon, if any (otherwise, an empty entry)
+    CLexEntry* NewLexEntry(std::string const& Name);
 public:
     CStrKey* GetEntryByString(std::string const& Name, CpCCCLLexEntry& pEntry);
+    // Same as above, but does not create a new entry if the string is not
+    // in the lexicon (NULL is then returned). This does not modify the
+    // lexicon (and therefore does not look in the mapped lexicon).
+    CStrKey* FindEntryByString(std::string const& Name,
+                               CpCCCLLexEntry& pEntry);
+    // Same as above, except that if the string is not in the lexicon but
+    // is in the mapped lexicon, its entry is created from the mapped
+    // lexicon (as by GetEntryByString()). An empty entry is only created
+    // if the entry in the mapped lexicon is corrupt.
+    CStrKey* FindOrMapEntryByString(std::string const& Name,
+                                    CpCCCLLexEntry& pEntry);
+    // Same as above, for the lower case version of the given string (see
+    // CStrLexicon::FindEntryByLowerString()). The key and entry returned
+    // are owned by the lexicon.
+    CStrKey* FindEntryByLowerString(std::string const& Name,
+                                    CCCLLexEntry*& pEntry);
+
+    //
+    // Binary snapshots
+    //
+
+    // Save the full contents of the lexicon (entries, counts and all
+    // statistics, including the top lists) to the given file. Returns
+    // false (and sets 'Error') if the file could not be written.
+    bool Save(std::string const& FileName, std::string& Error);
+    // Load a snapshot written by Save() into this lexicon, which must be
+    // empty. Returns false (and sets 'Error') if the file could not be
+    // read or is not a valid snapshot. In this case, the lexicon may
+    // have been partially loaded and should be discarded.
+    bool Load(std::string const& FileName, std::string& Error);
+    // Same as above, but write/read the snapshot to/from the given stream
+    // (beginning at its current position). 'FileName' is only used in
+    // error messages.
+    bool Save(std::ostream& Out, std::string const& FileName,
+              std::string& Error);
+    bool Load(std::istream& In, std::string const& FileName,
+              std::string& Error);
+    // Merge the given snapshots into a single snapshot written to
+    // 'OutFile': the entries of the same word are merged (see
+    // CCCLLexEntry::Merge()). This is a streaming merge: since the entries
+    // of a snapshot are sorted by their word, the snapshots are read in
+    // parallel and only the entries currently merged are held in memory.
+    // The output is written to <OutFile>.tmp, which is renamed to 'OutFile'
+    // when complete (and removed on failure). The output may not be one of
+    // the inputs. Returns false (and sets 'Error') if a file could not be
+    // read or written. This does not use any lexicon object (but interns
+    // the strings of the snapshots).
+    static bool MergeSnapshots(std::vector<std::string> const& InFiles,
+                               std::string const& OutFile,
+                               std::string& Error);
+
+    // Set the mapped lexicon backing this lexicon (see CCLMappedLexicon.h).
+    // Entries are then created from the mapped lexicon when first looked
+    // up. This should be set while the lexicon is still empty. Printing
+    // and saving the lexicon only apply to the entries created so far.
+    void SetMapped(CCCLMappedLexicon* pMapped);
+    // Is the lexicon backed by a mapped lexicon?
+    bool IsMapped() { return m_pMapped; }
+
+    //
+    // Sharing
+    //
+
+    // Makes this lexicon read only, so that it can be read by several
+    // threads, each parsing with its own parser (in builds compiled with
+    // -DATOMIC_REF_COUNT, see Reference.h). All entries and their
+    // statistics are frozen: they are extended, so that reading them
+    // does not modify them, and are made immortal, so that their
+    // reference counts are not updated. The lexicon can then no longer
+    // be modified (and is never pruned or compacted) and its entries are
+    // never deleted. Strings are then no longer collected (see
+    // CollectStrings()). A lexicon backed by a mapped lexicon cannot be
+    // shared. This should be called before any other thread uses the
+    // lexicon.
+    void Share();
+    // Was this lexicon shared?
+    bool IsShared() { return m_bShared; }
+    // Set the shared lexicon backing this lexicon (a parser constructed
+    // with a shared lexicon does this for a new lexicon of its own, see
+    // CCCLParser). Strings are then looked up first in the shared lexicon
+    // and entries are only created in this lexicon for strings not in
+    // the shared lexicon. Printing, saving, pruning and compacting this
+    // lexicon only apply to these entries. This should be set while the
+    // lexicon is still empty. Learning is not possible with such a
+    // lexicon (as it would modify the entries of the shared lexicon).
+    void SetShared(CCCLLexicon* pShared);
+    // Returns the shared lexicon backing this lexicon (NULL if none)
+    CCCLLexicon* GetShared() { return m_pShared; }
+
+    //
+    // Pruning
+    //
+
+    // If the lexicon exceeds the budget set by LexMaxEntries or
+    // LexMaxMemory, the least useful entries are evicted (see Prune()).
+    // This should only be called between utterances, when no entry is
+    // in use by the parser.
+    void EnforceBudget();
+    // Returns the number of bytes used by the objects which evicting
+    // entries releases (the entries, their statistics and statistics
+    // copies) in all lexicons (in multi-threaded builds, only those
+    // allocated by the calling thread). This is the memory bounded by
+    // LexMaxMemory. Other memory (such as the hash table of the lexicon
+    // and the interned strings) is not included, as evicting entries
+    // does not release it (or not immediately).
+    static size_t EntryBytes();
+    // Evicts the 'Num' least useful entries of the lexicon: those with
+    // the lowest count and, among these, those which were learned from
+    // least often (the sum of the eLearn statistics of both sides).
+    // Returns the number of entries evicted (a shared lexicon is never
+    // pruned).
+    unsigned int Prune(unsigned int Num);
+    // Prints the number of entries evicted since the last call (if any)
+    // and resets this count.
+    void PrintPruneStats(std::ostream& Out, std::string const& Prefix);
+
+    //
+    // Compaction
+    //
+
+    // Replaces all entries of the lexicon by copies allocated one after
+    // the other (in a pool allocator region, see Pool.h) in decreasing
+    // order of their count. Each entry is followed by its statistics
+    // objects and their labels and values, so that the most frequent
+    // entries (which are used by most lookups) are packed together in
+    // memory instead of being scattered among the rare entries. This does
+    // not change the contents of the lexicon. This should only be called
+    // between utterances, when no entry is in use by the parser. Returns
+    // false if the lexicon is empty or shared (in which case it is not
+    // compacted).
+    bool Compact();
+
+    //
+    // String collection
+    //
+
+    // Releases the strings of the intern table (see Intern.h) which are
+    // no longer used by any lexicon: as the word of an entry, in a label
+    // of the statistics of an entry or by the mapped lexicon backing a
+    // lexicon. The collection is only carried out if it was requested
+    // since the last collection, which happens whenever a lexicon is
+    // destroyed (e.g. when it is replaced by a loaded lexicon) or entries
+    // are evicted from a lexicon. This should only be called between
+    // utterances, when the parsers hold no labels outside the lexicon.
+    // Once a lexicon was shared (see Share()), strings are never
+    // released, as other threads may be using them. Returns the number
+    // of strings released.
+    static unsigned int CollectStrings();
+private:
+    // Marks the intern table IDs used by this lexicon (see above)
+    void MarkStrings();
 };
 
 typedef CPtr<CCCLLexicon> CpCCCLLexicon;
@@ -37,7 +37,7 @@ private:
     // strength of the match (-1) if not yet calculated.
     float m_Strg;
     // Best matching labels (as they appear on the matching side).
-    std::list<CpCLabel> m_Labels;
+    std::list<CLabel> m_Labels;
 
     // If there is exactly one matching label, the next two variables
     // describe the statistics for the match implied by the best match label.
@@ -53,6 +53,7 @@ public:
     CCCLMatch() : m_Strg(-1), m_bClassMatch(true) {}
 
     float Strg() { return m_Strg; }
+    std::list<CLabel> const& Labels() { return m_Labels; }
     bool ClassMatch() { return m_bClassMatch; }
     CCCLStatCopy* StatCopy() { return m_pStatCopy; }
     
@@ -107,7 +108,8 @@ public:
 // in the prefix and the next word.
 //
 
-class CCCLLink : public CRef, public CPrintObj
+class CCCLLink : public CRef, public CPrintObj, public CPoolObj,
+                 public CCountedObj<CCCLLink, eOSLink>
 {
 private:
     CpCCCLLexicon m_pLexicon; // the lexicon
@@ -155,6 +157,14 @@ private:
                         CCCLLabelTable* pLabels, CCCLMatch& BestMatches);
 
 public:
+    // Finds the best matching labels for CalcBestMatch() (same arguments)
+    // by looking up each label of the statistics in the label table of
+    // the unit. This sets the strength and labels of the match in
+    // 'BestMatches' (but nothing else) and returns the strength of the
+    // match. This is also the reference for the sorted label list matching
+    // checked by matchbench (see MatchBench.cpp in the ccl directory).
+    static float MatchLabels(CCCLStat* pStats, unsigned int Side,
+                             CCCLLabelTable* pLabels, CCCLMatch& BestMatches);
 
     // Functions to read the matching values.
     
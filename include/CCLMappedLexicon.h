@@ -0,0 +1,123 @@
+#ifndef __CCLMAPPEDLEXICON_H__
+#define __CCLMAPPEDLEXICON_H__
+
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <string>
+#include <vector>
+#include "Reference.h"
+#include "BinIO.h"
+#include "CCLLexicon.h"
+
+//
+// Lazy-loading (memory mapped) lexicon
+//
+
+// A mapped lexicon file stores a CCL lexicon in a layout which allows
+// single entries to be loaded from it on demand. It consists of a string
+// table (an offset array into a block of characters), a hash index (open
+// addressing, holding the offset of each entry) and the entries
+// themselves, in the same flattened format as in a lexicon snapshot (the
+// count and the statistics of both sides, including the top lists, see
+// CCLSnapshot.cpp). The file is mapped into memory (read only) so that
+// the index can be searched without reading it.
+//
+// Opening the file only maps it and checks its header, so this takes
+// the same (short) time for any lexicon size.
+//
+// A mapped lexicon is used as the backing of a CCCLLexicon (see
+// CCCLLexicon::SetMapped()): when a word is not yet in the lexicon, it is
+// looked up in the mapped index and, if found, an entry is created for it
+// from the mapped data. Only the words actually seen by the parser are
+// therefore ever loaded. The entry created is an ordinary (heap
+// allocated) lexical entry, so a process which has seen most words of
+// the lexicon holds most of the lexicon in its own memory, as if it
+// had loaded a snapshot.
+
+class CCCLMappedLexicon : public CRef, public CStrIdMap
+{
+private:
+    std::string m_FileName;
+    // the mapped file
+    char const* m_pBase;
+    size_t m_Size;
+
+    // header values
+    unsigned int m_StrNum;
+    unsigned int m_EntryNum;
+    unsigned int m_SlotNum; // number of slots in the index (power of 2)
+    size_t m_StrOffsets;    // offset of the string offset array
+    size_t m_StrChars;      // offset of the string characters
+    size_t m_Index;         // offset of the index slots
+
+    // intern table IDs of the strings in the file (0 if not yet interned)
+    std::vector<unsigned int> m_InternIds;
+
+    // was a warning printed for an invalid entry?
+    bool m_bWarned;
+
+    bool m_Error;
+    std::string m_ErrorStr;
+public:
+    // Maps the given file. On failure, the error is set.
+    CCCLMappedLexicon(std::string const& FileName);
+    ~CCCLMappedLexicon();
+
+    // Write the given lexicon to the given file in the mapped lexicon
+    // layout. The file is first written under <file>.tmp and then
+    // renamed, so that processes which have the old file mapped are not
+    // affected. Returns false (and sets 'Error') on failure.
+    static bool Write(CCCLLexicon* pLexicon, std::string const& FileName,
+                      std::string& Error);
+
+    // Returns the number of entries in the mapped lexicon
+    unsigned int NumEntries() { return m_EntryNum; }
+
+    // Looks the given string up in the index and returns the offset of its
+    // entry in the file (0 if not found).
+    size_t FindEntry(std::string const& Name);
+    // Reads the entry at the given offset (returned by FindEntry()) into
+    // the given (new) lexical entry. Returns false if the entry is
+    // not valid (a warning is printed for the first such entry).
+    bool ReadEntry(size_t Offset, CCCLLexEntry* pEntry);
+
+    // Interns the string with the given ID in the file (returns its intern
+    // table ID, 0 if the ID is not valid).
+    unsigned int InternId(unsigned int FileId);
+    // Marks the intern table IDs of the strings interned so far as in use
+    // (see CCCLLexicon::CollectStrings())
+    void MarkStrings();
+private:
+    // Returns the string with the given ID in the file (false if the
+    // ID is not valid)
+    bool GetStr(unsigned int FileId, char const*& pStr, unsigned int& Len);
+    // Returns the word at the given offset in the file
+    unsigned int Word(size_t Offset) { return BinIOWord(m_pBase + Offset); }
+public:
+    // error messages
+    bool IsError() { return m_Error; }
+    std::string& GetErrorStr() { return m_ErrorStr; }
+protected:
+    void SetError(std::string const& ErrorMsg) {
+        m_ErrorStr = ErrorMsg;
+        m_Error = true;
+    }
+};
+
+typedef CPtr<CCCLMappedLexicon> CpCCCLMappedLexicon;
+
+#endif /* __CCLMAPPEDLEXICON_H__ */
@@ -34,8 +34,14 @@ private:
     CpCCCLBrackets m_pCCLBrackets;
     // Queue of learing events
     CCCLLearnQueue m_LearnQueue;
+    // label vector reused by CreateUnit() (empty between calls)
+    std::vector<CpCStrKey> m_UnitLabels;
     
 public:
+    // If the given lexicon is shared (see CCCLLexicon::Share()), the
+    // parser uses a lexicon of its own backed by the shared lexicon, so
+    // that several parsers (in different threads) may parse with the same
+    // shared lexicon. Such a parser cannot learn.
     CCCLParser(CCCLLexicon* pLexicon);
     ~CCCLParser();
     
@@ -126,6 +132,21 @@ private:
 
     // The lexicon
     CLexicon* GetLexicon() { return m_pLexicon; }
+    // lexicon snapshots (see CCCLLexicon::Save() and CCCLLexicon::Load())
+    bool SaveLexicon(std::string const& FileName, std::string& Error);
+    bool LoadLexicon(std::string const& FileName, std::string& Error);
+    // mapped lexicons (see CCLMappedLexicon.h)
+    bool SaveMappedLexicon(std::string const& FileName, std::string& Error);
+    bool MapLexicon(std::string const& FileName, std::string& Error);
+    // compaction (see CCCLLexicon::Compact()). The current utterance is
+    // first cleared, as its units hold statistics of the lexicon entries.
+    bool CompactLexicon();
+    // checkpoints: the learned state is the lexicon, written as a snapshot.
+    // A lexicon backed by a mapped lexicon cannot be checkpointed.
+    bool SaveCheckpoint(std::ostream& Out, std::string const& FileName,
+                        std::string& Error);
+    bool LoadCheckpoint(std::istream& In, std::string const& FileName,
+                        std::string& Error);
     
     //
     // Print function
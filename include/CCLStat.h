@@ -30,7 +30,13 @@
 // simple CCL parser label value class
 //
 
-class CCCLVal : public CRvector<float>, public CPrintObj
+// Number of label statistics (see CCCLStat::eLabelStat). The statistics
+// are stored inline in the value objects.
+#define CCLVAL_PROP_NUM (1)
+
+class CCCLVal : public CRPropVec<CCLVAL_PROP_NUM>, public CPrintObj,
+                public CPoolObj,
+                public CCountedObj<CCCLVal, eOSCCLVal>
 {
 public:
     CCCLVal();
@@ -54,12 +60,26 @@ public:
 
 // Forward declarations
 
+class CBinWriter;
+class CBinReader;
 class CCCLStat;
+
+// Conversion of the string IDs stored in a lexicon file to intern table
+// IDs (see CCCLStat::Read()). Returns 0 if the file ID is not valid.
+
+class CStrIdMap
+{
+public:
+    virtual ~CStrIdMap() {}
+    virtual unsigned int InternId(unsigned int FileId) = 0;
+};
+
 typedef CPtr<CCCLStat> CpCCCLStat;
 class CCCLStatIter;
 typedef CPtr<CCCLStatIter> CpCCCLStatIter;
 
-class CCCLStat : public CStat<CLabel, CCCLVal>
+class CCCLStat : public CStat<CLabel, CCCLVal>, public CPoolObj,
+                 public CCountedObj<CCCLStat, eOSCCLStat>
 {
 public:
     //
@@ -116,15 +136,25 @@ private:
     static CPropConv m_TableConv;
     static CPropConv m_VecConv;
 
-    CpCCCLStat m_pNext; // next attachment statistics
-    
+    // Version of the statistics, incremented every time the statistics
+    // are modified (see IncVersion()).
+    unsigned int m_Version;
 public:
     CCCLStat();
     ~CCCLStat();
     bool IsEmpty() { return !(bool)(*this)[eLearn]; }
-    // Returns the next statistics object. If bCreate is set and no such
-    // object exists, it is created.
-    CCCLStat* GetNext(bool bCreate);
+
+    //
+    // Versioning
+    //
+
+    // Statistics copies (CCCLStatCopy) made of the same version of
+    // the statistics are identical, so a copy can be shared as long
+    // as the version did not change (see CCCLAdjStats::UpdateStatCopy()).
+    unsigned int Version() { return m_Version; }
+    // This must be called after the statistics are modified (learning
+    // and merging).
+    void IncVersion() { m_Version++; }
 private:
     CPropConv& GetTablePropConv() { return m_TableConv; }
     CPropConv& GetVecPropConv() { return m_VecConv; }
@@ -140,6 +170,50 @@ public:
     }
     
     CCCLStatIter* GetIter(unsigned int Stat);
+
+    //
+    // Saving and restoring (see CCCLLexicon::Save())
+    //
+
+    // Write the contents of this object (but not of the statistics of
+    // other adjacency positions) to the given writer. Labels are written
+    // with their intern table IDs.
+    void Write(CBinWriter& Writer);
+    // Read the contents written by Write() into this (empty) object.
+    // 'StrIds' maps the string IDs in the file to intern table IDs.
+    // Returns false if the data could not be read or is not consistent.
+    bool Read(CBinReader& Reader, CStrIdMap& StrIds);
+
+    //
+    // Merging (see CCCLLexicon::MergeSnapshots())
+    //
+
+    // Add the statistics of the given object (but not of the statistics
+    // of other adjacency positions) to this object: the vector values and
+    // the strengths of each label are summed. The top lists are updated
+    // in the same way as when learning, so that they hold the labels
+    // with the strongest sums.
+    void Merge(CCCLStat* pStat);
+
+    //
+    // String collection (see CCCLLexicon::CollectStrings())
+    //
+
+    // Marks the intern table IDs of the labels of this object as in use
+    void MarkStrings();
+
+    //
+    // Sharing (see CCCLLexicon::Share())
+    //
+
+    // Adds the vector properties read when parsing to the property
+    // conversion (which otherwise adds a property the first time it is
+    // looked up), so that parsing does not modify it.
+    static void AddParseProps();
+    // Prepares this object to be read by several threads: the vector is
+    // extended to all properties (so that reading it does not resize it)
+    // and the object and the values of its labels are made immortal.
+    void Freeze();
 private:
     // Printing auxiliary functions
     std::vector<int>& VecStatsToPrint();
@@ -222,7 +296,8 @@ public:
     float Strongest() { return m_Strongest; }
 };
 
-class CCCLStatCopy : public CCCLStatVectorCopy
+class CCCLStatCopy : public CCCLStatVectorCopy, public CPoolObj,
+                     public CCountedObj<CCCLStatCopy, eOSStatCopy>
 {
 private:
     // The following vector records statistics from different label properties.
@@ -286,11 +361,67 @@ private:
     CNameList& TableStatNames();
 };
 
+//
+// Statistics of all adjacency positions
+//
+
+// The statistics collected on one side of a lexical entry, a separate
+// statistics object for each adjacency position. The objects are stored
+// in an array indexed by the adjacency position, so the statistics of
+// any position are reached directly. The statistics of position 0 always
+// exist and those of the other positions are created when first needed.
+// The array holds a reference to each of the objects.
+// In addition, the object holds a copy of the statistics of position 0,
+// which is shared by all units created for this lexical entry until the
+// statistics change. The copy is replaced by the code which modifies the
+// statistics (see UpdateStatCopy()), so reading the statistics (as when
+// parsing) never modifies the object.
+
+class CCCLAdjStats : public CRef, public CPoolObj
+{
+private:
+    CCCLStat** m_pStats; // the statistics objects (pool allocated)
+    unsigned int m_Length; // number of adjacency positions
+    CpCCCLStatCopy m_pCopy; // copy of the statistics of position 0
+    unsigned int m_CopyVersion; // version of the statistics copied
+public:
+    CCCLAdjStats();
+    ~CCCLAdjStats();
+    // Number of adjacency positions for which statistics exist
+    unsigned int Length() { return m_Length; }
+    // Returns the statistics of the given adjacency position. If bCreate
+    // is set, the statistics of this position (and all positions before
+    // it) are created if they do not yet exist. Otherwise, NULL is
+    // returned for a position which does not exist.
+    CCCLStat* GetStat(unsigned int Pos, bool bCreate = false) {
+        if(Pos < m_Length)
+            return m_pStats[Pos];
+        return bCreate ? Extend(Pos + 1) : NULL;
+    }
+    // Returns the copy of the statistics of position 0 (the copy is not
+    // modified after it was created).
+    CCCLStatCopy* GetStatCopy() { return m_pCopy; }
+    // Replaces the copy of the statistics of position 0 by a new copy if
+    // the version of these statistics changed since the copy was made.
+    // This must be called after the statistics are modified (learning,
+    // merging and reading them).
+    void UpdateStatCopy();
+    // Freezes the statistics of all positions and their copy (see
+    // CCCLStat::Freeze()) and makes this object immortal.
+    void Freeze();
+private:
+    // Creates the statistics of all positions up to Length-1 (returns
+    // the last of these).
+    CCCLStat* Extend(unsigned int Length);
+};
+
+typedef CPtr<CCCLAdjStats> CpCCCLAdjStats;
+
 //
 // A pair of statistics collection objects (left and right)
 //
 
-typedef CpCCCLStat CTwoCCLStats[SIDE_NUM];
+typedef CpCCCLAdjStats CTwoCCLStats[SIDE_NUM];
 
 //
 // Name list class extension
@@ -95,13 +95,14 @@ public:
 // used in determining links (and their properties) between pairs of words.
 //
 
-class CSCCLUnit : public CCCLUnit
+class CSCCLUnit : public CCCLUnit, public CPoolObj,
+                  public CCountedObj<CSCCLUnit, eOSUnit>
 {
 private:
     // Labels on this unit (left and right)
     CpCCCLLabelTable m_pLabels;
     // left and right statistics (collected)
-    CpCCCLStat m_Stats[SIDE_NUM];
+    CTwoCCLStats m_Stats;
     // read-only copy of the statistics for each adjacency position
     CpCCCLStatCopy m_StatCopy[SIDE_NUM]; 
     // indicator which adjacency positions were already used for attachment
@@ -121,6 +122,8 @@ public:
     // If 'bCreate' is true, the object is created if it does
     // not yet exist (otherwise, NULL is returned).
     CCCLStat* GetStats(SCCLAdjPos const& AdjPos, bool bCreate);
+    // return the statistics of all adjacency positions on the given side
+    CCCLAdjStats* GetAdjStats(unsigned int Side) { return m_Stats[Side]; }
     // Returns the static copy of the statistics on the given
     // adjacency position. Returns NULL if such a copy does not exist.
     // A NULL return value does not necessarily mean that the original
@@ -50,6 +50,21 @@ private:
     std::vector<std::string> m_Evaluators;
     // Should the lexicon be printed at the end of this loop (if relevant)
     bool m_bPrintLexicon;
+    // Lexicon snapshot file to load before this loop and to save the
+    // lexicon to at the end of this loop (empty if none)
+    std::string m_LoadLexiconFile;
+    std::string m_SaveLexiconFile;
+    // Mapped lexicon file to use from this loop on and to write the lexicon
+    // to at the end of this loop (empty if none)
+    std::string m_MapLexiconFile;
+    std::string m_SaveMappedLexiconFile;
+    // Checkpoint file of this loop (empty if none) and the interval (in
+    // objects and in seconds, 0 for none) at which it should be written
+    std::string m_CheckpointFile;
+    unsigned int m_CheckpointObjs;
+    unsigned int m_CheckpointSecs;
+    // Should the execution sequence be resumed from the last checkpoint?
+    bool m_bResume;
     
     bool m_Error;
     std::string m_ErrorStr;
@@ -103,6 +118,16 @@ public:
     bool GetNonTrivialFilter() { return m_bNonTrivialFilter; }
     std::vector<std::string>& GetEvaluators() { return m_Evaluators; }
     bool PrintLexicon() { return m_bPrintLexicon; }
+    std::string const& GetLoadLexiconFile() { return m_LoadLexiconFile; }
+    std::string const& GetSaveLexiconFile() { return m_SaveLexiconFile; }
+    std::string const& GetMapLexiconFile() { return m_MapLexiconFile; }
+    std::string const& GetSaveMappedLexiconFile() {
+        return m_SaveMappedLexiconFile;
+    }
+    std::string const& GetCheckpointFile() { return m_CheckpointFile; }
+    unsigned int GetCheckpointObjs() { return m_CheckpointObjs; }
+    unsigned int GetCheckpointSecs() { return m_CheckpointSecs; }
+    bool Resume() { return m_bResume; }
     // set argument values
     void SetLastObjToProcess(unsigned int Last) {
         m_LastObjToProcess = Last;
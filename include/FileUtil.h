@@ -55,6 +55,8 @@ public:
         return m_Iter != m_Files.end();
     }
     std::string& operator()() { return *m_Iter; }
+    // number of files the iterator was advanced over since Begin()
+    unsigned int Position() { return m_Iter - m_Files.begin(); }
 
     // Appends the file list to the given string
     void PrintFileList(std::string& OutString);
@@ -32,6 +32,22 @@
 extern unsigned int g_StatisticsTopListMaxLen;
 // maximal number of labels (on each side of a labeled object)
 extern unsigned int g_MaxLabels;
+// expected number of entries in the lexicon (the lexicon hash table is
+// initially sized to hold this number of entries). Use 0 for the default.
+extern unsigned int g_LexHashSize;
+// if not 0, the lexicon hash table is resized incrementally
+extern unsigned int g_LexIncrementalResize;
+// maximal number of entries in the lexicon during learning (0 for no limit).
+// When exceeded, the least frequent entries are evicted.
+extern unsigned int g_LexMaxEntries;
+// maximal memory (in megabytes, as counted by the object statistics) used
+// during learning (0 for no limit). When exceeded, the least frequent
+// lexicon entries are evicted.
+extern unsigned int g_LexMaxMemory;
+// if not 0, the lexicon is compacted (its entries are copied to consecutive
+// memory in decreasing order of frequency) at the end of each step which
+// learned.
+extern unsigned int g_LexCompact;
 
 //
 // Input reading
@@ -89,6 +105,11 @@ extern unsigned int g_GroupedEvalMaxPrint;
 extern std::string g_CommentStr;
 // minimal count for an entry in the lexicon to be printed
 extern unsigned int g_LexMinPrint;
+// maximal number of lexicon entries to print (0 - no limit)
+extern unsigned int g_LexMaxPrint;
+// number of threads used to sort the lexicon for printing (the entries
+// are printed by a single thread)
+extern unsigned int g_LexPrintThreads;
 // Printing mode (see PrintUtils.h and PrintUtils.cpp for possible values).
 // These values should appear in a list, separated by whitespace.
 extern std::string g_PrintingMode;
@@ -19,6 +19,7 @@
 
 #include "HashDef.h"
 #include "HashKey.h"
+#include "OpenHash.h"
 
 #define HASH_DEFAULT_SIZE (1 << 10)  // 1024
 // log_2 of the maximal ratio allowed between the number of elements and
@@ -32,10 +33,11 @@
 // Hash entry structure (for internal use only)
 //
 
-struct CHashEnt
+struct CHashEnt : public CPoolObj, public CCountedObj<CHashEnt, eOSHashEnt>
 {
     friend class CHashBase;
     friend class CHashIterBase;
+    friend class CHashPosBase;
 public:
     CHashEnt() {}
     ~CHashEnt() {}
@@ -49,6 +51,34 @@ private:
 // Base Classes //
 //////////////////
 
+//
+// Base lookup position class
+//
+
+// A position object is returned by the stateless lookup functions of the
+// hash table (Find() and FindOrInsert()). It refers directly to the entry
+// found (if any) and remains valid until the table is next modified
+// (insertion, deletion or clearing). Position objects do not hold
+// a reference to the table or the entry.
+
+class CHashPosBase
+{
+    friend class CHashBase;
+private:
+    CHashEnt* m_pEnt; // entry found (NULL if none)
+protected:
+    CHashPosBase(CHashEnt* pEnt) : m_pEnt(pEnt) {}
+public:
+    CHashPosBase() : m_pEnt(NULL) {}
+    // indicates whether the lookup found an entry
+    bool Found() const { return m_pEnt != NULL; }
+    operator bool() const { return Found(); }
+protected:
+    // key and value of the entry (NULL if none)
+    CKey* Key() const { return m_pEnt ? (CKey*)(m_pEnt->m_Key) : NULL; }
+    CRef* Val() const { return m_pEnt ? (CRef*)(m_pEnt->m_Val) : NULL; }
+};
+
 //
 // base hash table class
 //
@@ -56,7 +86,13 @@ private:
 class CHashBase : public CRef {
 
     friend class CHashIterBase;
-    
+
+public:
+    // iterator and position classes to be used with this table
+    // (see CHashIter<> and CHashPos<>)
+    typedef CHashIterBase CIterBase;
+    typedef CHashPosBase CPosBase;
+
 private:
 
     unsigned int m_HashMask; // mask to be used to convert hash function
@@ -108,8 +144,7 @@ public:
             (CRef*)((*m_pLastLookup)->m_Val) : NULL;
     }
     // The following function performs a 'passive' lookup. This means that
-    // the lookup key is not stored in the table's last lookup cache and
-    // therefore cannot later be used for inserting a value.
+    // the lookup does not use or modify the table's last lookup cache.
     CRef* Val(CKey& Key);
 protected:
     // returns the key of the last lookup, if found (NULL if not found)
@@ -117,6 +152,23 @@ protected:
         return m_pLastLookup && *m_pLastLookup ?
             (CKey*)((*m_pLastLookup)->m_Key) : NULL;
     }
+
+    // Stateless lookup
+
+    // The following functions do not use the last lookup cache. Instead,
+    // they return the position of the entry found. Find() does not modify
+    // the table, so any number of readers may call it concurrently (as long
+    // as no one is modifying the table).
+    
+    // Returns the position of the entry with the given key (the position
+    // is empty if the key is not in the table).
+    CHashPosBase Find(CKey& Key);
+    // Returns the position of the entry with the given key. If the key is
+    // not in the table, a new entry is created for it, with a NULL value.
+    CHashPosBase FindOrInsert(CKey& Key);
+    // Sets the value of the entry at the given position (which must not be
+    // empty).
+    void SetVal(CHashPosBase const& Pos, CRef* pVal);
 public:
     unsigned int NumElements() { return m_NElements; }
 };
@@ -166,67 +218,102 @@ public:
 ///////////////////////
 
 // For every specific type of key and value, the templates below should
-// be used to create the appropriate hash class.
+// be used to create the appropriate hash class. The third template
+// argument selects the base table implementation: CHashBase (chaining,
+// the default), COpenHashBase (open addressing, see OpenHash.h) or
+// COpenHashTable<K,V> (typed open addressing, where the key functions
+// are not called virtually and the casts below do nothing).
 
 //
 // Specific key and value hash iterator (template)
 //
 
-template <class K, class V>
-class CHashIter : public CHashIterBase
+template <class K, class V, class B = CHashBase>
+class CHashIter : public B::CIterBase
 {
+    typedef typename B::CIterBase CBase;
 public:
-    CHashIter(CHashBase* pTable) : CHashIterBase(pTable) {}
+    CHashIter(B* pTable) : CBase(pTable) {}
     ~CHashIter() {}
 
     // reset to the beginning and return the key/value
-    K* FirstKey() { return (K*)CHashIterBase::FirstKey();  } 
-    V* FirstVal() { return (V*)CHashIterBase::FirstVal();  }
+    K* FirstKey() { return (K*)CBase::FirstKey();  } 
+    V* FirstVal() { return (V*)CBase::FirstVal();  }
 
     // advances to the next entry and returns the key/value
-    K* NextKey() { return (K*)CHashIterBase::NextKey(); }
-    V* NextVal() { return (V*)CHashIterBase::NextVal(); }
+    K* NextKey() { return (K*)CBase::NextKey(); }
+    V* NextVal() { return (V*)CBase::NextVal(); }
 
     // Get current key/val
-    K* GetKey() { return (K*)CHashIterBase::GetKey(); }
-    V* GetVal() { return (V*)CHashIterBase::GetVal(); }
+    K* GetKey() { return (K*)CBase::GetKey(); }
+    V* GetVal() { return (V*)CBase::GetVal(); }
+};
+
+//
+// Specific key and value lookup position (template)
+//
+
+template <class K, class V, class B = CHashBase>
+class CHashPos : public B::CPosBase
+{
+    typedef typename B::CPosBase CBase;
+public:
+    CHashPos() : CBase() {}
+    CHashPos(CBase const& Pos) : CBase(Pos) {}
+
+    // key and value of the entry (NULL if none)
+    K* Key() const { return (K*)CBase::Key(); }
+    V* Val() const { return (V*)CBase::Val(); }
 };
 
 //
 // Specific key and value hash tables types (template)
 //
 
-template <class K, class V>
-class CHash : public CHashBase
+template <class K, class V, class B = CHashBase>
+class CHash : public B
 {
 public:
 
     // Construction, destruction, clearing
-    CHash() : CHashBase() {}
-    CHash(unsigned int Size) : CHashBase(Size) {}
+    CHash() : B() {}
+    CHash(unsigned int Size) : B(Size) {}
     ~CHash() {}
     
     // Lookup, insertion, deletion (external versions)
     
     // key lookup operator
-    CHash& operator[](K& Key) { CHashBase::Lookup((CKey&)Key); return *this; }
-    int operator=(V* pVal) { return CHashBase::Insert((CRef*)pVal); }
-    operator V*() { return (V*)CHashBase::Val(); }
-    V* Val() { return (V*)CHashBase::Val(); }
-    V* Val(K& Key) { return (V*)CHashBase::Val((CKey&)Key); }
-    K* Key() { return (K*)CHashBase::Key(); }
+    CHash& operator[](K& Key) { B::Lookup(Key); return *this; }
+    int operator=(V* pVal) { return B::Insert(pVal); }
+    operator V*() { return (V*)B::Val(); }
+    V* Val() { return (V*)B::Val(); }
+    V* Val(K& Key) { return (V*)B::Val(Key); }
+    K* Key() { return (K*)B::Key(); }
     // delete from hash
-    int Delete(K& Key) { return CHashBase::Delete((CKey&)Key); }
+    int Delete(K& Key) { return B::Delete(Key); }
     // delete last key looked up
-    int Delete() { return CHashBase::Delete(); }
+    int Delete() { return B::Delete(); }
     // insert into hash
     int Insert(K& Key, V* pVal) {
-        return CHashBase::Insert((CKey&)Key, (CRef*)pVal);
+        return B::Insert(Key, pVal);
+    }
+    int Insert(V* pVal) { return B::Insert(pVal); }
+    // stateless lookup (see the base class)
+    CHashPos<K,V,B> Find(K& Key) { return B::Find(Key); }
+    // (only for the typed open addressing tables)
+    template <class M> CHashPos<K,V,B> FindMatch(M& Match,
+                                                 unsigned int Hash) {
+        return B::FindMatch(Match, Hash);
+    }
+    CHashPos<K,V,B> FindOrInsert(K& Key) {
+        return B::FindOrInsert(Key);
+    }
+    void SetVal(CHashPos<K,V,B> const& Pos, V* pVal) {
+        B::SetVal(Pos, pVal);
     }
-    int Insert(V* pVal) { return CHashBase::Insert((CRef*)pVal); }
     // returns an iterator to the first entry
-    CHashIter<K,V>* Begin() {
-        CHashIter<K,V>* pIter = new CHashIter<K,V>(this);
+    CHashIter<K,V,B>* Begin() {
+        CHashIter<K,V,B>* pIter = new CHashIter<K,V,B>(this);
         pIter->First();
         return pIter;
     }
@@ -23,8 +23,24 @@
 
 #include "Reference.h"
 
+class CKey;
 class CHashBase;
 class CHashPosBase;
 class CHashIterBase;
 
+// Hash and comparison functions of key type K (see HashKey.h)
+template <class K> struct CHashKeyTraits;
+
+// Open addressing hash table (see OpenHash.h)
+template <class K, class V, class T = CHashKeyTraits<K> >
+class COpenHashTable;
+template <class K, class V, class T = CHashKeyTraits<K> >
+class COpenHashTableIter;
+template <class K, class V, class T = CHashKeyTraits<K> >
+class COpenHashTablePos;
+
+class COpenHashBase;
+typedef COpenHashTableIter<CKey, CRef> COpenHashIterBase;
+typedef COpenHashTablePos<CKey, CRef> COpenHashPosBase;
+
 #endif /* __HASHDEF_H__ */
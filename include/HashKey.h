@@ -18,7 +18,11 @@
 // along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <string>
+#include <string.h>
 #include "Reference.h"
+#include "Pool.h"
+#include "ObjStats.h"
+#include "HashDef.h"
 
 //
 // Base abstract key class
@@ -36,6 +40,7 @@
 class CKey : public CRef
 {
     friend class CHashBase;
+    friend struct CHashKeyTraits<CKey>;
 private:
     virtual unsigned int HashFunc() = 0; // Hash function
     virtual bool HashEqual(CKey* pKey) = 0; // compares itself with pKey
@@ -43,6 +48,33 @@ private:
 
 typedef CPtr<CKey> CpCKey;
 
+//
+// Key traits
+//
+
+// The typed hash tables (see OpenHash.h) call the hash and comparison
+// functions of their key type K through this template. By default, these
+// are K::HashFunc() and K::Equal(K&), which are called directly (not
+// virtually) so that they can be inlined. A specific key type K
+// which is used as the key of a typed table should define these
+// functions (as public functions).
+
+template <class K>
+struct CHashKeyTraits
+{
+    static unsigned int Hash(K& Key) { return Key.K::HashFunc(); }
+    static bool Equal(K& Key, K* pKey) { return Key.K::Equal(*pKey); }
+};
+
+// Generic keys: the virtual functions of the key are used.
+
+template <>
+struct CHashKeyTraits<CKey>
+{
+    static unsigned int Hash(CKey& Key) { return Key.HashFunc(); }
+    static bool Equal(CKey& Key, CKey* pKey) { return Key.HashEqual(pKey); }
+};
+
 ////////////////////////
 // Specific key types //
 ////////////////////////
@@ -51,26 +83,109 @@ typedef CPtr<CKey> CpCKey;
 // String key types
 //
 
-// The basic string key type is based on the standard C string class.
+// The basic string key type holds a (NUL terminated) string and its length.
 // The string value is static - that is, it can only be determined
 // at the moment of construction. In this way, the same key may be
 // used in different tables without fear of it being changed.
+// Because the string cannot change, its hash value is calculated once,
+// when the key is constructed, and stored on the key.
+// A key may also be the key under which its string is stored in the
+// intern table (see Intern.h). Such a key carries the ID assigned to
+// its string by the table. For all other keys, the ID is 0.
+// The characters of a key which was not interned are owned by the key
+// (they are allocated through the pool allocator). When the key is
+// interned, these are released and the key refers instead to the copy
+// of the string stored in the string arena of the intern table (see
+// StrArena.h). Since only one key is interned for each string, the
+// keys of the same word in several lexicons should be this key (see
+// CInternTable::Find()). A copy of a key is never interned.
 
-class CStrKey : public CKey
+class CStrKey : public CKey, public CPoolObj,
+                public CCountedObj<CStrKey, eOSStrKey>
 {
+    friend class CInternTable;
 private:
-    std::string m_Str;
+    char const* m_pStr;  // the characters (owned by the key if not
+                         // interned, otherwise in the string arena)
+    unsigned int m_Len;  // length of m_pStr
+    unsigned int m_Hash; // hash value of m_pStr
+    unsigned int m_Id;   // interned ID of m_pStr (0 if not interned)
+
+    // set the key to an (owned) copy of the given string
+    void SetStr(char const* pStr, unsigned int Len) {
+        char* pCopy = (char*)CPoolAlloc::Alloc(Len + 1);
+        memcpy(pCopy, pStr, Len);
+        pCopy[Len] = 0;
+        m_pStr = pCopy;
+        m_Len = Len;
+    }
+    // release the characters of the key, if owned
+    void FreeStr() {
+        if(!m_Id)
+            CPoolAlloc::Free((void*)m_pStr, m_Len + 1);
+    }
+    // Called by the intern table when the key is interned: the key now
+    // refers to the interned copy of its string (in the string arena).
+    void SetInterned(char const* pStr, unsigned int Id) {
+        FreeStr();
+        m_pStr = pStr;
+        m_Id = Id;
+    }
+    // not assigned (the key owns its characters, see SetStr())
+    CStrKey& operator=(CStrKey const&);
 public:
-    CStrKey() : m_Str() {}
-    CStrKey(std::string const& s) : m_Str(s) {}
-    CStrKey(char const* s) : m_Str(s ? s : "") {}
-    CStrKey(CStrKey& Key) : m_Str(Key.m_Str.c_str()) {}
-    unsigned int HashFunc();
+    CStrKey() : m_Id(0) {
+        SetStr("", 0);
+        m_Hash = StrHash(m_pStr, m_Len);
+    }
+    CStrKey(std::string const& s) : m_Id(0) {
+        SetStr(s.data(), s.length());
+        m_Hash = StrHash(m_pStr, m_Len);
+    }
+    CStrKey(char const* s) : m_Id(0) {
+        if(!s)
+            s = "";
+        SetStr(s, strlen(s));
+        m_Hash = StrHash(m_pStr, m_Len);
+    }
+    CStrKey(char const* pStr, unsigned int Len) : m_Id(0) {
+        SetStr(pStr, Len);
+        m_Hash = StrHash(m_pStr, m_Len);
+    }
+    CStrKey(CStrKey& Key) : m_Hash(Key.m_Hash), m_Id(0) {
+        SetStr(Key.m_pStr, Key.m_Len);
+    }
+    ~CStrKey() { FreeStr(); }
+    unsigned int HashFunc() { return m_Hash; }
+    unsigned int GetId() { return m_Id; }
     bool HashEqual(CKey* pKey);
-    char const* GetStr() { return m_Str.c_str(); }
-    operator std::string const&() { return m_Str; }
-    operator char const*() { return m_Str.c_str(); }
+    // same as HashEqual(), for a key known to be a string key (keys
+    // which were both interned are equal only if they have the same ID)
+    bool Equal(CStrKey& Key) {
+        if(m_Id && Key.m_Id)
+            return m_Id == Key.m_Id;
+        return m_Hash == Key.m_Hash && m_Len == Key.m_Len &&
+            !memcmp(m_pStr, Key.m_pStr, m_Len);
+    }
+    char const* GetStr() { return m_pStr; }
+    unsigned int Length() { return m_Len; }
+    // returns a copy of the string
+    std::string GetString() { return std::string(m_pStr, m_Len); }
+    operator char const*() { return m_pStr; }
+    // Compares the strings of the two keys (as std::string::compare())
+    int Compare(CStrKey& Key);
+    bool operator<(CStrKey& Key) { return Compare(Key) < 0; }
     bool operator==(CStrKey& StrKey);
+
+    // The string hash function (may also be used to hash other strings)
+    static unsigned int StrHash(char const* pStr, unsigned int Len);
+    // Returns the hash value of the lower case version of the given
+    // string (that is, the value StrHash() would return after converting
+    // the string to lower case by ToLower()) without copying the string.
+    static unsigned int StrHashLower(char const* pStr, unsigned int Len);
+    // Returns true if the string of this key is equal to the lower case
+    // version of the given string.
+    bool EqualLower(char const* pStr, unsigned int Len);
 };
 
 typedef CPtr<CStrKey> CpCStrKey;
@@ -0,0 +1,328 @@
+#ifndef __IDHASH_H__
+#define __IDHASH_H__
+
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+//
+// Open addressing hash table with integer keys
+//
+
+// This is a variant of the open addressing hash table (see OpenHash.h)
+// for keys which are plain values identified by a non-zero integer (such
+// as labels, see Label.h). The integer of each key is stored directly in
+// its slot, so keys are neither allocated nor reference counted and
+// comparing two keys is a single integer comparison. The integer also
+// serves as the hash value of the key. Since 0 marks an empty slot, it
+// cannot be the integer of a key (the key constructed from 0 is the
+// 'null' key, which is never found in the table).
+//
+// The key type K must have an explicit constructor K(unsigned int) which
+// constructs the key with the given integer and a function GetPacked()
+// which returns this integer. Only the values (of type V) are reference
+// counted by the table.
+//
+// Slots are probed, the table is resized and its entries are iterated
+// exactly as in COpenHashTable (without incremental resizing). A table
+// holding keys with the same hash values as the keys of a COpenHashTable
+// therefore iterates over them in the same order. Entries cannot be
+// deleted (only the whole table can be cleared).
+
+#include "Reference.h"
+#include "ObjStats.h"
+#include "Pool.h"
+#include "yError.h"
+#include "OpenHash.h"
+
+template <class K, class V> class CIdHash;
+template <class K, class V> class CIdHashIter;
+
+//
+// Lookup position
+//
+
+// The position refers directly to the slot found, so it is only valid
+// until the next insertion into the table.
+
+template <class K, class V>
+class CIdHashPos
+{
+    friend class CIdHash<K,V>;
+    typedef typename CIdHash<K,V>::SSlot SSlot;
+private:
+    SSlot* m_pSlot; // slot found (NULL if none)
+    CIdHashPos(SSlot* pSlot) : m_pSlot(pSlot) {}
+public:
+    CIdHashPos() : m_pSlot(NULL) {}
+    // indicates whether the lookup found an entry
+    bool Found() const { return m_pSlot != NULL; }
+    operator bool() const { return Found(); }
+    // key and value of the entry (the null key and NULL if none)
+    K Key() const { return K(m_pSlot ? m_pSlot->m_Key : 0); }
+    V* Val() const { return m_pSlot ? m_pSlot->m_pVal : NULL; }
+};
+
+//
+// Hash table
+//
+
+template <class K, class V>
+class CIdHash : public CRef, public CPoolObj
+{
+    friend class CIdHashIter<K,V>;
+    friend class CIdHashPos<K,V>;
+private:
+    struct SSlot {
+        unsigned int m_Key; // integer of the key (0 if slot is empty)
+        V* m_pVal;          // value
+    };
+
+    unsigned int m_HashMask;  // size of the table minus 1
+    unsigned int m_HashShift; // shift converting a (mixed) hash value
+                              // into a slot number
+    SSlot* m_pSlots;
+    unsigned int m_NElements;   // Number of elements in the hash
+    unsigned int m_MaxElements; // Number of elements triggering a resize
+public:
+    CIdHash(unsigned int Size = OPEN_HASH_DEFAULT_SIZE);
+    ~CIdHash();
+    // clear all entries from the table
+    void Clear();
+private:
+    // allocate an empty slot array of the given size (a power of 2)
+    void AllocSlots(unsigned int Size);
+    static void FreeSlots(SSlot* pSlots, unsigned int Size) {
+        CObjStats::Remove(eOSIdHashSlots, Size * sizeof(SSlot));
+        CPoolAlloc::Free(pSlots, Size * sizeof(SSlot));
+    }
+    // doubles the size of the table
+    void Resize();
+    // First slot in the probe sequence of the given key (as in
+    // COpenHashTable).
+    unsigned int HomeSlot(unsigned int Key) {
+        return (unsigned int)(Key * 2654435769U) >> m_HashShift;
+    }
+    // Returns the slot holding the key or, if the key is not in the
+    // table, the empty slot at which it should be inserted.
+    SSlot* FindSlot(unsigned int Key) {
+        unsigned int Slot = HomeSlot(Key);
+        while(m_pSlots[Slot].m_Key && m_pSlots[Slot].m_Key != Key)
+            Slot = (Slot + 1) & m_HashMask;
+        return m_pSlots + Slot;
+    }
+public:
+    typedef CIdHashPos<K,V> CPos;
+
+    // Returns the position of the entry with the given key (the position
+    // is empty if the key is not in the table). This does not modify
+    // the table.
+    CPos Find(K Key) {
+        if(!Key.GetPacked())
+            return CPos();
+        SSlot* pSlot = FindSlot(Key.GetPacked());
+        return CPos(pSlot->m_Key ? pSlot : NULL);
+    }
+    // Returns the position of the entry with the given key. If the key is
+    // not in the table, a new entry is created for it, with a NULL value.
+    CPos FindOrInsert(K Key);
+    // Sets the value of the entry at the given position (which must not be
+    // empty).
+    void SetVal(CPos const& Pos, V* pVal);
+    // Returns an iterator over all entries of the table
+    CIdHashIter<K,V>* Begin() { return new CIdHashIter<K,V>(this); }
+    unsigned int NumElements() { return m_NElements; }
+    // number of slots in the table
+    unsigned int NumSlots() { return m_HashMask + 1; }
+};
+
+//
+// Iterator
+//
+
+template <class K, class V>
+class CIdHashIter : public CRef
+{
+    typedef typename CIdHash<K,V>::SSlot SSlot;
+private:
+    CPtr<CIdHash<K,V> > m_pTable; // table from which the iterator was
+                                  // created
+    unsigned int m_Slot;          // Current slot number
+    // advance to the first non-empty slot starting at the current slot
+    bool SkipEmpty() {
+        for( ; m_Slot <= m_pTable->m_HashMask ; m_Slot++)
+            if(m_pTable->m_pSlots[m_Slot].m_Key)
+                return true;
+        return false;
+    }
+public:
+    CIdHashIter(CIdHash<K,V>* pTable) : m_pTable(pTable), m_Slot(0) {
+        if(m_pTable)
+            SkipEmpty();
+    }
+    // advances to next entry. Returns false if no such entry exists,
+    // true otherwise
+    bool operator++() {
+        if(IsEnd())
+            return false;
+        m_Slot++;
+        return SkipEmpty();
+    }
+    // Has the iterator reached the end ?
+    bool IsEnd() { return !m_pTable || m_Slot > m_pTable->m_HashMask; }
+    operator bool() { return !IsEnd(); }
+    // get current key/value (the null key and NULL if none)
+    K GetKey() {
+        return K(IsEnd() ? 0 : m_pTable->m_pSlots[m_Slot].m_Key);
+    }
+    V* GetVal() {
+        return IsEnd() ? NULL : m_pTable->m_pSlots[m_Slot].m_pVal;
+    }
+};
+
+//
+// Template member functions
+//
+
+template <class K, class V>
+CIdHash<K,V>::CIdHash(unsigned int Size) : m_pSlots(NULL), m_NElements(0)
+{
+    unsigned int HashSize;
+
+    if(!Size)
+        Size = OPEN_HASH_DEFAULT_SIZE;
+
+    // round to the nearest (larger) power of 2 (as in COpenHashTable)
+    for(HashSize = 2 ; HashSize < Size ; HashSize = (HashSize << 1));
+
+    AllocSlots(HashSize);
+}
+
+template <class K, class V>
+CIdHash<K,V>::~CIdHash()
+{
+    Clear();
+    FreeSlots(m_pSlots, m_HashMask + 1);
+}
+
+template <class K, class V>
+void
+CIdHash<K,V>::AllocSlots(unsigned int Size)
+{
+    m_pSlots = (SSlot*)CPoolAlloc::Alloc(Size * sizeof(SSlot));
+    CObjStats::Add(eOSIdHashSlots, Size * sizeof(SSlot));
+
+    for(unsigned int i = 0 ; i < Size ; i++) {
+        m_pSlots[i].m_Key = 0;
+        m_pSlots[i].m_pVal = NULL;
+    }
+
+    m_HashMask = Size - 1;
+
+    for(m_HashShift = 32 ; Size > 1 ; Size = (Size >> 1))
+        m_HashShift--;
+
+    m_MaxElements = (unsigned int)
+        (((unsigned long long)(m_HashMask + 1) * OPEN_HASH_MAX_LOAD) / 100);
+    if(m_MaxElements > m_HashMask)
+        m_MaxElements = m_HashMask;
+}
+
+template <class K, class V>
+void
+CIdHash<K,V>::Clear()
+{
+    if(!m_NElements)
+        return; // nothing to clear
+
+    for(unsigned int Slot = 0 ; Slot <= m_HashMask ; Slot++) {
+        if(!m_pSlots[Slot].m_Key)
+            continue;
+        V* pVal = m_pSlots[Slot].m_pVal;
+        if(pVal && pVal->UnRef() <= 0)
+            delete pVal;
+        m_pSlots[Slot].m_Key = 0;
+        m_pSlots[Slot].m_pVal = NULL;
+    }
+
+    m_NElements = 0;
+}
+
+template <class K, class V>
+void
+CIdHash<K,V>::Resize()
+{
+    SSlot* pOldSlots = m_pSlots;
+    unsigned int OldMask = m_HashMask;
+
+    AllocSlots((m_HashMask + 1) << OPEN_HASH_RESIZE_FACTOR);
+
+    // the entries are moved in slot order (as in COpenHashTable)
+    for(unsigned int Old = 0 ; Old <= OldMask ; Old++) {
+        if(!pOldSlots[Old].m_Key)
+            continue;
+        unsigned int Slot = HomeSlot(pOldSlots[Old].m_Key);
+        while(m_pSlots[Slot].m_Key)
+            Slot = (Slot + 1) & m_HashMask;
+        m_pSlots[Slot] = pOldSlots[Old];
+    }
+
+    FreeSlots(pOldSlots, OldMask + 1);
+}
+
+template <class K, class V>
+CIdHashPos<K,V>
+CIdHash<K,V>::FindOrInsert(K Key)
+{
+    unsigned int Id = Key.GetPacked();
+
+    if(!Id) {
+        yPError(ERR_OUT_OF_RANGE, "the null key cannot be inserted");
+    }
+
+    SSlot* pSlot = FindSlot(Id);
+
+    if(pSlot->m_Key)
+        return CPos(pSlot);
+
+    // Make room before inserting, so that the slot returned does not move
+    if(m_NElements + 1 > m_MaxElements) {
+        Resize();
+        pSlot = FindSlot(Id);
+    }
+
+    pSlot->m_Key = Id;
+    pSlot->m_pVal = NULL;
+    m_NElements++;
+
+    return CPos(pSlot);
+}
+
+template <class K, class V>
+void
+CIdHash<K,V>::SetVal(CPos const& Pos, V* pVal)
+{
+    if(!Pos.m_pSlot) {
+        yPError(ERR_MISSING, "setting value at an empty position");
+    }
+
+    if(pVal)
+        pVal->Ref();
+    if(Pos.m_pSlot->m_pVal && Pos.m_pSlot->m_pVal->UnRef() <= 0)
+        delete Pos.m_pSlot->m_pVal;
+    Pos.m_pSlot->m_pVal = pVal;
+}
+
+#endif /* __IDHASH_H__ */
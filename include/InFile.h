@@ -55,6 +55,15 @@ public:
     // restart with new patterns.
     bool Restart(std::vector<std::string> const& Patterns);
     bool GetLine(); // reads the next line
+    // The position of the next line to be read: the number of the file
+    // (in the list of files matched by the patterns, beginning at 0) and
+    // the offset in that file. Returns false if the position cannot be
+    // determined.
+    bool GetPos(unsigned int& FileNum, unsigned long long& Offset);
+    // Continue reading from the given position (as returned by GetPos()
+    // for the same list of files). Returns false on failure (in which
+    // case the m_Bad flag is set).
+    bool SetPos(unsigned int FileNum, unsigned long long Offset);
     bool Bad() { return m_Bad; }
     bool Eof() { return m_Eof; }
     bool Fail() { return m_Bad || m_Eof; }
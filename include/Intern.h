@@ -0,0 +1,130 @@
+#ifndef __INTERN_H__
+#define __INTERN_H__
+
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+//
+// String interning table
+//
+
+// The intern table is a global table which assigns each string a dense
+// integer ID (starting at 1, the ID 0 is never assigned). The ID is
+// stored on the key under which the string is interned (see
+// CStrKey::GetId()), so once a key has been interned, its ID is available
+// without any lookup. The same string always receives the same ID, as
+// long as it is not released (see below).
+//
+// The words of the lexicon are interned when they are added to the
+// lexicon, so the same key object serves both as the lexicon key and as
+// the interned string. Objects which only need to identify a word (such
+// as labels) can then store its ID instead of a pointer to its key.
+//
+// The table holds a reference to the key interned for each string. The
+// characters of all interned strings are stored (once for each string)
+// in a string arena owned by the table, and the interned keys refer to
+// these characters instead of holding their own copy (see CStrKey).
+//
+// Strings which are no longer used can be released by a collection: all
+// IDs still in use are marked (between BeginCollect() and EndCollect())
+// and EndCollect() then releases the strings whose IDs were not marked
+// and whose keys are not referenced by anything but the table. The IDs
+// of released strings are assigned again to strings interned later.
+// The table and the arena are rebuilt, so that the memory used by the
+// released strings is freed.
+//
+// In multi-threaded builds (see Mutex.h) all access to the table is
+// serialized by a mutex, so strings may be interned by several threads.
+// A key returned by the table remains valid as long as it is not
+// released, so a collection may only take place when no other thread
+// uses the table (see CCCLLexicon::CollectStrings()).
+
+#include <string>
+#include <vector>
+#include "Hash.h"
+#include "StrArena.h"
+#include "Mutex.h"
+
+typedef COpenHashTable<CStrKey, CStrKey> CInternHashBase;
+typedef CHash<CStrKey, CStrKey, CInternHashBase> CInternHash;
+typedef CHashPos<CStrKey, CStrKey, CInternHashBase> CInternPos;
+
+class CInternTable
+{
+private:
+    // table of interned keys (each key is also its own value)
+    static CInternHash* m_pHash;
+    // the interned keys, by ID
+    static std::vector<CStrKey*>* m_pKeys;
+    // the characters of the interned strings
+    static CStrArena* m_pArena;
+    // IDs of released strings (to be assigned again)
+    static std::vector<unsigned int>* m_pFreeIds;
+    // IDs marked during a collection (NULL if no collection is active)
+    static std::vector<bool>* m_pMarks;
+    // serializes access to the table (in multi-threaded builds)
+    static CMutex m_Mutex;
+
+    // Look up the string of the given key in the table, adding the key if
+    // it is not found. Returns the ID.
+    static unsigned int Insert(CStrKey& Key);
+    // Same as Insert() and Find(), but the mutex must already be locked
+    static unsigned int InsertLocked(CStrKey& Key);
+    static CStrKey* FindLocked(char const* pStr, unsigned int Len);
+public:
+    // Returns the ID of the given key, interning it if necessary
+    static unsigned int Intern(CStrKey* pKey) {
+        return pKey->GetId() ? pKey->GetId() : Insert(*pKey);
+    }
+    // Returns the ID of the given string, interning it if necessary
+    static unsigned int Intern(std::string const& Str) {
+        return Intern(Str.data(), Str.length());
+    }
+    // Same as above, for the string of the given length
+    static unsigned int Intern(char const* pStr, unsigned int Len);
+    // Returns the key under which the given string is interned (NULL if
+    // the string is not interned). This does not intern the string.
+    static CStrKey* Find(char const* pStr, unsigned int Len);
+    // Returns the key interned under the given ID (NULL if none, which
+    // is also the case for the ID of a released string)
+    static CStrKey* GetKey(unsigned int Id) {
+        CMutexLock Lock(m_Mutex);
+        return (m_pKeys && Id < m_pKeys->size()) ? (*m_pKeys)[Id] : NULL;
+    }
+    // Returns the largest ID assigned (some IDs up to this ID may belong
+    // to released strings)
+    static unsigned int Size() {
+        CMutexLock Lock(m_Mutex);
+        return m_pKeys ? m_pKeys->size() - 1 : 0;
+    }
+
+    // Begins a collection (see above)
+    static void BeginCollect();
+    // Marks the given ID as in use (during a collection)
+    static void Mark(unsigned int Id) {
+        CMutexLock Lock(m_Mutex);
+        if(m_pMarks && Id < m_pMarks->size())
+            (*m_pMarks)[Id] = true;
+    }
+    // Releases the strings not marked since BeginCollect() (and not
+    // otherwise referenced). Returns the number of strings released.
+    static unsigned int EndCollect();
+    // Returns the string arena holding the interned strings (NULL if
+    // nothing was interned yet)
+    static CStrArena* GetArena() { return m_pArena; }
+};
+
+#endif /* __INTERN_H__ */
@@ -17,10 +17,9 @@
 // You should have received a copy of the GNU General Public License
 // along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
 
-#include <typeinfo>
 #include <string>
-#include "Reference.h"
 #include "HashKey.h"
+#include "Intern.h"
 
 ///////////////////
 // Label classes //
@@ -34,86 +33,66 @@
 // Label side bit
 #define LB_OTHER_SIDE 0x01  // label originates as an adjacent word
 
-// Currently, there is only one type of label object. This 
-// consists of a string and a side bit. The copy
-// constructor of the label key flips the side bit.
-// The CStrKey part of the CLabel may be shared among several
-// CLabel objects.
+// Number of bits used by the label type (the side bit and the bits added
+// by flipping opposite side labels, see CLabelTable::FlipAndAddLabel())
+#define LB_TYPE_BITS 4
+#define LB_TYPE_MASK ((1 << LB_TYPE_BITS) - 1)
 
-class CLabel : public CKey
+// Currently, there is only one type of label. This consists of a string
+// and a type (the side bit and the bits added by flipping).
+// The string is stored as its ID in the intern table (see Intern.h),
+// packed together with the type into a single integer. A label is a
+// plain value holding this integer: it is not allocated or reference
+// counted and is copied, hashed and compared as an integer. The tables
+// which store labels (see Strength.h) are keyed by this integer. The
+// packed value 0 (the 'null' label) is not a label (it stands for 'no
+// label'), as no string has the ID 0.
+
+class CLabel
 {
 private:
-    unsigned int m_Type;
-    CpCStrKey m_StrKey;
-public:
-    // default is other side empty adjacency label
-    CLabel() : m_StrKey(new CStrKey("")), m_Type(LB_OTHER_SIDE) {
-#ifdef DETAILED_DEBUG
-        IncObjCount();
-#endif
+    // (<string ID> << LB_TYPE_BITS) | <type>
+    unsigned int m_Packed;
+
+    static unsigned int Pack(unsigned int Type, unsigned int Id) {
+        return (Id << LB_TYPE_BITS) | (Type & LB_TYPE_MASK);
     }
+public:
+    // the null label
+    CLabel() : m_Packed(0) {}
+    // the label with the given packed value (see GetPacked())
+    explicit CLabel(unsigned int Packed) : m_Packed(Packed) {}
     CLabel(unsigned int Type, std::string const& s) :
-            m_StrKey(new CStrKey(s)), m_Type(Type) {
-#ifdef DETAILED_DEBUG
-        IncObjCount();
-#endif
-    }
+            m_Packed(Pack(Type, CInternTable::Intern(s))) {}
     CLabel(unsigned int Type, char const* s) :
-            m_StrKey(new CStrKey(s)), m_Type(Type) {
-#ifdef DETAILED_DEBUG
-        IncObjCount();
-#endif
-    }
+            m_Packed(Pack(Type, CInternTable::Intern(s ? s : ""))) {}
     CLabel(unsigned int Type, CStrKey* pKey) :
-            m_StrKey(pKey), m_Type(Type) {
-#ifdef DETAILED_DEBUG
-        IncObjCount();
-#endif
-    }
-    CLabel(unsigned int Type, CLabel& Key) :
-            m_StrKey(Key.m_StrKey), m_Type(Type) {
-#ifdef DETAILED_DEBUG
-        IncObjCount();
-#endif
-    }
-    // creates an adjacency label based on a label (flips the side bit)
-    CLabel(CLabel& Key) :
-            m_StrKey(Key.m_StrKey), m_Type(Key.m_Type ^ 1) {
-#ifdef DETAILED_DEBUG
-        IncObjCount();
-#endif
-    }
+            m_Packed(Pack(Type, pKey ? CInternTable::Intern(pKey) :
+                          CInternTable::Intern(""))) {}
+    // label with the string of the given label and the given type
+    CLabel(unsigned int Type, CLabel Label) :
+            m_Packed(Pack(Type, Label.GetId())) {}
 
-    ~CLabel() {
-#ifdef DETAILED_DEBUG
-        DecObjCount();
-#endif
-    }
-    
-    unsigned int HashFunc() {
-        return (m_Type ^ m_StrKey->HashFunc());
-    }
-    bool HashEqual(CKey* pKey) {
-        return pKey && (typeid(*pKey) == typeid(*this)) &&
-            (m_Type == ((CLabel*)pKey)->m_Type) &&
-            (m_StrKey == ((CLabel*)pKey)->m_StrKey ||
-             m_StrKey->HashEqual(((CLabel*)pKey)->m_StrKey));
-    }
-    
-    operator CpCStrKey const&() { return m_StrKey; }
-    operator char const*() { return m_StrKey->GetStr(); }
-    operator std::string const&() { return (std::string const&)(*m_StrKey); }
-    operator unsigned int() { return m_Type; }
-    bool operator==(CLabel& Label) {
-        return (m_Type == Label.m_Type) &&
-            ((m_StrKey == Label.m_StrKey) ||
-             (m_StrKey && Label.m_StrKey && (*m_StrKey == *(Label.m_StrKey))));
-    }
+    // creates an adjacency label based on this label (flips the side bit)
+    CLabel Flipped() const { return CLabel(m_Packed ^ 1); }
+
+    // is this the null label?
+    bool IsNull() const { return !m_Packed; }
+    // the packed label (string ID and type), which is unique for each label
+    unsigned int GetPacked() const { return m_Packed; }
+    // ID of the label string in the intern table
+    unsigned int GetId() const { return m_Packed >> LB_TYPE_BITS; }
+    // the type of the label
+    unsigned int GetType() const { return m_Packed & LB_TYPE_MASK; }
+    // the (interned) key of the label string
+    CStrKey* GetStrKey() const { return CInternTable::GetKey(GetId()); }
+    // the label string
+    char const* GetStr() const { return GetStrKey()->GetStr(); }
+    bool operator==(CLabel Label) const { return m_Packed == Label.m_Packed; }
+    bool operator!=(CLabel Label) const { return m_Packed != Label.m_Packed; }
 
     // Prints the label into the given output string
-    void LabelString(std::string& Output);
+    void LabelString(std::string& Output) const;
 };
 
-typedef CPtr<CLabel> CpCLabel;
-
 #endif /* __LABEL_H__ */
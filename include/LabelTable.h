@@ -20,25 +20,28 @@
 #include "RefSTL.h"
 #include "Strength.h"
 #include "Label.h"
+#include "PrsConst.h"
 
 /////////////////
 // Label Table //
 /////////////////
 
 //
-// value class for the label table
+// value class for the label table (the strengths of a label on each side
+// are stored inline in the value object)
 //
 
-class CLabelVal : public CRvector<float>
+class CLabelVal : public CRPropVec<SIDE_NUM>, public CPoolObj,
+                  public CCountedObj<CLabelVal, eOSLabelVal>
 {
 public:
-    CLabelVal() : CRvector<float>() {
+    CLabelVal() : CRPropVec<SIDE_NUM>() {
 #ifdef DETAILED_DEBUG
         IncObjCount();
 #endif
     }
 
-    CLabelVal(unsigned int Size) : CRvector<float>(Size) {
+    CLabelVal(unsigned int Size) : CRPropVec<SIDE_NUM>(Size) {
 #ifdef DETAILED_DEBUG
         IncObjCount();
 #endif
@@ -81,14 +84,22 @@ public:
     // label already exists in the table, the maximum of the given strength
     // and the strength stored in the table becomes the new strength of the
     // label. Returns the value object of the label.
-    CLabelVal* AddLabel(CLabel* pLabel, unsigned int Prop, float Strg);
-    // Same as above, only with the label value already given.
+    CLabelVal* AddLabel(CLabel Label, unsigned int Prop, float Strg);
+    // Same as above, only with the label value already given. As the label
+    // itself is not given, if the value is added to a top list in which it
+    // did not yet appear, it is added there without its label (so a top
+    // list iterator returns the null label for it). This has always been the
+    // behavior of this function and is kept so that learning results do
+    // not change.
     CLabelVal* AddLabel(CLabelVal* pVal, unsigned int Prop, float Strg);
+    // Same as above, but with the label (as stored in the table) also given.
+    CLabelVal* AddLabel(CLabel Key, CLabelVal* pVal, unsigned int Prop,
+                        float Strg);
     // Flips the given label and then adds the flipped label as in the
     // routines above.
     // If 'bOp' is set then the label is an opposite side label. Flipping
     // such a label consists of recording this fact on the label type.
-    CLabelVal* FlipAndAddLabel(CLabel* pLabel, unsigned int Prop,
+    CLabelVal* FlipAndAddLabel(CLabel Label, unsigned int Prop,
                                bool bOp, float Strg);
     
     // Copy the labels for the given property of pLabels to this label table
@@ -97,7 +108,7 @@ public:
     // strength is greater than that already in the table)
     void CopyLabels(CLabelTable* pLabels, unsigned int Prop);
     // returns the strength of the given label.
-    float Strg(CLabel* pLabel, unsigned int Prop);
+    float Strg(CLabel Label, unsigned int Prop);
 };
 
 typedef CPtr<CLabelTable> CpCLabelTable;
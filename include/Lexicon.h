@@ -35,6 +35,10 @@ public:
     CLexicon() {}
     // lexicon printing routine
     virtual bool PrintLexicon(CRefOStream* pOut) = 0;
+    // print statistics of the entries evicted from the lexicon since the
+    // last call (if any), each line preceded by 'Prefix'
+    virtual void PrintPruneStats(std::ostream& Out,
+                                 std::string const& Prefix) {}
 };
 
 //
@@ -46,6 +50,10 @@ class CLexEntry : public CRef, public CPrintObj
 public:
     // Returns the count of this entry. If this is not defined, returns -1. 
     virtual int Count() = 0;
+    // Prepares this entry to be read by several threads (see
+    // CStrLexicon::FreezeEntries()). By default, the entry is made
+    // immortal. Derived classes should also freeze the objects it holds.
+    virtual void Freeze() { MakeImmortal(); }
 };
 
 typedef CPtr<CLexEntry> CpCLexEntry;
@@ -58,12 +66,15 @@ typedef CPtr<CLexEntry> CpCLexEntry;
 //
 
 // type definitions for hash table
-typedef CHash<CStrKey, CLexEntry> CLexHash;
-typedef CHashIter<CStrKey, CLexEntry> CLexIter;
+typedef COpenHashTable<CStrKey, CLexEntry> CLexHashBase;
+typedef CHash<CStrKey, CLexEntry, CLexHashBase> CLexHash;
+typedef CHashIter<CStrKey, CLexEntry, CLexHashBase> CLexIter;
 typedef CPtr<CLexIter> CpCLexIter;
+typedef CHashPos<CStrKey, CLexEntry, CLexHashBase> CLexPos;
 
-// type definitions for sorting
-typedef std::pair<CpCStrKey, CpCLexEntry> LexPair; // key/value pairs
+// type definitions for sorting. The key/value pairs are not reference
+// counted, as they are only used while the lexicon holds the entries.
+typedef std::pair<CStrKey*, CLexEntry*> LexPair; // key/value pairs
 typedef bool(*tLexComp)(LexPair const&, LexPair const&);
 
 class CStrLexicon : public CLexicon, public CLexHash 
@@ -75,14 +86,39 @@ public:
     // found, an empty entry is created. This ensures that only one copy
     // of the key is created.
     CStrKey* GetKeyByString(std::string const& Name);
+    // Make all keys currently in the lexicon immortal (see Reference.h)
+    // and freeze all its entries (see CLexEntry::Freeze()). This should
+    // be called once the lexicon is not modified anymore and is about to
+    // be read by several threads. These objects are then never deleted.
+    void FreezeEntries();
 protected:
     // For use by derived classes only
+
+    // Same as GetKeyByString(), but also returns the entry in 'pEntry'.
     CStrKey* GetEntryByString(std::string const& Name, CpCLexEntry& pEntry);
+    // Same as above, but does not create an entry if none is found (in
+    // which case NULL is returned and 'pEntry' is set to NULL). This does
+    // not modify the lexicon, so it may be called concurrently by several
+    // readers.
+    CStrKey* FindEntryByString(std::string const& Name, CpCLexEntry& pEntry);
+    // Same as FindEntryByString() for the lower case version of the given
+    // string (as converted by ToLower()), but without copying the string
+    // or creating a key. The key and entry returned are owned by the
+    // lexicon (no references are added) so this does not allocate
+    // anything.
+    CStrKey* FindEntryByLowerString(std::string const& Name,
+                                    CLexEntry*& pEntry);
+
     // Sorted printing of the lexicon. Which entries are printed and in
     // which order is determined by the derived class.
     bool PrintLexicon(CRefOStream* pOut);
     
 private:
+
+    // Returns the position of the entry matching the given string,
+    // creating a new entry if none exists (returns an empty position for
+    // an empty string).
+    CLexPos FindOrCreate(std::string const& Name);
     
     //
     // Functions which need to be implemented by the derived classes
@@ -96,6 +132,11 @@ private:
     
     // returns a new (empty) lexical entry
     virtual CLexEntry* NewEmptyLexEntry() = 0;
+    // returns the entry to be added to the lexicon for a string which is
+    // not yet in the lexicon. By default, this is an empty entry.
+    virtual CLexEntry* NewLexEntry(std::string const& Name) {
+        return NewEmptyLexEntry();
+    }
 };
 
 #endif /* __LEXICON_H__ */
@@ -25,6 +25,41 @@
 #include "MessageLine.h"
 #include "OutFile.h"
 
+class CLoop;
+
+//
+// Loop position (for checkpointing)
+//
+
+// The position of a loop in its input at the end of an object. A loop
+// can be resumed from such a position (see CLoop::SetResumePos()).
+
+struct SLoopPos {
+    unsigned int m_ObjNum;        // number of the next object to be read
+    unsigned int m_LineNum;       // number of lines read so far
+    unsigned int m_ObjsProcessed; // number of objects processed so far
+    // position in the input files (see CMultiInFile::GetPos())
+    unsigned int m_FileNum;
+    unsigned long long m_Offset;
+
+    SLoopPos() : m_ObjNum(1), m_LineNum(0), m_ObjsProcessed(0),
+                 m_FileNum(0), m_Offset(0) {}
+};
+
+// Interface of an object to be notified by the loop at the end of every
+// object (see CLoop::SetCheckpointer()).
+
+class CLoopCheckpointer
+{
+public:
+    virtual ~CLoopCheckpointer() {}
+    // Called after every object fully read and processed by the loop (but
+    // not while only counting objects), with the position of the loop
+    // after that object. Returning false terminates the loop with an
+    // error (the checkpointer should report the reason itself).
+    virtual bool ObjectDone(CLoop* pLoop, SLoopPos const& Pos) = 0;
+};
+
 // This base class reads a multi-file line by line.
 // For every line read, it calls a function which must be implemented by
 // derived classes and which allows the derived class to process the data.
@@ -45,6 +80,7 @@ private:
     // Counters and counting
     
     unsigned int m_ObjNum; // number of object currently being processed
+    unsigned int m_LineNum; // number of lines read
     // When this flag is set, the derived class should only parse the
     // input to determine the number of objects and should not process
     // it any further.
@@ -52,6 +88,15 @@ private:
     
     // number of objects processed (this is updated by the processing class)
     unsigned int m_ObjsProcessed;
+
+    // Checkpointing
+
+    // object notified at the end of every object (NULL if none)
+    CLoopCheckpointer* m_pCheckpointer;
+    // position at which the next run of the loop should begin (if
+    // m_bResume is set)
+    bool m_bResume;
+    SLoopPos m_ResumePos;
 public:
     CLoop(std::vector<std::string> const & InFilePatterns, CCmdArgOpts* pArgs,
           CpCMessageLine& MsgLine, COutFile* pOutFile);
@@ -69,6 +114,26 @@ public:
     // Called to indicate that the end of the input has been reached.
     virtual bool EndLoop() = 0;
 
+    // Checkpointing
+
+    // Set the object to be notified at the end of every object (NULL for
+    // none). The loop does not hold a reference to this object.
+    void SetCheckpointer(CLoopCheckpointer* pCheckpointer) {
+        m_pCheckpointer = pCheckpointer;
+    }
+    // The next run of the loop (after ResetLoop()) begins at the given
+    // position (as previously passed to CLoopCheckpointer::ObjectDone()
+    // or returned by GetPos() for the same input) instead of at the
+    // beginning of the input.
+    void SetResumePos(SLoopPos const& Pos) {
+        m_ResumePos = Pos;
+        m_bResume = true;
+    }
+    // Returns the current position of the loop. After the loop terminated
+    // (without error) this is the position at the end of the input.
+    // Returns false if the position could not be determined.
+    bool GetPos(SLoopPos& Pos);
+    
     // Access to command line arguments
 
     CCmdArgOpts* GetArgs() { return m_Args; }
@@ -30,7 +30,7 @@
 #include "Parser.h"
 #include "EvaluatorTable.h"
 
-class CMain : public CRef
+class CMain : public CRef, public CLoopCheckpointer
 {
 protected:
     CpCCmdArgs m_pArgs;
@@ -44,6 +44,15 @@ protected:
     // Table accessing the correct evaluator
     CEvaluatorTable m_EvaluatorTable;
     CpCLoop m_pLoop; // current execution loop
+
+    // Checkpointing
+    
+    // current step (its number in the execution sequence and its entry)
+    unsigned int m_StepNum;
+    CpCLoopEntry m_pStepEntry;
+    // object number and time of the last checkpoint of the current step
+    unsigned int m_CheckpointObj;
+    time_t m_CheckpointTime;
     
     // error messages
     bool m_Error;
@@ -74,6 +83,29 @@ private:
     // the loop.
     void PostLoopActions(CLoopEntry* pEntry, time_t& StartTime,
                          time_t& EndTime);
+
+    //
+    // Checkpointing
+    //
+    
+    // Called by the loop at the end of every object. Writes a checkpoint
+    // of the current step if one is due.
+    bool ObjectDone(CLoop* pLoop, SLoopPos const& Pos);
+    // Writes a checkpoint of the current step with the given loop position
+    // (atomically replacing the previous checkpoint). Returns false on
+    // error.
+    bool WriteCheckpoint(SLoopPos const& Pos);
+    // Reads the checkpoint written by the given step from the given file
+    // and returns the loop position stored in it. If bLoadState is set,
+    // the parser state is also loaded from the checkpoint. Returns false
+    // on error.
+    bool ReadCheckpoint(std::string const& FileName, unsigned int StepNum,
+                        CLoopEntry* pEntry, SLoopPos& Pos, bool bLoadState);
+    // Finds the last step in the execution sequence whose checkpoint file
+    // exists. Returns its number in 'StepNum' and the loop position of
+    // the checkpoint in 'Pos' ('bFound' is false if there is no such
+    // step). Returns false on error.
+    bool FindResumeStep(unsigned int& StepNum, SLoopPos& Pos, bool& bFound);
 public:
     // error messages
     bool IsError() { return m_Error; }
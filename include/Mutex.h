@@ -0,0 +1,60 @@
+#ifndef __MUTEX_H__
+#define __MUTEX_H__
+
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+//
+// Locking for multi-threaded builds
+//
+
+// Objects may only be shared between threads in builds compiled with
+// -DATOMIC_REF_COUNT (see Reference.h). In such builds, the global
+// tables which are used by all threads (such as the intern table, see
+// Intern.h) are protected by a CMutex, which is locked by constructing a
+// CMutexLock on it (and unlocked when the lock is destroyed), and
+// global state which each thread may keep for itself (such as the free
+// lists of the pool allocator, see Pool.h) is declared THREAD_LOCAL.
+//
+// In all other builds, CMutex and CMutexLock are empty and THREAD_LOCAL
+// is empty, so they cost nothing.
+
+#ifdef ATOMIC_REF_COUNT
+
+#include <mutex>
+
+typedef std::mutex CMutex;
+typedef std::lock_guard<std::mutex> CMutexLock;
+
+#define THREAD_LOCAL thread_local
+
+#else
+
+class CMutex
+{
+};
+
+class CMutexLock
+{
+public:
+    CMutexLock(CMutex&) {}
+};
+
+#define THREAD_LOCAL
+
+#endif
+
+#endif /* __MUTEX_H__ */
@@ -0,0 +1,126 @@
+#ifndef __OBJSTATS_H__
+#define __OBJSTATS_H__
+
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+//
+// Live object and memory accounting
+//
+
+// The objects which make up most of the memory used by the parser
+// (lexicon entries, statistics, labels, hash tables, etc.) are counted
+// by type. For each type, the number of live objects and the number of
+// bytes they use are maintained, together with their peak values.
+// Unlike the object table of DETAILED_DEBUG (see Reference.h), the
+// types are fixed in advance, so that updating the counts only requires
+// incrementing two counters. The counts are therefore always maintained
+// (unless the program is compiled with -DNO_OBJ_STATS).
+//
+// A class is counted by inheriting from CCountedObj<T, Type>, where T is
+// the class itself and Type is one of the types below. The number of
+// bytes counted for each object is sizeof(T). Memory allocated by the
+// object itself (e.g. the buffer of a vector or of a long string) is not
+// included. Variable size structures (hash table slot arrays) call
+// CObjStats::Add() and CObjStats::Remove() directly.
+//
+// As for the pool allocator (see Pool.h), in multi-threaded builds each
+// thread keeps its own counts (which then only describe the objects
+// created and destroyed by that thread). In other builds, the counts are
+// not thread safe.
+
+#include <cstddef>
+#include <string>
+#include <ostream>
+#include "Mutex.h"
+
+// types of objects counted
+enum EObjStatType {
+    eOSStrKey = 0,    // string keys
+    eOSHashEnt,       // entries of the chaining hash tables
+    eOSHashSlots,     // slot arrays of the hash tables
+    eOSIdHashSlots,   // slot arrays of the integer keyed hash tables
+                      // (statistics and label tables, see IdHash.h)
+    eOSLexEntry,      // lexicon entries
+    eOSCCLStat,       // statistics of a lexicon entry (one per adjacency)
+    eOSCCLVal,        // statistics values
+    eOSTopEntry,      // entries of the top strength lists
+    eOSStatCopy,      // copies of the statistics used in parsing
+    eOSLabelTable,    // label tables of units
+    eOSLabelVal,      // label values
+    eOSLink,          // links
+    eOSUnit,          // units
+    eOSStrArena,      // chunks of the string arena (see StrArena.h)
+    eOSTypeNum        // number of types (must be last)
+};
+
+class CObjStats
+{
+private:
+    // counts for a single type
+    struct SObjCount {
+        unsigned long m_Live;     // number of live objects
+        unsigned long m_PeakLive; // maximal number of live objects
+        unsigned long m_Total;    // total number of objects created
+        size_t m_Bytes;           // bytes used by live objects
+        size_t m_PeakBytes;       // maximal number of bytes used
+    };
+
+    static THREAD_LOCAL SObjCount m_Counts[eOSTypeNum];
+    static char const* m_Names[eOSTypeNum];
+public:
+    // An object of the given type using 'Bytes' bytes was created
+    static void Add(unsigned int Type, size_t Bytes) {
+#ifndef NO_OBJ_STATS
+        SObjCount& Count = m_Counts[Type];
+        if(++Count.m_Live > Count.m_PeakLive)
+            Count.m_PeakLive = Count.m_Live;
+        Count.m_Total++;
+        if((Count.m_Bytes += Bytes) > Count.m_PeakBytes)
+            Count.m_PeakBytes = Count.m_Bytes;
+#endif
+    }
+    // An object of the given type using 'Bytes' bytes was destroyed
+    static void Remove(unsigned int Type, size_t Bytes) {
+#ifndef NO_OBJ_STATS
+        m_Counts[Type].m_Live--;
+        m_Counts[Type].m_Bytes -= Bytes;
+#endif
+    }
+    // Number of bytes used by the live objects of the given type
+    static size_t Bytes(unsigned int Type) { return m_Counts[Type].m_Bytes; }
+    // Total number of bytes used by all live counted objects
+    static size_t TotalBytes();
+
+    // Print the counts (each line is preceded by 'Prefix')
+    static void Print(std::ostream& Out, std::string const& Prefix);
+};
+
+//
+// Base class for counted objects
+//
+
+template <class T, unsigned int Type>
+class CCountedObj
+{
+protected:
+    CCountedObj() { CObjStats::Add(Type, sizeof(T)); }
+    // a copy is a new object
+    CCountedObj(CCountedObj const&) { CObjStats::Add(Type, sizeof(T)); }
+    ~CCountedObj() { CObjStats::Remove(Type, sizeof(T)); }
+};
+
+#endif /* __OBJSTATS_H__ */
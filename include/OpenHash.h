@@ -0,0 +1,796 @@
+#ifndef __OPENHASH_H__
+#define __OPENHASH_H__
+
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+//
+// Open addressing hash table
+//
+
+// This is an alternative implementation of the base hash table, with
+// the same interface as CHashBase (see Hash.h). Instead of a chain of
+// separately allocated entries for each slot, all entries are stored
+// directly in a single array of slots and collisions are resolved by
+// linear probing. Each slot also stores the full hash value of its key,
+// so that most non-matching slots can be skipped without calling the
+// key's comparison function (and without touching the key object).
+//
+// Entries are removed by backward shifting the entries which follow them
+// in the probe sequence, so no deletion markers are needed.
+//
+// When the table becomes too full, it is resized. By default, all entries
+// are moved to the new (larger) slot array at once. In incremental resize
+// mode (see SetIncrementalResize()) the old slot array is kept and its
+// entries are moved to the new array a few slots at a time, with every
+// insertion. Until all entries have been moved, lookups search both
+// arrays. This spreads the cost of resizing a large table over many
+// insertions instead of stalling a single insertion. Entries moved out of
+// (or deleted from) the old array are replaced there by a deletion mark,
+// as the old array is never compacted.
+//
+// The table is implemented by the COpenHashTable<K,V> template, which
+// stores keys of type K and values of type V. The hash and comparison
+// functions of the keys are called through CHashKeyTraits<K> (see
+// HashKey.h). COpenHashBase is the generic instance of this template,
+// which stores any CKey and CRef and calls the (virtual) functions of
+// CKey. Any other instance is a typed table: the key functions are
+// called directly (so they can be inlined) and keys and values are
+// stored with their own type (so no casting is needed).
+//
+// To select this implementation for a specific hash table, give
+// COpenHashBase or COpenHashTable<K,V> as the third argument of the
+// CHash<> (and CHashIter<>, CHashPos<>) template.
+
+#include "HashDef.h"
+#include "HashKey.h"
+#include "ObjStats.h"
+#include "Pool.h"
+#include "yError.h"
+
+#define OPEN_HASH_DEFAULT_SIZE (1 << 10)  // 1024
+// The maximal number of elements in the table, as a percentage of the number
+// of slots, before the table is resized.
+#define OPEN_HASH_MAX_LOAD 70
+// log_2 of the factor by which the size of the table is increased when
+// it is resized
+#define OPEN_HASH_RESIZE_FACTOR 1
+// In incremental resize mode, the number of slots of the old slot array
+// whose entries are moved to the new slot array on each insertion. This
+// must be large enough for all entries to be moved before the new array
+// needs to be resized.
+#define OPEN_HASH_MIGRATE_SLOTS 8
+
+// The address of this variable is used as the key pointer marking a slot
+// of the old slot array whose entry was moved to the current slot array
+// or deleted during an incremental resize. Such a slot must not end the
+// probe sequence of the old array.
+extern char g_OpenHashDeletedMark;
+
+//
+// Base lookup position class (template)
+//
+
+// Same as CHashPosBase (see Hash.h). The position refers directly to
+// the slot found, so it is only valid until the table is next modified.
+
+template <class K, class V, class T>
+class COpenHashTablePos
+{
+    friend class COpenHashTable<K,V,T>;
+    typedef typename COpenHashTable<K,V,T>::SSlot SSlot;
+private:
+    SSlot* m_pSlot; // slot found (NULL if none)
+protected:
+    COpenHashTablePos(SSlot* pSlot) : m_pSlot(pSlot) {}
+public:
+    COpenHashTablePos() : m_pSlot(NULL) {}
+    // indicates whether the lookup found an entry
+    bool Found() const { return m_pSlot != NULL; }
+    operator bool() const { return Found(); }
+    // key and value of the entry (NULL if none)
+    K* Key() const { return m_pSlot ? m_pSlot->m_pKey : NULL; }
+    V* Val() const { return m_pSlot ? m_pSlot->m_pVal : NULL; }
+};
+
+//
+// base open addressing hash table class (template)
+//
+
+template <class K, class V, class T>
+class COpenHashTable : public CRef, public CPoolObj {
+
+    friend class COpenHashTableIter<K,V,T>;
+    friend class COpenHashTablePos<K,V,T>;
+
+public:
+    // iterator and position classes to be used with this table
+    // (see CHashIter<> and CHashPos<>)
+    typedef COpenHashTableIter<K,V,T> CIterBase;
+    typedef COpenHashTablePos<K,V,T> CPosBase;
+
+private:
+
+    // Hash slot structure. The key and value are reference counted by
+    // the table itself (and not through CPtr<> objects) so that slots can
+    // be moved around the array without touching the reference counts.
+    struct SSlot {
+        K* m_pKey;           // key (NULL if slot is empty, see also
+                             // Deleted())
+        V* m_pVal;           // value
+        unsigned int m_Hash; // hash value of the key
+    };
+
+    unsigned int m_HashMask;  // size of the table minus 1
+    unsigned int m_HashShift; // shift converting a (mixed) hash value
+                              // into a slot number
+
+    SSlot* m_pSlots;
+
+    unsigned int m_NElements; // Number of elements in the hash (in both
+                              // slot arrays)
+    unsigned int m_MaxElements; // Number of elements triggering a resize
+
+    // Incremental resizing
+
+    bool m_bIncremental;    // resize incrementally ?
+    // Old slot array whose entries are still being moved to the current
+    // slot array (NULL if no resize is in progress).
+    SSlot* m_pOldSlots;
+    unsigned int m_OldMask;  // size of the old slot array minus 1
+    unsigned int m_OldShift; // hash shift for the old slot array
+    unsigned int m_NextToMove; // next old slot whose entry should be moved
+
+private:
+    SSlot* m_pLastLookup;    // slot of last lookup operation (NULL if none)
+    unsigned int m_LastHash; // hash value of the last key looked up
+    CPtr<K> m_pLastKey;      // last key used for lookup
+
+    // Construction, destruction, clearing
+protected:
+    COpenHashTable(unsigned int Size = OPEN_HASH_DEFAULT_SIZE);
+public:
+    virtual ~COpenHashTable(); // deletes the slot array
+    void Clear(); // clear all entries from the table
+
+    // Set incremental resize mode on or off (when switched off, any resize
+    // in progress is completed).
+    void SetIncrementalResize(bool bIncremental);
+    // Resize the table (if needed) so that it can hold the given number of
+    // elements without being resized again.
+    void Reserve(unsigned int NumElements);
+
+private:
+
+    // key pointer marking a deleted slot of the old slot array
+    static K* Deleted() { return (K*)(void*)&g_OpenHashDeletedMark; }
+    // Release a key or value stored on a slot (this is the same as what
+    // CPtr<> does when it releases its object).
+    template <class O> static void Release(O* pObj) {
+        if(pObj && (pObj->UnRef() <= 0))
+            delete pObj;
+    }
+
+    // allocate an empty slot array of the given size (a power of 2). Slot
+    // arrays are allocated through the pool allocator, so that the slot
+    // arrays of small tables are placed with their other objects.
+    void AllocSlots(unsigned int Size);
+    // free a slot array of the given size allocated by AllocSlots()
+    static void FreeSlots(SSlot* pSlots, unsigned int Size) {
+        CObjStats::Remove(eOSHashSlots, Size * sizeof(SSlot));
+        CPoolAlloc::Free(pSlots, Size * sizeof(SSlot));
+    }
+    // Resizes the table by a factor of 2 ^ Log2Fac. If bIncremental is
+    // false (or the table is empty) all entries are moved immediately to
+    // the new slot array. Otherwise, only a few entries are moved now.
+    // Any previous resize still in progress is first completed. Returns
+    // the new table size.
+    unsigned int Resize(unsigned int Log2Fac, bool bIncremental);
+    // Move the entries of the next 'SlotNum' slots of the old slot array
+    // to the current slot array. When all entries have been moved, the
+    // old array is deleted.
+    void MoveOldSlots(unsigned int SlotNum);
+    // To be called before inserting a new entry into the table. This
+    // resizes the table or continues moving the entries of an incremental
+    // resize. Since this may move the entry found by the last lookup, the
+    // last lookup is refreshed. Returns true if entries may have moved
+    // (so that slots found before the call are no longer valid).
+    bool PrepareInsert();
+    // Refresh the slot of the last lookup (after entries have been moved)
+    void RefreshLastLookup() {
+        if(m_pLastLookup)
+            m_pLastLookup = FindSlot(*m_pLastKey, m_LastHash);
+    }
+
+    // First slot in the probe sequence of the given hash value. The hash
+    // value is mixed (Fibonacci hashing) before being reduced to the table
+    // size, as the low bits of the key hash functions are often weak.
+    static unsigned int HomeSlot(unsigned int Hash, unsigned int Shift) {
+        return (unsigned int)(Hash * 2654435769U) >> Shift;
+    }
+    unsigned int HomeSlot(unsigned int Hash) {
+        return HomeSlot(Hash, m_HashShift);
+    }
+
+    // Is the slot in the old slot array ?
+    bool IsOldSlot(SSlot* pSlot) {
+        return m_pOldSlots && pSlot >= m_pOldSlots &&
+            pSlot <= m_pOldSlots + m_OldMask;
+    }
+
+    // Returns the slot holding the key or, if the key is not in the
+    // table, the empty slot (in the current slot array) at which it
+    // should be inserted.
+    SSlot* FindSlot(K& Key, unsigned int Hash);
+
+    // Lookup, insertion, deletion (internal and external versions)
+
+protected:
+    SSlot* Lookup(K& Key) {
+        m_LastHash = T::Hash(Key);
+        m_pLastLookup = FindSlot(Key, m_LastHash);
+        m_pLastKey = Key;
+        return m_pLastLookup;
+    }
+private:
+    int DeleteAt(SSlot* pSlot);
+protected:
+    int Delete(K& Key) {
+        int Count = DeleteAt(Lookup(Key));
+        // entries may have moved, so the slot of the last lookup must be
+        // recalculated
+        RefreshLastLookup();
+        return Count;
+    }
+    // delete last key looked up
+    int Delete() {
+        if(!m_pLastLookup)
+            return m_NElements;
+        int Count = DeleteAt(m_pLastLookup);
+        RefreshLastLookup();
+        return Count;
+    }
+private:
+    // Inserts an entry at the specified slot (which must have been
+    // returned by FindSlot() after the last call to PrepareInsert(), if
+    // empty). If the slot is not empty, the value it holds is overwritten.
+    int InsertAt(K& Key, unsigned int Hash, V* pVal, SSlot* pSlot);
+protected:
+    int Insert(K& Key, V* pVal) {
+        Lookup(Key);
+        // make room for a new entry (this refreshes the last lookup)
+        if(!m_pLastLookup->m_pKey)
+            PrepareInsert();
+        return InsertAt(Key, m_LastHash, pVal, m_pLastLookup);
+    }
+    int Insert(V* pVal);
+public:
+    // indicates whether the last lookup succeeded
+    bool Found() {
+        return m_pLastLookup && m_pLastLookup->m_pKey;
+    }
+    // Returns the value found by the last lookup (NULL if none)
+    V* Val() {
+        return m_pLastLookup ? m_pLastLookup->m_pVal : NULL;
+    }
+    // The following function performs a 'passive' lookup. This means that
+    // the lookup does not use or modify the table's last lookup cache.
+    V* Val(K& Key) { return FindSlot(Key, T::Hash(Key))->m_pVal; }
+protected:
+    // returns the key of the last lookup, if found (NULL if not found)
+    K* Key() {
+        return m_pLastLookup ? m_pLastLookup->m_pKey : NULL;
+    }
+
+    // Stateless lookup (see CHashBase)
+
+    // Returns the position of the entry with the given key (the position
+    // is empty if the key is not in the table). This does not modify
+    // the table.
+    CPosBase Find(K& Key) {
+        SSlot* pSlot = FindSlot(Key, T::Hash(Key));
+        return CPosBase(pSlot->m_pKey ? pSlot : NULL);
+    }
+    // Returns the position of the entry whose key matches the given
+    // matching object, where 'Hash' is the hash value of the keys it
+    // matches. This allows a lookup without constructing a key. The
+    // matching object should define bool operator()(K* pKey) which
+    // returns true for a matching key. This does not modify the table.
+    template <class M> CPosBase FindMatch(M& Match, unsigned int Hash);
+    // Returns the position of the entry with the given key. If the key is
+    // not in the table, a new entry is created for it, with a NULL value.
+    CPosBase FindOrInsert(K& Key);
+    // Sets the value of the entry at the given position (which must not be
+    // empty).
+    void SetVal(CPosBase const& Pos, V* pVal);
+public:
+    unsigned int NumElements() { return m_NElements; }
+    // number of slots in the table
+    unsigned int NumSlots() { return m_HashMask + 1; }
+    // is an incremental resize in progress ?
+    bool IsResizing() { return m_pOldSlots != NULL; }
+private:
+    // The iterator sees the slots of the current slot array followed by
+    // those of the old slot array (if any). These return the total number
+    // of slots and the slot at the given position in this sequence (NULL
+    // if there is no such slot).
+    unsigned int IterSlotNum() {
+        return m_HashMask + 1 + (m_pOldSlots ? m_OldMask + 1 : 0);
+    }
+    SSlot* IterSlot(unsigned int Pos) {
+        if(Pos <= m_HashMask)
+            return m_pSlots + Pos;
+        Pos -= m_HashMask + 1;
+        return (m_pOldSlots && Pos <= m_OldMask) ? m_pOldSlots + Pos : NULL;
+    }
+};
+
+//
+// Base iterator class (template)
+//
+
+template <class K, class V, class T>
+class COpenHashTableIter : public CRef {
+
+    typedef COpenHashTable<K,V,T> CTable;
+    typedef typename CTable::SSlot SSlot;
+
+private:
+    CPtr<CTable> m_pTable; // hash table from which the iterator was created
+    unsigned int m_Slot;   // Current slot number
+protected:
+    COpenHashTableIter(CTable* pTable) : m_pTable(pTable), m_Slot(0) {}
+    virtual ~COpenHashTableIter() {}
+private:
+    // advance to the first non-empty slot starting at the current slot
+    bool SkipEmpty() {
+        for(unsigned int SlotNum = m_pTable->IterSlotNum() ;
+            m_Slot < SlotNum ; m_Slot++) {
+            K* pKey = CurSlot()->m_pKey;
+            if(pKey && pKey != CTable::Deleted())
+                return true;
+        }
+        return false;
+    }
+    // current slot (must not be at the end)
+    SSlot* CurSlot() { return m_pTable->IterSlot(m_Slot); }
+public:
+    // reset to the beginning of the hash table. Returns false if the
+    // table is empty, true otherwise
+    bool First() {
+        if(m_pTable.IsNull())
+            return false;
+        m_Slot = 0;
+        return SkipEmpty();
+    }
+protected:
+    // reset to the beginning and return the key/value
+    K* FirstKey() { return First() ? CurSlot()->m_pKey : NULL; }
+    V* FirstVal() { return First() ? CurSlot()->m_pVal : NULL; }
+public:
+    // advances to next entry. Returns false if no such entry exists,
+    // true otherwise
+    bool Next() {
+        if(IsEnd())
+            return false;
+        m_Slot++;
+        return SkipEmpty();
+    }
+    bool operator++() { return Next(); } // the same
+protected:
+    // advances to the next entry and returns the key/value
+    K* NextKey() { return Next() ? CurSlot()->m_pKey : NULL; }
+    V* NextVal() { return Next() ? CurSlot()->m_pVal : NULL; }
+
+    // get current key/value (NULL if none)
+    K* GetKey() { return IsEnd() ? NULL : CurSlot()->m_pKey; }
+    V* GetVal() { return IsEnd() ? NULL : CurSlot()->m_pVal; }
+public:
+    // Has the iterator reached the end ?
+    bool IsEnd() { return (!m_pTable || (m_pTable->IterSlotNum() <= m_Slot)); }
+    operator bool() { return !IsEnd(); }
+};
+
+//
+// Generic open addressing hash table class
+//
+
+// Keys and values are stored as CKey and CRef objects (the CHash<>
+// template casts them to their specific types).
+
+class COpenHashBase : public COpenHashTable<CKey, CRef>
+{
+protected:
+    COpenHashBase(unsigned int Size = OPEN_HASH_DEFAULT_SIZE) :
+            COpenHashTable<CKey, CRef>(Size) {}
+};
+
+typedef CPtr<COpenHashBase> CpCOpenHash;
+
+//
+// Template member functions
+//
+
+template <class K, class V, class T>
+COpenHashTable<K,V,T>::COpenHashTable(unsigned int Size) :
+        m_pSlots(NULL), m_NElements(0), m_bIncremental(false),
+        m_pOldSlots(NULL), m_OldMask(0), m_OldShift(0), m_NextToMove(0),
+        m_pLastLookup(NULL), m_LastHash(0)
+{
+    unsigned int HashSize;
+
+    if(!Size)
+        Size = OPEN_HASH_DEFAULT_SIZE;
+
+    // round to the nearest (larger) power of 2 (at least 2 slots, so that
+    // there is always an empty slot in the table)
+    for(HashSize = 2 ; HashSize < Size ; HashSize = (HashSize << 1));
+
+    AllocSlots(HashSize);
+}
+
+template <class K, class V, class T>
+COpenHashTable<K,V,T>::~COpenHashTable()
+{
+    Clear();
+    FreeSlots(m_pSlots, m_HashMask + 1);
+}
+
+template <class K, class V, class T>
+void
+COpenHashTable<K,V,T>::AllocSlots(unsigned int Size)
+{
+    m_pSlots = (SSlot*)CPoolAlloc::Alloc(Size * sizeof(SSlot));
+    CObjStats::Add(eOSHashSlots, Size * sizeof(SSlot));
+
+    for(unsigned int i = 0 ; i < Size ; i++) {
+        m_pSlots[i].m_pKey = NULL;
+        m_pSlots[i].m_pVal = NULL;
+        m_pSlots[i].m_Hash = 0;
+    }
+
+    m_HashMask = Size - 1;
+
+    for(m_HashShift = 32 ; Size > 1 ; Size = (Size >> 1))
+        m_HashShift--;
+
+    m_MaxElements = (unsigned int)
+        (((unsigned long long)(m_HashMask + 1) * OPEN_HASH_MAX_LOAD) / 100);
+    if(m_MaxElements > m_HashMask)
+        m_MaxElements = m_HashMask;
+}
+
+template <class K, class V, class T>
+void
+COpenHashTable<K,V,T>::Clear()
+{
+    m_pLastLookup = NULL;
+    m_pLastKey = NULL;
+
+    if(m_pOldSlots) {
+        for(unsigned int Slot = 0 ; Slot <= m_OldMask ; Slot++) {
+            if(!m_pOldSlots[Slot].m_pKey ||
+               m_pOldSlots[Slot].m_pKey == Deleted())
+                continue;
+            Release(m_pOldSlots[Slot].m_pKey);
+            Release(m_pOldSlots[Slot].m_pVal);
+        }
+        FreeSlots(m_pOldSlots, m_OldMask + 1);
+        m_pOldSlots = NULL;
+    }
+
+    if(!m_NElements)
+        return; // nothing to clear
+
+    for(unsigned int Slot = 0 ; Slot <= m_HashMask ; Slot++) {
+        if(!m_pSlots[Slot].m_pKey)
+            continue;
+        Release(m_pSlots[Slot].m_pKey);
+        Release(m_pSlots[Slot].m_pVal);
+        m_pSlots[Slot].m_pKey = NULL;
+        m_pSlots[Slot].m_pVal = NULL;
+    }
+
+    m_NElements = 0;
+}
+
+template <class K, class V, class T>
+void
+COpenHashTable<K,V,T>::SetIncrementalResize(bool bIncremental)
+{
+    m_bIncremental = bIncremental;
+
+    if(!m_bIncremental && m_pOldSlots) {
+        MoveOldSlots(m_OldMask + 1);
+        RefreshLastLookup();
+    }
+}
+
+template <class K, class V, class T>
+void
+COpenHashTable<K,V,T>::Reserve(unsigned int NumElements)
+{
+    unsigned int Log2Fac = 0;
+    unsigned long long Size = m_HashMask + 1;
+
+    while((Size * OPEN_HASH_MAX_LOAD) / 100 < NumElements &&
+          Size < (1U << 31)) {
+        Size <<= 1;
+        Log2Fac++;
+    }
+
+    // no point in resizing incrementally, as this is typically called
+    // before the table is filled
+    Resize(Log2Fac, false);
+}
+
+template <class K, class V, class T>
+unsigned int
+COpenHashTable<K,V,T>::Resize(unsigned int Log2Fac, bool bIncremental)
+{
+    if(!Log2Fac)
+        return m_HashMask + 1; // nothing to do
+
+    // complete any previous resize
+    if(m_pOldSlots)
+        MoveOldSlots(m_OldMask + 1);
+
+    m_pOldSlots = m_pSlots;
+    m_OldMask = m_HashMask;
+    m_OldShift = m_HashShift;
+    m_NextToMove = 0;
+
+    AllocSlots((m_HashMask + 1) << Log2Fac);
+
+    MoveOldSlots((bIncremental && m_NElements) ?
+                 OPEN_HASH_MIGRATE_SLOTS : m_OldMask + 1);
+
+    // position of last lookup may have changed
+    RefreshLastLookup();
+
+    return m_HashMask+1;
+}
+
+template <class K, class V, class T>
+void
+COpenHashTable<K,V,T>::MoveOldSlots(unsigned int SlotNum)
+{
+    if(!m_pOldSlots)
+        return;
+
+    // the reference counts are not changed, as the objects simply move
+    // from one slot to another
+
+    for( ; SlotNum && m_NextToMove <= m_OldMask ; SlotNum--) {
+        SSlot& OldSlot = m_pOldSlots[m_NextToMove++];
+
+        if(!OldSlot.m_pKey || OldSlot.m_pKey == Deleted())
+            continue;
+        unsigned int NewSlot = HomeSlot(OldSlot.m_Hash);
+        while(m_pSlots[NewSlot].m_pKey)
+            NewSlot = (NewSlot + 1) & m_HashMask;
+        m_pSlots[NewSlot] = OldSlot;
+        OldSlot.m_pKey = Deleted();
+        OldSlot.m_pVal = NULL;
+    }
+
+    if(m_NextToMove > m_OldMask) {
+        // all entries moved
+        FreeSlots(m_pOldSlots, m_OldMask + 1);
+        m_pOldSlots = NULL;
+    }
+}
+
+template <class K, class V, class T>
+bool
+COpenHashTable<K,V,T>::PrepareInsert()
+{
+    // Check whether the table needs to be resized
+    if(m_NElements + 1 > m_MaxElements) {
+        Resize(OPEN_HASH_RESIZE_FACTOR, m_bIncremental);
+        return true;
+    }
+
+    if(!m_pOldSlots)
+        return false;
+
+    MoveOldSlots(OPEN_HASH_MIGRATE_SLOTS);
+    RefreshLastLookup();
+    return true;
+}
+
+template <class K, class V, class T>
+typename COpenHashTable<K,V,T>::SSlot*
+COpenHashTable<K,V,T>::FindSlot(K& Key, unsigned int Hash)
+{
+    unsigned int Slot;
+
+    for(Slot = HomeSlot(Hash) ; m_pSlots[Slot].m_pKey ;
+        Slot = (Slot + 1) & m_HashMask) {
+        if(m_pSlots[Slot].m_Hash == Hash &&
+           T::Equal(Key, m_pSlots[Slot].m_pKey))
+            return m_pSlots + Slot; // found matching entry
+    }
+
+    if(!m_pOldSlots)
+        return m_pSlots + Slot;
+
+    // An incremental resize is in progress, so the entry may still be in
+    // the old slot array.
+
+    for(unsigned int OldSlot = HomeSlot(Hash, m_OldShift) ;
+        m_pOldSlots[OldSlot].m_pKey ; OldSlot = (OldSlot + 1) & m_OldMask) {
+        if(m_pOldSlots[OldSlot].m_pKey != Deleted() &&
+           m_pOldSlots[OldSlot].m_Hash == Hash &&
+           T::Equal(Key, m_pOldSlots[OldSlot].m_pKey))
+            return m_pOldSlots + OldSlot; // found matching entry
+    }
+
+    return m_pSlots + Slot;
+}
+
+template <class K, class V, class T>
+template <class M>
+COpenHashTablePos<K,V,T>
+COpenHashTable<K,V,T>::FindMatch(M& Match, unsigned int Hash)
+{
+    for(unsigned int Slot = HomeSlot(Hash) ; m_pSlots[Slot].m_pKey ;
+        Slot = (Slot + 1) & m_HashMask) {
+        if(m_pSlots[Slot].m_Hash == Hash && Match(m_pSlots[Slot].m_pKey))
+            return CPosBase(m_pSlots + Slot);
+    }
+
+    if(m_pOldSlots) {
+        for(unsigned int OldSlot = HomeSlot(Hash, m_OldShift) ;
+            m_pOldSlots[OldSlot].m_pKey ;
+            OldSlot = (OldSlot + 1) & m_OldMask) {
+            if(m_pOldSlots[OldSlot].m_pKey != Deleted() &&
+               m_pOldSlots[OldSlot].m_Hash == Hash &&
+               Match(m_pOldSlots[OldSlot].m_pKey))
+                return CPosBase(m_pOldSlots + OldSlot);
+        }
+    }
+
+    return CPosBase(NULL);
+}
+
+template <class K, class V, class T>
+int
+COpenHashTable<K,V,T>::DeleteAt(SSlot* pSlot)
+{
+    if(!pSlot || !pSlot->m_pKey)
+        return m_NElements;
+
+    Release(pSlot->m_pKey);
+    Release(pSlot->m_pVal);
+
+    if(IsOldSlot(pSlot)) {
+        // the old slot array is never compacted
+        pSlot->m_pKey = Deleted();
+        pSlot->m_pVal = NULL;
+        return --m_NElements;
+    }
+
+    // Shift back any entries following the deleted entry in the probe
+    // sequence which would otherwise no longer be found. An entry may be
+    // moved into the free slot if its home slot is not (cyclically)
+    // between the free slot and its current slot.
+
+    unsigned int Free = pSlot - m_pSlots;
+
+    for(unsigned int Next = (Free + 1) & m_HashMask ; m_pSlots[Next].m_pKey ;
+        Next = (Next + 1) & m_HashMask) {
+        unsigned int Home = HomeSlot(m_pSlots[Next].m_Hash);
+        if(((Next - Home) & m_HashMask) < ((Next - Free) & m_HashMask))
+            continue; // home is between the free slot and this slot
+        m_pSlots[Free] = m_pSlots[Next];
+        Free = Next;
+    }
+
+    m_pSlots[Free].m_pKey = NULL;
+    m_pSlots[Free].m_pVal = NULL;
+
+    return --m_NElements;
+}
+
+template <class K, class V, class T>
+int
+COpenHashTable<K,V,T>::InsertAt(K& Key, unsigned int Hash, V* pVal,
+                                SSlot* pSlot)
+{
+    SSlot& Ent = *pSlot;
+
+    if(pVal)
+        pVal->Ref();
+
+    if(!Ent.m_pKey) {
+        Key.Ref();
+        Ent.m_pKey = &Key;
+        Ent.m_Hash = Hash;
+        m_NElements++;
+    } else if(Ent.m_pKey != &Key) {
+        // replace the key (as in the chaining table)
+        Key.Ref();
+        Release(Ent.m_pKey);
+        Ent.m_pKey = &Key;
+    }
+
+    Release(Ent.m_pVal);
+    Ent.m_pVal = pVal;
+
+    return m_NElements;
+}
+
+template <class K, class V, class T>
+int
+COpenHashTable<K,V,T>::Insert(V* pVal)
+{
+    static char Rname[] = "COpenHashTable::Insert(V* pVal)";
+
+    if(!m_pLastLookup) {
+        derror("insertion without key, but without previous lookup");
+        return m_NElements;  // doesn't do anything
+    }
+
+    if(!m_pLastLookup->m_pKey)
+        PrepareInsert();
+
+    return InsertAt(*m_pLastKey, m_LastHash, pVal, m_pLastLookup);
+}
+
+template <class K, class V, class T>
+typename COpenHashTable<K,V,T>::CPosBase
+COpenHashTable<K,V,T>::FindOrInsert(K& Key)
+{
+    unsigned int Hash = T::Hash(Key);
+    SSlot* pSlot = FindSlot(Key, Hash);
+
+    if(pSlot->m_pKey)
+        return CPosBase(pSlot);
+
+    // Make room before inserting, so that the slot returned does not move
+    if(PrepareInsert())
+        pSlot = FindSlot(Key, Hash);
+
+    Key.Ref();
+    pSlot->m_pKey = &Key;
+    pSlot->m_pVal = NULL;
+    pSlot->m_Hash = Hash;
+    m_NElements++;
+
+    // If the last lookup pointed at the slot where the entry was inserted,
+    // it needs to be refreshed.
+    if(m_pLastLookup == pSlot)
+        RefreshLastLookup();
+
+    return CPosBase(pSlot);
+}
+
+template <class K, class V, class T>
+void
+COpenHashTable<K,V,T>::SetVal(CPosBase const& Pos, V* pVal)
+{
+    if(!Pos.m_pSlot) {
+        yPError(ERR_MISSING, "setting value at an empty position");
+    }
+
+    if(pVal)
+        pVal->Ref();
+    Release(Pos.m_pSlot->m_pVal);
+    Pos.m_pSlot->m_pVal = pVal;
+}
+
+#endif /* __OPENHASH_H__ */
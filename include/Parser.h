@@ -133,6 +133,54 @@ public:
     // Get the current lexicon object (if exists) as currently stored in
     // the parser object.
     virtual CLexicon* GetLexicon() = 0;
+
+    // Save the lexicon to a binary snapshot file. Returns false (and sets
+    // 'Error') on failure or if snapshots are not supported by the parser.
+    virtual bool SaveLexicon(std::string const& FileName, std::string& Error) {
+        Error = "lexicon snapshots not supported by this parser";
+        return false;
+    }
+    // Replace the lexicon by the one stored in the given snapshot file.
+    // Returns false (and sets 'Error') on failure, in which case the
+    // current lexicon is not changed.
+    virtual bool LoadLexicon(std::string const& FileName, std::string& Error) {
+        Error = "lexicon snapshots not supported by this parser";
+        return false;
+    }
+    // Same as SaveLexicon(), but in a layout which can be memory mapped
+    virtual bool SaveMappedLexicon(std::string const& FileName,
+                                   std::string& Error) {
+        Error = "mapped lexicons not supported by this parser";
+        return false;
+    }
+    // Replace the lexicon by one backed by the given memory mapped file
+    // (written by SaveMappedLexicon()). Returns false (and sets 'Error')
+    // on failure, in which case the current lexicon is not changed.
+    virtual bool MapLexicon(std::string const& FileName, std::string& Error) {
+        Error = "mapped lexicons not supported by this parser";
+        return false;
+    }
+    // Compact the lexicon in memory (without changing its contents) so
+    // that it can be accessed faster. Returns false if the lexicon was
+    // not compacted (also if this is not supported by the parser).
+    virtual bool CompactLexicon() { return false; }
+    // Write the full learned state of the parser to the given stream (as
+    // part of a checkpoint). 'FileName' is only used in error messages.
+    // Returns false (and sets 'Error') on failure or if checkpoints are
+    // not supported.
+    virtual bool SaveCheckpoint(std::ostream& Out, std::string const& FileName,
+                                std::string& Error) {
+        Error = "checkpoints not supported by this parser";
+        return false;
+    }
+    // Replace the learned state of the parser by the one written by
+    // SaveCheckpoint() to the given stream. Returns false (and sets
+    // 'Error') on failure, in which case the state is not changed.
+    virtual bool LoadCheckpoint(std::istream& In, std::string const& FileName,
+                                std::string& Error) {
+        Error = "checkpoints not supported by this parser";
+        return false;
+    }
 };
 
 typedef CPtr<CParser> CpCParser;
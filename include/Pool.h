@@ -0,0 +1,188 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+//
+// Pool allocator for small objects
+//
+
+// Small objects (hash entries, labels, label values, links etc.) are
+// allocated and freed in very large numbers. Instead of allocating each
+// such object separately from the heap, the pool allocator allocates
+// large chunks of memory and divides them into objects of equal size.
+// There is a separate pool (free list) for each size class (object sizes
+// are rounded up to a multiple of POOL_GRAIN). Freed objects are returned
+// to the free list of their size class and are reused by the next
+// allocation of that size. Chunks are never returned to the heap.
+//
+// A class uses the pool allocator by inheriting from CPoolObj (which
+// defines the class's operator new and delete). Since the size of the
+// object is passed to operator delete, an object deleted through a pointer
+// to its base class is returned to the correct pool only if the base class
+// has a virtual destructor (as CRef has).
+//
+// Pooled objects may also be allocated in a region (see BeginRegion()):
+// all objects allocated while the region is open, whatever their size,
+// are placed one after the other (in the order of allocation) in large
+// region chunks, instead of being taken from the free lists. This is used
+// to place objects which are accessed together (such as the frequent
+// entries of the lexicon) close to each other in memory. Objects allocated
+// in a region are freed as any other object (to the free list of their
+// size class).
+//
+// In multi-threaded builds (compiled with -DATOMIC_REF_COUNT, see
+// Mutex.h) each thread has its own free lists, region and allocation
+// counts, so no locking is needed. An object freed by another thread than
+// the one which allocated it is returned to the free list of the thread
+// freeing it (chunks are never returned to the heap, so this is safe).
+// The free objects of a thread which exits are not used again.
+// The allocation counts then only describe the calling thread. In other
+// builds, the pool allocator is not thread safe. Compiling with
+// -DNO_POOL_ALLOC makes all objects be allocated directly on the heap
+// (useful with memory debugging tools). The allocation counts are still
+// maintained.
+
+#include <cstddef>
+#include <string>
+#include <ostream>
+#include "Mutex.h"
+
+// object sizes are rounded up to a multiple of this size (which must be
+// large enough for the alignment of any pooled object and to hold a
+// pointer)
+#define POOL_GRAIN 8
+// objects larger than this are allocated directly on the heap
+#define POOL_MAX_OBJ_SIZE 512
+// number of size classes
+#define POOL_SIZE_CLASSES (POOL_MAX_OBJ_SIZE / POOL_GRAIN)
+// size of the memory chunks allocated from the heap
+#define POOL_CHUNK_SIZE (1 << 16)
+// size of the memory chunks allocated for regions
+#define POOL_REGION_CHUNK_SIZE (1 << 20)
+
+class CPoolAlloc
+{
+private:
+    // An object on the free list
+    struct SFreeObj {
+        SFreeObj* m_pNext;
+    };
+    // Free list and allocation counts for each size class
+    struct SSizeClass {
+        SFreeObj* m_pFree;     // free list
+        unsigned long m_Allocs; // total number of allocations
+        unsigned long m_InUse;  // number of objects currently allocated
+        unsigned long m_Chunks; // number of chunks allocated for this class
+    };
+
+    static THREAD_LOCAL SSizeClass m_Classes[POOL_SIZE_CLASSES];
+    // Number of allocations (and objects currently allocated) which were
+    // not taken from the pools (objects too large for the pool)
+    static THREAD_LOCAL unsigned long m_HeapAllocs;
+    static THREAD_LOCAL unsigned long m_HeapInUse;
+
+    // Region allocation
+    static THREAD_LOCAL bool m_bInRegion; // is a region open?
+    // next free position in the region chunk
+    static THREAD_LOCAL char* m_pRegionNext;
+    static THREAD_LOCAL char* m_pRegionEnd; // end of the region chunk
+    // number of region chunks allocated
+    static THREAD_LOCAL unsigned long m_RegionChunks;
+
+    // Size class for an object of the given size (not larger than
+    // POOL_MAX_OBJ_SIZE).
+    static unsigned int SizeClass(size_t Size) {
+        return Size ? (Size - 1) / POOL_GRAIN : 0;
+    }
+    // Allocate a new chunk for the given size class and add its objects
+    // to the free list of that class.
+    static void AllocChunk(unsigned int Class);
+    // Allocate an object of the given size class from the current region
+    // chunk (allocating a new region chunk if needed).
+    static void* RegionAlloc(unsigned int Class);
+public:
+    static void* Alloc(size_t Size) {
+#ifndef NO_POOL_ALLOC
+        if(Size <= POOL_MAX_OBJ_SIZE) {
+            SSizeClass& Class = m_Classes[SizeClass(Size)];
+            Class.m_Allocs++;
+            Class.m_InUse++;
+            if(m_bInRegion)
+                return RegionAlloc(SizeClass(Size));
+            if(!Class.m_pFree)
+                AllocChunk(SizeClass(Size));
+            SFreeObj* pObj = Class.m_pFree;
+            Class.m_pFree = pObj->m_pNext;
+            return pObj;
+        }
+#endif
+        m_HeapAllocs++;
+        m_HeapInUse++;
+        return ::operator new(Size);
+    }
+
+    static void Free(void* p, size_t Size) {
+        if(!p)
+            return;
+#ifndef NO_POOL_ALLOC
+        if(Size <= POOL_MAX_OBJ_SIZE) {
+            SSizeClass& Class = m_Classes[SizeClass(Size)];
+            SFreeObj* pObj = (SFreeObj*)p;
+            pObj->m_pNext = Class.m_pFree;
+            Class.m_pFree = pObj;
+            Class.m_InUse--;
+            return;
+        }
+#endif
+        m_HeapInUse--;
+        ::operator delete(p);
+    }
+
+    // Open and close a region. While the region is open, all pooled
+    // objects are allocated consecutively from the region chunks. Regions
+    // may not be nested. The unused end of the last region chunk is used
+    // by the next region.
+    static void BeginRegion() { m_bInRegion = true; }
+    static void EndRegion() { m_bInRegion = false; }
+
+    // Total number of objects allocated through the allocator
+    static unsigned long TotalAllocs();
+    // Total number of heap allocations performed by the allocator
+    // (chunks, region chunks and objects too large for the pools).
+    static unsigned long TotalHeapAllocs();
+
+    // Print the allocation counts (each line is preceded by 'Prefix')
+    static void PrintStats(std::ostream& Out, std::string const& Prefix);
+};
+
+//
+// Base class for pool allocated objects
+//
+
+class CPoolObj
+{
+public:
+    static void* operator new(size_t Size) {
+        return CPoolAlloc::Alloc(Size);
+    }
+    static void operator delete(void* p, size_t Size) {
+        CPoolAlloc::Free(p, Size);
+    }
+};
+
+#endif /* __POOL_H__ */
@@ -50,6 +50,10 @@
 #define PMODE_EXTRA_EVAL       0x20
 // Configuration information
 #define PMODE_CONFIG           0x40
+// Allocation counts of the pool allocator
+#define PMODE_ALLOC_COUNT      0x80
+// Live object and memory counts by object type
+#define PMODE_MEM_COUNT        0x100
 
 // Call this to indicate that the printing mode should be reinitialized
 // (when the global variables are reset).
@@ -20,6 +20,7 @@
 #include "Reference.h"
 #include <ostream>
 #include <fstream>
+#include <sstream>
 
 // base class for all ostream objects with a reference count.
 
@@ -61,5 +62,27 @@ public:
 };
 
 typedef CPtr<CRefOFStream> CpCRefOFStream;
+
+// Output stream into a string buffer. This can be used to collect output
+// which is then written to another stream in large blocks (see
+// CStrLexicon::PrintLexicon()).
+
+class CRefOStrStream : public CRefOStream
+{
+private:
+    std::ostringstream m_Stream;
+public:
+    CRefOStrStream();
+    ~CRefOStrStream();
+private:
+    std::ostream& GetStream() { return (std::ostream&)m_Stream; }
+public:
+    // number of characters currently in the buffer
+    size_t Size() { return m_Stream.tellp(); }
+    // write the contents of the buffer to the given stream and clear it
+    void WriteTo(std::ostream& Out);
+};
+
+typedef CPtr<CRefOStrStream> CpCRefOStrStream;
     
 #endif /* __REFSTREAM_H__ */
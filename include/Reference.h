@@ -21,6 +21,17 @@
 #define NULL (0)
 #endif
 
+#if __cplusplus >= 201103L
+#include <utility>
+#endif
+
+#ifdef ATOMIC_REF_COUNT
+#if __cplusplus < 201103L
+#error "ATOMIC_REF_COUNT requires C++11 or later"
+#endif
+#include <atomic>
+#endif
+
 #ifdef DETAILED_DEBUG
 #include <string>
 #include <map>
@@ -34,10 +45,42 @@
 
 // The following class may be inherited by classes which require reference
 // counting.
+//
+// By default, the reference count is a plain integer, so an object
+// (and any pointer to it) may only be used by one thread. When compiled
+// with -DATOMIC_REF_COUNT (which requires C++11) the count is updated
+// atomically, so objects may be shared between threads. Incrementing
+// the count needs no ordering (a new reference can only be created from
+// an existing one). Decrementing it uses acquire-release ordering, so
+// that all uses of the object by other threads happen before it is
+// deleted. Such builds also make the other global state used by all
+// objects (the pool allocator, the object counts and the intern table)
+// safe to use from several threads (see Mutex.h).
+//
+// In builds compiled with -DATOMIC_REF_COUNT, an object may also be
+// made immortal. The reference count of an immortal object is not
+// updated anymore and the object is never deleted by a CPtr. This is
+// used for the objects of a lexicon which is shared (read only) by
+// several threads (see CCCLLexicon::Share()) and which lives until the
+// program exits. Pointers to such objects can then be copied without
+// writing to the object (and without contention on its cache line).
+// In other builds, MakeImmortal() does nothing (objects cannot be shared
+// between threads, so there is nothing to gain) and no object is ever
+// immortal, so that updating the count costs no additional test.
+
+#ifdef ATOMIC_REF_COUNT
+// The reference count given to immortal objects. The counts of
+// ordinary objects never reach this value.
+#define REF_IMMORTAL_COUNT (1 << 30)
+#endif
 
 class CRef {
 private:
+#ifdef ATOMIC_REF_COUNT
+    std::atomic<int> m_Count;
+#else
     int m_Count;
+#endif
 #ifdef DEBUG
 public:
     static int m_ObjCount;
@@ -51,14 +94,44 @@ public:
         m_ObjCount++;
 #endif        
     }
+    // A copy of an object is a new object, so it is not referenced by
+    // anything yet (and the reference count is not assigned).
+    CRef(CRef const&) : m_Count(0) {
+#ifdef DEBUG
+        m_ObjCount++;
+#endif        
+    }
+    CRef& operator=(CRef const&) { return *this; }
     virtual ~CRef() {
 #ifdef DEBUG
         m_ObjCount--;
 #endif
     }
-    int Ref() { m_Count++; return m_Count; }
-    int UnRef() { m_Count--; return m_Count; }
+#ifdef ATOMIC_REF_COUNT
+    int Ref() {
+        if(IsImmortal())
+            return REF_IMMORTAL_COUNT;
+        return m_Count.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    int UnRef() {
+        if(IsImmortal())
+            return REF_IMMORTAL_COUNT;
+        return m_Count.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    }
+    int RefCount() { return m_Count.load(std::memory_order_relaxed); }
+    // MakeImmortal() must be called before the object is shared between
+    // threads.
+    void MakeImmortal() {
+        m_Count.store(REF_IMMORTAL_COUNT, std::memory_order_relaxed);
+    }
+    bool IsImmortal() { return RefCount() >= REF_IMMORTAL_COUNT; }
+#else
+    int Ref() { return ++m_Count; }
+    int UnRef() { return --m_Count; }
     int RefCount() { return m_Count; }
+    void MakeImmortal() {}
+    bool IsImmortal() { return false; }
+#endif
 #ifdef DETAILED_DEBUG
     void IncObjCount() { m_ObjCountTable[typeid(*this).name()]++; }
     void DecObjCount() { m_ObjCountTable[typeid(*this).name()]--; }
@@ -70,6 +143,21 @@ public:
 };
 
 // The following template can be used to created a pointer to class T
+//
+// Copying a pointer increments the reference count of the object pointed
+// at (and destroying the copy decrements it again). Where a pointer is
+// only transferred (the source is not used anymore) the reference count
+// does not need to change. This is done by Swap() and, when compiled as
+// C++11 or later, by moving the pointer (the source pointer is then NULL).
+// Moving allows STL containers of pointers to be resized without
+// reference count updates. To move a pointer explicitly, use
+// MOVE_PTR(p) (which is a copy under older compilers).
+
+#if __cplusplus >= 201103L
+#define MOVE_PTR(p) std::move(p)
+#else
+#define MOVE_PTR(p) (p)
+#endif
 
 template <class T>
 class CPtr
@@ -83,6 +171,9 @@ public:
     CPtr(CPtr const& r) : m_Node(r.m_Node) {
         if (m_Node) m_Node->Ref();
     }
+#if __cplusplus >= 201103L
+    CPtr(CPtr&& r) noexcept : m_Node(r.m_Node) { r.m_Node = NULL; }
+#endif
     ~CPtr() { if (m_Node && (m_Node->UnRef() <= 0)) delete m_Node; }
 
     // Operators
@@ -101,6 +192,18 @@ public:
         return *this;
     }
 
+#if __cplusplus >= 201103L
+    CPtr& operator=(CPtr&& r) noexcept {
+        if(this != &r) {
+            T* pOld = m_Node;
+            m_Node = r.m_Node;
+            r.m_Node = NULL;
+            if(pOld && (pOld->UnRef() <= 0)) delete pOld;
+        }
+        return *this;
+    }
+#endif
+
     CPtr& operator=(T* p) {
         if(p) p->Ref();
         if(m_Node && (m_Node->UnRef() <= 0)) delete m_Node;
@@ -138,6 +241,15 @@ public:
         return *this;
     }
     
+    // Exchange the objects pointed at by the two pointers (without
+    // changing their reference counts)
+
+    void Swap(CPtr& r) {
+        T* pTemp = m_Node;
+        m_Node = r.m_Node;
+        r.m_Node = pTemp;
+    }
+    
     bool operator==(CPtr const & r) const { return m_Node == r.m_Node; }
     bool operator==(T* p) const { return m_Node == p; }
     // Generic comparison operator. A NULL pointer is always smaller
@@ -155,6 +267,15 @@ public:
     }
 };
   
+// Found by argument dependent lookup (e.g. by STL algorithms)
+
+template <class T>
+inline void
+swap(CPtr<T>& p1, CPtr<T>& p2)
+{
+    p1.Swap(p2);
+}
+
 typedef CPtr<CRef> CpCRef;
 
 #endif /* __REFERENCE_H__ */
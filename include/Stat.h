@@ -242,9 +242,9 @@ public:
 
     // Return the value of the given table statistic for the entry with
     // the given key divided by the given vector statistic.  
-    float QtTV(K* pKey, unsigned int TableProp, unsigned int VecProp) {
+    float QtTV(K Key, unsigned int TableProp, unsigned int VecProp) {
         float VecStat = (*this)[VecProp];
-        return VecStat ? CStatTable<K,V>::GetStrg(pKey, TableProp)/VecStat : 0;
+        return VecStat ? CStatTable<K,V>::GetStrg(Key, TableProp)/VecStat : 0;
     }
     // Return the value of the given table statistic for the entry with
     // the given value divided by the given vector statistic.  
@@ -252,12 +252,6 @@ public:
         float VecStat = (*this)[VecProp];
         return VecStat ? CStatTable<K,V>::GetStrg(pVal, TableProp)/VecStat : 0;
     }
-    // Return the value of the given table statistic for the cached entry
-    // divided by the given vector statistic.  
-    float QtTV(unsigned int TableProp, unsigned int VecProp) {
-        float VecStat = (*this)[VecProp];
-        return VecStat ? CStatTable<K,V>::GetStrg(TableProp)/VecStat : 0;
-    }
 
     // Return the quotient of the two given vector statistics
     float QtVV(unsigned int VecProp1, unsigned int VecProp2) {
@@ -272,27 +266,17 @@ public:
 
     // Return the quotient of the given table statistics for the entry with
     // the given key.
-    float QtTT(K* pKey, unsigned int TableProp1, unsigned int TableProp2) {
-        float TableStat2 = CStatTable<K,V>::GetStrg(pKey, TableProp2);
-        // entry is cached - no need to look it up again
-        return TableStat2 ?
-            CStatTable<K,V>::GetStrg(TableProp1)/TableStat2 : 0;
+    float QtTT(K Key, unsigned int TableProp1, unsigned int TableProp2) {
+        // look the entry up only once
+        return QtTT(this->GetVal(Key), TableProp1, TableProp2);
     }
     // Return the quotient of the given table statistics for the entry with
     // the given value.
     float QtTT(V* pVal, unsigned int TableProp1, unsigned int TableProp2) {
         float TableStat2 = CStatTable<K,V>::GetStrg(pVal, TableProp2);
-        // entry is cached, but it is quicker not to use the cache
         return TableStat2 ?
             CStatTable<K,V>::GetStrg(pVal, TableProp1)/TableStat2 : 0;
     }
-    // Return the quotient of the given table statistics for the cached
-    // entry.
-    float QtTT(unsigned int TableProp1, unsigned int TableProp2) {
-        float TableStat2 = CStatTable<K,V>::GetStrg(TableProp2);
-        return TableStat2 ?
-            CStatTable<K,V>::GetStrg(TableProp1)/TableStat2 : 0;
-    }
 };
 
 //
@@ -345,7 +329,7 @@ public:
     bool Restart() { return m_pIter ? m_pIter->Restart() : false; }
     // Strength for the property for which the iterator was created
     float Strg() { return m_pIter ? m_pIter->Strg() : 0; }
-    K* Data() { return m_pIter ? m_pIter->Data() : NULL; }
+    K Data() { return m_pIter ? m_pIter->Data() : K(0); }
     V* Val() { return m_pIter ? m_pIter->Val() : NULL; }
 
     // Returns true if there is no value at the current position or if this
@@ -396,7 +380,7 @@ public:
     // entry divided by the given vector statistic.  
     float QtTV(unsigned int TableProp, unsigned int VecProp) {
         float VecStat = m_pStat ? (*m_pStat)[VecProp] : 0;
-        return VecStat ? m_pStat->GetStrg(TableProp)/VecStat : 0;
+        return VecStat ? Strg(TableProp)/VecStat : 0;
     }
 
     // Return quotient of the given table statistics for the current iterator
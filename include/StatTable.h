@@ -37,22 +37,14 @@
 // so lists only need to be constructed for those properties which need
 // them.
 //
-// In addition, the statistics table offers a cache which allows fast access
-// to multiple properties of the same key.
+// The table does not cache the last entry accessed. To read several
+// properties of the same key, look the value up once (using GetVal() or
+// Find()) and then use the functions which take the value as argument.
+// Reading from the table never modifies it.
 
 template <class K, class V>
 class CStatTable : public CStrengths<K, V>
 {
-private:
-    //
-    // Cache
-    //
-    // Cache of the last accessed key and value - this allows quick access
-    // in succession to different properties of the same key.
-    // The cached key and value are updated every time an entry is looked-up
-    // either for retrieval or for update.
-    CPtr<K> m_pLastKey;
-    CPtr<V> m_pLastVal;
 public:
     CStatTable(unsigned int TopNum, unsigned int TopLength,
                unsigned int HashSize, bool bReserve = false) :
@@ -88,15 +80,6 @@ public:
         return GetTablePropConv().GetPropByLocalCode(Code);
     }
     
-private:
-    
-    // Clear the cache
-    void ClearCache() {
-        m_pLastKey = NULL;
-        m_pLastVal = NULL;
-    }
-
-public:
     
     //
     // Reading and updating element properties
@@ -115,27 +98,12 @@ public:
             return 0; // the property is not supported
         }
 
-        return CStrengths<K, V>::GetStrengthFromVec((CRvector<float>*)pVal,
-                                                    LocalCode);
-    }
-    // Same as above, only for the entry currently in the cache.
-    float GetStrg(unsigned int Prop) {
-        return GetStrg(m_pLastVal, Prop);
+        return CStrengths<K, V>::GetStrengthFromVec(pVal, LocalCode);
     }
     // Returns the strength of the given (absolute) property for the given
     // key.
-    float GetStrg(K* pKey, unsigned int Prop) {
-        if(!pKey) {
-            ClearCache();
-            return 0;
-        }
-        // Find the key in the table
-        m_pLastVal = GetVal(*pKey);
-        // The key stored in the table should be identical to pKey, but may
-        // be a different object. Here we read the object actually stored in
-        // the table.
-        m_pLastKey = CStrengths<K, V>::GetKey();
-        return GetStrg(Prop);
+    float GetStrg(K Key, unsigned int Prop) {
+        return GetStrg(this->GetVal(Key), Prop);
     }
 
     // Get the strength of the strongest entry for this property. Returns
@@ -167,31 +135,17 @@ public:
     }
     
     // Increment the strength of the given property for the given key
-    // by the given amount.
-    void IncStrg(K* pKey, unsigned int Prop, float Strg) {
-        if(!pKey)
-            return;
-        int Code = GetLocalCode(Prop);
-    
-        if(Code < 0) {
-            yPError(ERR_OUT_OF_RANGE, "property not supported by table");
-        }
-
-        m_pLastVal = this->IncStrength(*pKey, Code, Strg);
-        m_pLastKey = CStrengths<K, V>::GetKey();
-    }
-    // Same as above, but for the entry currently cached.
-    void IncStrg(unsigned int Prop, float Strg) {
-        if(!m_pLastKey || !m_pLastVal)
-            return;
-
+    // by the given amount. Returns the value of the entry (NULL if none).
+    V* IncStrg(K Key, unsigned int Prop, float Strg) {
+        if(!Key.GetPacked())
+            return NULL;
         int Code = GetLocalCode(Prop);
     
         if(Code < 0) {
             yPError(ERR_OUT_OF_RANGE, "property not supported by table");
         }
 
-        this->IncStrength(m_pLastVal, Code, Strg);
+        return this->IncStrength(Key, Code, Strg).Val();
     }
     
     // Get the number of entries in the top list
@@ -211,12 +165,7 @@ public:
         if(Code < 0)
             return false;
 
-        return IsInTheTopList((CRvector<float>*)pVal, Code);
-    }
-
-    // Same as above, only for the cached (last read) entry
-    bool IsInTopList(unsigned int Prop) {
-        return IsInTopList(m_pLastVal, Prop);
+        return IsInTheTopList(pVal, Code);
     }
     
     //
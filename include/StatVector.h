@@ -72,6 +72,22 @@ public:
     // operator for returning a reference to the entry at the given position
     // (if no such entry exists, an error is thrown)
     float& operator[](unsigned int AbsCode);
+
+    // Access by local code (the position in the vector), for copying the
+    // raw contents of the vector (e.g. when saving it to a file).
+    unsigned int LocalSize() { return m_Stats.size(); }
+    float LocalVal(unsigned int LocalCode) { return m_Stats[LocalCode]; }
+    // Returns the (absolute) property stored at the given position
+    int LocalCodeProp(unsigned int LocalCode) {
+        return GetVecPropConv().GetPropByLocalCode(LocalCode);
+    }
+
+    // Extends the vector to hold all properties of the conversion object,
+    // so that looking up these properties does not modify the vector.
+    void Extend() {
+        if(m_Stats.size() < GetVecPropConv().GetPropNum())
+            m_Stats.resize(GetVecPropConv().GetPropNum(), 0);
+    }
 };
 
 typedef CPtr<CStatVector> CpCStatVector;
@@ -106,6 +122,12 @@ public:
 
     // access to the values
     float operator[](unsigned int AbsCode);
+
+    // Same as CStatVector::Extend()
+    void Extend() {
+        if(m_Stats.size() < m_pVec->GetVecPropConv().GetPropNum())
+            m_Stats.resize(m_pVec->GetVecPropConv().GetPropNum(), 0);
+    }
 };
 
 #endif /* __STATVECTOR_H__ */
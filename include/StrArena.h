@@ -0,0 +1,64 @@
+#ifndef __STRARENA_H__
+#define __STRARENA_H__
+
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+//
+// String arena
+//
+
+// An append-only store of strings. Each string added is copied (with a
+// terminating NUL) into large chunks of memory, one after the other, and
+// is referred to by a pointer to its copy and its length. Strings cannot
+// be removed: the memory is only freed when the arena is destroyed. This
+// avoids the per-string allocation overhead (allocation header, rounding
+// and, for std::string, the unused space of the string object itself)
+// when many strings are stored for the whole run of the program, as the
+// strings of the intern table are (see Intern.h).
+
+#include <cstddef>
+#include <vector>
+#include <utility>
+
+// size of the memory chunks allocated by the arena (a longer string is
+// stored in a chunk of its own)
+#define STR_ARENA_CHUNK_SIZE (1 << 16)
+
+class CStrArena
+{
+private:
+    // all chunks allocated (and their sizes)
+    std::vector<std::pair<char*, size_t> > m_Chunks;
+    char* m_pNext; // next free position in the last chunk
+    char* m_pEnd;  // end of the last chunk
+    size_t m_StrBytes;   // bytes used by the strings (with terminators)
+    size_t m_ChunkBytes; // bytes allocated for the chunks
+public:
+    CStrArena();
+    ~CStrArena();
+
+    // Copies the given string (of length Len) into the arena and returns
+    // the (NUL terminated) copy.
+    char const* Add(char const* pStr, unsigned int Len);
+
+    // bytes used by the strings stored (including their terminators)
+    size_t StrBytes() { return m_StrBytes; }
+    // bytes allocated for the arena
+    size_t ChunkBytes() { return m_ChunkBytes; }
+};
+
+#endif /* __STRARENA_H__ */
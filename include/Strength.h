@@ -18,8 +18,10 @@
 // along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "Reference.h"
-#include "Hash.h"
+#include "IdHash.h"
 #include "RefSTL.h"
+#include "ObjStats.h"
+#include "yError.h"
 
 // this constant allow the creation of a strength table with an unbounded
 // number of properties.
@@ -29,30 +31,50 @@ class CTopBase;
 template <class K, class V> class CStrengths;
 template <class K, class V> class CTopIter;
 
-// A single entry in the top strength list
-
-class CTopEntry
+// Fixed size property vector
+//
+// The value type V of a strength table (see CStrengths below) is the
+// vector of the property strengths of an entry. This may be a
+// CRvector<float> or the following fixed size property vector, which can
+// hold at most N properties (where N is known when the table is
+// compiled). The properties are stored inline in the object, so no
+// separate allocation is needed for them. As a CRvector<float>, it has a
+// size (the number of properties assigned so far, initially zero), which
+// may be increased (up to N) by resize(). Like all values of the strength
+// tables, it is reference counted, since it is shared by the hash table
+// and the top lists.
+
+template <unsigned int N>
+class CRPropVec : public CRef
 {
-    friend class CTopBase;
 private:
-    float m_Strg;      // Strength of the current entry
-    CpCRef m_Data;     // the value to which the properties are assigned
-    CPtr<CRvector<float> > m_Props; // property vector of the data
+    float m_Props[N];
+    unsigned int m_Size; // number of properties assigned
 public:
-    // default constructor
-    CTopEntry() : m_Strg(0), m_Data(), m_Props() {}
-    // copy constructor
-    CTopEntry(const CTopEntry& Ent) :
-            m_Strg(Ent.m_Strg), m_Data(Ent.m_Data), m_Props(Ent.m_Props) {} 
-    CTopEntry& operator=(CTopEntry const& Ent) {
-        m_Strg = Ent.m_Strg;
-        m_Data = Ent.m_Data;
-        m_Props = Ent.m_Props;
-        return *this;
+    CRPropVec() : m_Size(0) {}
+    CRPropVec(unsigned int Size) : m_Size(0) { resize(Size); }
+    unsigned int size() const { return m_Size; }
+    bool empty() const { return !m_Size; }
+    // the maximal size
+    static unsigned int capacity() { return N; }
+    // Increases the size to the given size. The new properties are
+    // set to 'Val'. The size cannot be decreased.
+    void resize(unsigned int Size, float Val = 0) {
+        static char Rname[] = "CRPropVec::resize";
+        if(Size > N) {
+            yPError(ERR_OUT_OF_RANGE, "too many properties");
+        }
+        for( ; m_Size < Size ; m_Size++)
+            m_Props[m_Size] = Val;
+    }
+    float& operator[](unsigned int Prop) { return m_Props[Prop]; }
+    float& at(unsigned int Prop) {
+        static char Rname[] = "CRPropVec::at";
+        if(Prop >= m_Size) {
+            yPError(ERR_OUT_OF_RANGE, "property not in vector");
+        }
+        return m_Props[Prop];
     }
-    CRef* GetData() { return (CRef*)m_Data; }
-    float GetStrg() { return m_Strg; }
-    CRvector<float>* GetVal() { return (CRvector<float>*)m_Props; }
 };
 
 // the class CTopBase Maintains a list of entries, with strengths. The list
@@ -77,57 +99,108 @@ public:
 // Therefore, when the list is full and a new entry is added with a
 // strength equal to that of the weakest entry in the list, the old entry
 // is replaced by the new one.
+//
+// The entries are stored as three parallel arrays (the entry at position
+// i consists of the i'th element of each array): the strengths, the
+// values to which the properties are assigned (the keys of the table,
+// stored as their integers, see IdHash.h) and the property vectors of
+// these values. Scanning the strengths therefore only reads a compact
+// array of floats, and the key and the property vector of an entry are
+// reached by its position. The list holds a reference to each property
+// vector in it. This reference is added when the entry is stored in the
+// list and removed when the entry is replaced or the list is cleared.
+// Reordering the entries and iterating over them do not change any
+// reference counts.
+// The number of bytes used by each entry (in all three arrays) is counted
+// (by CObjStats) as a top list entry.
+//
+// CTopBase stores the entries and holds their references. The operations
+// which reorder the entries (and record the positions in the property
+// vectors of the entries) are defined by CTop<K,V>, as these depend on the
+// type V of the property vectors.
+
+// number of bytes used by a single entry of a top list
+#define TOP_ENTRY_BYTES (sizeof(float) + sizeof(unsigned int) + \
+                         sizeof(CRef*))
 
 class CTopBase : public CRef
 {
-public:
-    std::vector<CTopEntry> m_Entries; // vector of top entries
+protected:
+    std::vector<float> m_Strgs;   // strengths of the entries
+    std::vector<unsigned int> m_Keys; // the values to which the
+                                      // properties are assigned
+    std::vector<CRef*> m_Props;   // property vectors of the data
     unsigned int m_MaxEntries;  // maximal number of entries to be stored
     unsigned int m_NextEntry; // index beyond the last entry in the list
 public:
-    std::vector<CTopEntry>& GetEntries() { return m_Entries; }
     unsigned int const GetNextEntry() { return m_NextEntry; }
-    CTopBase() : m_MaxEntries(0), m_NextEntry(0), m_Entries(0) {}
+    // the entry arrays (to be read by the iterators)
+    float* GetStrgs() { return m_NextEntry ? &m_Strgs[0] : NULL; }
+    unsigned int* GetKeys() { return m_NextEntry ? &m_Keys[0] : NULL; }
+    CRef** GetProps() { return m_NextEntry ? &m_Props[0] : NULL; }
+    CTopBase() : m_MaxEntries(0), m_NextEntry(0) {}
     // constructor
     CTopBase(unsigned int MaxEntries, bool bReserve = false) :
-            m_MaxEntries(MaxEntries), m_NextEntry(0), m_Entries(0)
+            m_MaxEntries(MaxEntries), m_NextEntry(0)
         {
             if(bReserve)
-                m_Entries.reserve(m_MaxEntries);
+                Reserve();
         }
-    // copy constructor
-    CTopBase(CTopBase const& Top) :
-            m_MaxEntries(Top.m_MaxEntries), m_NextEntry(Top.m_NextEntry),
-            m_Entries(Top.m_Entries) {}
+    // copy constructor (the copy adds its own references to the entries)
+    CTopBase(CTopBase const& Top);
+#if __cplusplus >= 201103L
+    // move constructor (used when a vector of top lists is reallocated).
+    // The references of the entries are moved to the new list.
+    CTopBase(CTopBase&& Top) noexcept :
+            m_Strgs(std::move(Top.m_Strgs)), m_Keys(std::move(Top.m_Keys)),
+            m_Props(std::move(Top.m_Props)), m_MaxEntries(Top.m_MaxEntries),
+            m_NextEntry(Top.m_NextEntry) {
+        Top.m_Strgs.clear();
+        Top.m_Keys.clear();
+        Top.m_Props.clear();
+        Top.m_NextEntry = 0;
+    }
+#endif
+    ~CTopBase() { Clear(); }
+    CTopBase& operator=(CTopBase const& Top);
     // change the maximal number of entries
     void ResetMaxEntries(unsigned int MaxEntries, bool bReserve = false) {
         m_MaxEntries = MaxEntries;
         if(m_NextEntry > m_MaxEntries)
-            m_NextEntry = m_MaxEntries;
+            Truncate(m_MaxEntries);
         if(bReserve)
-            m_Entries.reserve(m_MaxEntries);
+            Reserve();
     }
-protected:
-    // Add the given entry to the list (returns position, -1 if none)
-    int Add(float Strg, CRef* pData, CRvector<float>* pProps,
-            unsigned int PropNum);
-public:
-    // Increment the strength of entry in position Pos by strength Strg
-    // (returns new position)
-    int Inc(unsigned int Pos, float Strg, unsigned int PropNum);
     // Clear the table
-    void Clear();
-private:
-    // Push the entry at position Pos up until only entries with strictly
-    // higher strengths are above it in the list
-    int PushUp(unsigned int Pos, unsigned int PropNum);
+    void Clear() { Truncate(0); }
+protected:
+    // reserve space for the maximal number of entries
+    void Reserve() {
+        m_Strgs.reserve(m_MaxEntries);
+        m_Keys.reserve(m_MaxEntries);
+        m_Props.reserve(m_MaxEntries);
+    }
+    // Append an empty entry at the end of the list
+    void Grow() {
+        m_Strgs.push_back(0);
+        m_Keys.push_back(0);
+        m_Props.push_back(NULL);
+        m_NextEntry++;
+        CObjStats::Add(eOSTopEntry, TOP_ENTRY_BYTES);
+    }
+    // Remove all entries beyond the first 'EntryNum' entries (releasing
+    // the references held by these entries).
+    void Truncate(unsigned int EntryNum);
+    // Set the key and property vector of the entry at the given position,
+    // replacing (and releasing) those stored there.
+    void SetEntry(unsigned int Pos, unsigned int Key, CRef* pProps);
     // conversion functions from position to position coded as strength
     // (see explanation above)
 public:
     static float Pos2Strg(unsigned int Pos) { return -((float)Pos+1); }
     static int Strg2Pos(float Strg) { return -(int)(Strg+1); }
     float GetStrg(float StrgPos) {
-        return m_Entries[Strg2Pos(StrgPos)].m_Strg;
+        return m_Strgs[Strg2Pos(StrgPos)];
     }
     bool IsEmpty() { return !m_NextEntry; }
     float GetTopStrg() {
@@ -137,17 +210,17 @@ public:
         return m_NextEntry ? GetStrg(-m_NextEntry) : 0;
     }
 protected:
-    CRef* GetTopData() {
-        return m_NextEntry ? m_Entries.front().GetData() : NULL;
+    unsigned int GetTopKey() {
+        return m_NextEntry ? m_Keys.front() : 0;
     }
-    CRvector<float>* GetTopVec() {
-        return m_NextEntry ? m_Entries.front().GetVal() : NULL;
+    CRef* GetTopVec() {
+        return m_NextEntry ? m_Props.front() : NULL;
     }
-    CRef* GetLastTopData() {
-        return m_NextEntry ? m_Entries.back().GetData() : NULL;
+    unsigned int GetLastTopKey() {
+        return m_NextEntry ? m_Keys[m_NextEntry-1] : 0;
     }
-    CRvector<float>* GetLastTopVec() {
-        return m_NextEntry ? m_Entries.back().GetVal() : NULL;
+    CRef* GetLastTopVec() {
+        return m_NextEntry ? m_Props[m_NextEntry-1] : NULL;
     }
 };
 
@@ -167,72 +240,225 @@ public:
         IncObjCount();
 #endif
     }
+#if __cplusplus >= 201103L
+    // move constructor
+    CTop(CTop&& Top) noexcept : CTopBase(std::move((CTopBase&)Top)) {
+#ifdef DETAILED_DEBUG
+        IncObjCount();
+#endif
+    }
+#endif
+    CTop& operator=(CTop const& Top) {
+        CTopBase::operator=(Top);
+        return *this;
+    }
     ~CTop() {
 #ifdef DETAILED_DEBUG
         DecObjCount();
 #endif
     }
     // Add the given entry to the list (returns position, -1 if none)
-    int Add(float Strg, K* pData, V* pProps, unsigned int PropNum) {
-        return CTopBase::Add(Strg, (CRef*)pData, (CRvector<float>*)pProps,
-                             PropNum);
-    }
+    int Add(float Strg, K Key, V* pProps, unsigned int PropNum);
+    // Append the given entry at the end of the list, without reordering
+    // (used to restore a list which was saved in order). Returns false if
+    // the list is full.
+    bool Append(float Strg, K Key, V* pProps, unsigned int PropNum);
+    // Increment the strength of entry in position Pos by strength Strg
+    // (returns new position)
+    int Inc(unsigned int Pos, float Strg, unsigned int PropNum);
+private:
+    // Push the entry at position Pos up until only entries with strictly
+    // higher strengths are above it in the list
+    int PushUp(unsigned int Pos, unsigned int PropNum);
+    // the property vector of the entry at the given position
+    V* Props(unsigned int Pos) { return (V*)m_Props[Pos]; }
+public:
 
-    K* GetTopData() { return (K*)CTopBase::GetTopData(); }
+    K GetTopData() { return K(CTopBase::GetTopKey()); }
     V* GetTopVal() { return (V*)CTopBase::GetTopVec(); }
-    K* GetLastTopData() { return (K*)CTopBase::GetLastTopData(); }
+    K GetLastTopData() { return K(CTopBase::GetLastTopKey()); }
     V* GetLastTopVal() { return (V*)CTopBase::GetLastTopVec(); }
 };
 
-// Iterator through a CTop list.
+// pushes the entry at position Pos up until only entries with strictly
+// higher strengths are above it in the list
+
+template <class K, class V>
+int
+CTop<K,V>::PushUp(unsigned int Pos, unsigned int PropNum)
+{
+    static char Rname[] = "CTop::PushUp";
+    
+    if(Pos >= m_NextEntry) {
+        // should not happen
+        yPError(ERR_OUT_OF_RANGE, "position not in table");
+    }
+    
+    if(!Pos || m_Strgs[Pos] < m_Strgs[Pos-1])
+        return Pos; // nothing to do
+
+    // The entries above are moved down by one position and the entry is
+    // then stored at its new position (the pointers are moved as they
+    // are, so no reference counts need to be updated).
+
+    float Strg = m_Strgs[Pos];
+    unsigned int Key = m_Keys[Pos];
+    CRef* pProps = m_Props[Pos];
+    unsigned int NewPos = Pos;
+    
+    do {
+        // move the entry above down
+        m_Strgs[NewPos] = m_Strgs[NewPos-1];
+        m_Keys[NewPos] = m_Keys[NewPos-1];
+        m_Props[NewPos] = m_Props[NewPos-1];
+        if(m_Props[NewPos])
+            (*Props(NewPos))[PropNum] = Pos2Strg(NewPos);
+        NewPos--;
+    } while(NewPos > 0 && m_Strgs[NewPos-1] <= Strg);
+
+    m_Strgs[NewPos] = Strg;
+    m_Keys[NewPos] = Key;
+    m_Props[NewPos] = pProps;
+    if(pProps)
+        (*Props(NewPos))[PropNum] = Pos2Strg(NewPos);
+    return NewPos;
+}
+
+// Add the given entry to the top list.
+
+template <class K, class V>
+int
+CTop<K,V>::Add(float Strg, K Key, V* pProps, unsigned int PropNum)
+{
+    if(m_MaxEntries > m_NextEntry)
+        Grow();
+
+    if(!m_NextEntry)
+        return -1; // top list length is 0
+    
+    unsigned int Last = m_NextEntry-1;
+    
+    if(Strg < m_Strgs[Last])
+        return -1; // list is full
+    
+    // If an entry with a property vector is being replaced, update its
+    // property vector
+    if(m_Props[Last])
+        (*Props(Last))[PropNum] = m_Strgs[Last];
+
+    // replace (or initialize) the last entry
+
+    m_Strgs[Last] = Strg;
+    SetEntry(Last, Key.GetPacked(), (CRef*)pProps);
+    if(pProps)
+        (*pProps)[PropNum] = Pos2Strg(Last);
+    
+    // Reorder the entries, if needed.
+
+    return PushUp(Last, PropNum);
+}
+
+template <class K, class V>
+bool
+CTop<K,V>::Append(float Strg, K Key, V* pProps, unsigned int PropNum)
+{
+    if(m_NextEntry >= m_MaxEntries)
+        return false;
+
+    Grow();
+
+    unsigned int Last = m_NextEntry-1;
+
+    m_Strgs[Last] = Strg;
+    SetEntry(Last, Key.GetPacked(), (CRef*)pProps);
+    if(pProps)
+        (*pProps)[PropNum] = Pos2Strg(Last);
+
+    return true;
+}
+
+template <class K, class V>
+int
+CTop<K,V>::Inc(unsigned int Pos, float Strg, unsigned int PropNum)
+{
+    static char Rname[] = "CTop::Inc(unsigned int Pos, float Strg)";
+    
+    if(Pos >= m_NextEntry) {
+        // should not happen
+        yPError(ERR_OUT_OF_RANGE, "position requested is out of range");
+    }
+
+    if(Strg < 0) {
+        yPError(ERR_OUT_OF_RANGE, "negative strength increment");
+    }
+    
+    m_Strgs[Pos] += Strg;
+
+    // Reorder the entries, if needed
+    return PushUp(Pos, PropNum);
+}
+
+// Iterator through a CTop list. The iterator reads the entry arrays of
+// the list directly (it does not change any reference counts).
 
 template <class K, class V>
 class CTopIter : public CRef
 {
-    std::vector<CTopEntry>::iterator m_Iter;
-    std::vector<CTopEntry>::iterator m_Begin;
-    std::vector<CTopEntry>::iterator m_End;
+    float* m_pStrgs;
+    unsigned int* m_pKeys;
+    CRef** m_pProps;
+    unsigned int m_Pos; // current position
+    unsigned int m_End; // number of entries in the list
 public:
-    CTopIter(CStrengths<K, V>* Tbl, unsigned int Prop) {
+    CTopIter(CStrengths<K, V>* Tbl, unsigned int Prop) :
+            m_pStrgs(NULL), m_pKeys(NULL), m_pProps(NULL), m_Pos(0),
+            m_End(0) {
 #ifdef DETAILED_DEBUG
         IncObjCount();
 #endif
         if(!(bool)Tbl || Tbl->m_TopLists.size() <= Prop) return;
-        m_Begin = m_Iter = Tbl->m_TopLists[Prop].GetEntries().begin();
-        m_End = m_Iter + Tbl->m_TopLists[Prop].GetNextEntry();
+        Init(Tbl->m_TopLists[Prop]);
     }
     CTopIter(CTop<K,V>& Top) {
 #ifdef DETAILED_DEBUG
         IncObjCount();
 #endif
-        m_Begin = m_Iter = Top.GetEntries().begin();
-        m_End = m_Iter + Top.GetNextEntry();
+        Init(Top);
     }
     ~CTopIter() {
 #ifdef DETAILED_DEBUG
         DecObjCount();
 #endif
     }
-    
+private:
+    void Init(CTop<K,V>& Top) {
+        m_pStrgs = Top.GetStrgs();
+        m_pKeys = Top.GetKeys();
+        m_pProps = Top.GetProps();
+        m_Pos = 0;
+        m_End = Top.GetNextEntry();
+    }
+public:
     // advance the iterator - return false if advance beyond the end
     bool operator++() {
-        ++m_Iter;
-        return (m_Iter < m_End);
+        ++m_Pos;
+        return (m_Pos < m_End);
     }
-    operator bool() { return (m_Iter < m_End); }
+    operator bool() { return (m_Pos < m_End); }
     // number of elements remaining in the iterator to the end (including
     // the current element)
-    int NumRemaining() { return (int)(m_End - m_Iter); }
+    int NumRemaining() { return (int)m_End - (int)m_Pos; }
     // restarts the iterator (returns false if the iterator is empty)
     // This should only be used when it is certain that the table has not
     // been changed since the iterator was created.
     bool Restart() {
-        m_Iter = m_Begin;
-        return (m_Iter < m_End);
+        m_Pos = 0;
+        return (m_Pos < m_End);
     }
-    float Strg() { return (m_Iter < m_End) ? m_Iter->GetStrg() : 0; }
-    K* Data() { return (m_Iter < m_End) ? (K*)(m_Iter->GetData()) : NULL; }
-    V* Val() { return (m_Iter < m_End) ? (V*)(m_Iter->GetVal()) : NULL; }
+    float Strg() { return (m_Pos < m_End) ? m_pStrgs[m_Pos] : 0; }
+    // the key of the current entry (the null key if none)
+    K Data() { return K((m_Pos < m_End) ? m_pKeys[m_Pos] : 0); }
+    V* Val() { return (m_Pos < m_End) ? (V*)m_pProps[m_Pos] : NULL; }
 };
 
 //////////////////////////
@@ -249,21 +475,37 @@ public:
 // Note that because of the way the position is coded, this function
 // does not need to have access to the tables themselves, but only to
 // the property vector of the entry.
-extern int GetTopListPosFromVec(CRvector<float>* pVec, unsigned int Prop);
+template <class V>
+int
+GetTopListPosFromVec(V* pVec, unsigned int Prop)
+{
+    if(!pVec || Prop >= pVec->size())
+        return -1;
+    if((*pVec)[Prop] < 0)
+        return CTopBase::Strg2Pos((*pVec)[Prop]);
+    return -1;
+}
 
 // Is the entry with the given property vector in the top list for the
 // given property ?
 // Note that because of the way the position is coded, this function
 // does not need to have access to the tables themselves, but only to
 // the property vector of the entry.
-extern bool IsInTheTopList(CRvector<float>* pVec, unsigned int Prop);
+template <class V>
+bool
+IsInTheTopList(V* pVec, unsigned int Prop)
+{
+    return (GetTopListPosFromVec(pVec, Prop) >= 0);
+}
 
 // The following class consists of a hash table with values which are
 // (fixed length) arrays of property strengths.
 // For the specified number of properties at the beginning of the
 // property list, a list of highest strength keys is maintained.
-// The class K may be any class derived from CKey.
-// The class V should be derived from CRvector<float>.
+// The class K is a key identified by an integer (as required by CIdHash,
+// see IdHash.h). Keys are passed and returned by value and the null key
+// (K(0)) stands for 'no key'.
+// The class V should be derived from CRvector<float> or CRPropVec<N>.
 
 // No reference count is defined for this class (so that it could be
 // used in combination with other classes which have a reference count).
@@ -271,10 +513,14 @@ extern bool IsInTheTopList(CRvector<float>* pVec, unsigned int Prop);
 template <class K, class V>
 class CStrengths
 {
-    typedef CRvector<float> CRVecFl;
     friend class CTopIter<K, V>;
+public:
+    // hash table and lookup position types
+    typedef CIdHash<K, V> CStrgHash;
+    typedef CIdHashIter<K, V> CStrgIter;
+    typedef CIdHashPos<K, V> CStrgPos;
 private:
-    CPtr<CHash<K, V> > m_pHash;
+    CPtr<CStrgHash> m_pHash;
     
     // number of properties (at the beginning of the list) for which
     // a top strength list is maintained
@@ -288,7 +534,7 @@ private:
 public:
     CStrengths(unsigned int TopNum, unsigned int MaxTopLength,
                bool bReserve) :
-            m_pHash(new CHash<K,V>()),
+            m_pHash(new CStrgHash()),
             m_TopNum(TopNum), m_MaxTopLength(MaxTopLength),
             m_bReserve(bReserve),
             m_TopLists((bReserve && (TopNum != PROPS_UNBOUNDED)) ? TopNum : 0,
@@ -297,7 +543,8 @@ public:
 
     CStrengths(unsigned int TopNum, unsigned int MaxTopLength,
                unsigned int HashSize, bool bReserve) :
-            m_pHash(new CHash<K,V>(HashSize)), m_TopNum(TopNum),
+            m_pHash(new CStrgHash(HashSize)),
+            m_TopNum(TopNum),
             m_MaxTopLength(MaxTopLength), m_bReserve(bReserve),
             m_TopLists((bReserve && (TopNum != PROPS_UNBOUNDED)) ? TopNum : 0,
                        CTop<K,V>(MaxTopLength, m_bReserve)) {
@@ -314,118 +561,140 @@ public:
             NULL : new CTopIter<K, V>(this, Prop);
     }
 
-    CHashIter<K, V>* GetFullIter() {
+    CStrgIter* GetFullIter() {
         return m_pHash->Begin();
     }
+
+    // Makes the hash table and the values of all its entries immortal (see
+    // CRef::MakeImmortal()), when the table is no longer modified and is
+    // read by several threads.
+    void FreezeEntries() {
+        m_pHash->MakeImmortal();
+        for(CPtr<CStrgIter> pIter = GetFullIter() ; *pIter ; ++(*pIter))
+            if(pIter->GetVal())
+                pIter->GetVal()->MakeImmortal();
+    }
     
-    // Increments the strength for the given property.
+    // Increments the strength for the given property of the entry with
+    // the given key and value (the key must be the key stored in the
+    // table for this value, as it is the key which is added to the top
+    // list).
     // If bAddToTopList is false, the entry is not added into the top list
     // (but if it is already in the top list, it will stay there).
     // Returns a pointer to the value of the entry.
 
-    V* IncStrength(V* pVal, unsigned int Prop, float Strg,
+    V* IncStrength(K Key, V* pVal, unsigned int Prop, float Strg,
                    bool bAddToTopList = true) {
         if(Strg < 0)
             return NULL;
 
-        if((*(CRVecFl*)pVal).size() <= Prop)
-            (*(CRVecFl*)pVal).resize(Prop+1, 0);
+        if(pVal->size() <= Prop)
+            pVal->resize(Prop+1, 0);
 
         if(Prop >= m_TopNum) {
-            ((*(CRVecFl*)pVal)[Prop] += Strg);
-        } else if((*(CRVecFl*)pVal)[Prop] < 0) {
+            ((*pVal)[Prop] += Strg);
+        } else if((*pVal)[Prop] < 0) {
             m_TopLists[Prop].
-                Inc(CTopBase::Strg2Pos((*(CRVecFl*)pVal)[Prop]), Strg ,Prop);
+                Inc(CTopBase::Strg2Pos((*pVal)[Prop]), Strg ,Prop);
         } else if(!bAddToTopList) {
-            ((*(CRVecFl*)pVal)[Prop] += Strg);
+            ((*pVal)[Prop] += Strg);
         } else {
-            (*(CRVecFl*)pVal)[Prop] += Strg;
+            (*pVal)[Prop] += Strg;
             if(m_TopLists.size() <= Prop)
                 m_TopLists.resize(Prop+1,
                                   CTop<K,V>(m_MaxTopLength, m_bReserve));
-            m_TopLists[Prop].Add((*(CRVecFl*)pVal)[Prop], m_pHash->Key(),
-                                 pVal, Prop);
+            m_TopLists[Prop].Add((*pVal)[Prop], Key, pVal, Prop);
         }
 
         return pVal;
     }
     
     // Increments the strength on the given key entry for the given property.
+    // If the key is not yet in the table, an entry is created for it.
     // If bAddToTopList is false, the entry is not added into the top list
     // (but if it is already in the top list, it will stay there).
-    // Returns a pointer to the value of the entry
+    // Returns the position of the entry in the hash table (valid until
+    // the next insertion into the table).
 
-    V* IncStrength(K& Key, unsigned int Prop, float Strg,
-                   bool bAddToTopList = true) {
+    CStrgPos IncStrength(K Key, unsigned int Prop, float Strg,
+                         bool bAddToTopList = true) {
         
         if(Strg < 0)
-            return NULL;
+            return CStrgPos();
 
-        V* pVec;
+        CStrgPos Pos = m_pHash->FindOrInsert(Key);
         
-        if(!(*m_pHash)[Key].Found()) {
-            *m_pHash = pVec = new V(Prop+1);
-        } else {
-            pVec = m_pHash->Val();
-            if(pVec->size() <= Prop)
-                pVec->resize(Prop+1, 0);
-        }
+        if(!Pos.Val())
+            m_pHash->SetVal(Pos, new V(Prop+1));
 
-        if(Prop >= m_TopNum) {
-            ((*pVec)[Prop] += Strg);
-        } else if((*pVec)[Prop] < 0) {
-            m_TopLists[Prop].Inc(CTopBase::Strg2Pos((*pVec)[Prop]), Strg,
-                                 Prop);
-        } else if(!bAddToTopList) {
-            ((*(CRVecFl*)pVec)[Prop] += Strg);
-        } else {
-            (*pVec)[Prop] += Strg;
-            if(m_TopLists.size() <= Prop)
-                m_TopLists.resize(Prop+1,
-                                  CTop<K,V>(m_MaxTopLength, m_bReserve));
-            m_TopLists[Prop].Add((*pVec)[Prop], m_pHash->Key(), pVec, Prop);
-        }
+        IncStrength(Pos.Key(), Pos.Val(), Prop, Strg, bAddToTopList);
 
-        return (V*)pVec;
+        return Pos;
     }
 
-    // Get the last key used to access the table. This key is cached on the
-    // hash table object
+    // Restoring a saved table: the following two functions allow a table
+    // to be reconstructed exactly as it was saved. First, all entries
+    // are inserted with their raw value vectors (as saved, including
+    // the top list positions coded into them). Then, the top lists are
+    // restored by appending their entries in order. AppendTopEntry()
+    // returns false if the entry's value vector does not record the
+    // position at which it is appended or if the top list is full.
+
+    // Insert the given key with the given value. Returns the position of
+    // the entry (as FindOrInsert()).
+    CStrgPos InsertEntry(K Key, V* pVal) {
+        CStrgPos Pos = m_pHash->FindOrInsert(Key);
+        m_pHash->SetVal(Pos, pVal);
+        return Pos;
+    }
 
-    K* GetKey() {
-        return m_pHash->Key();
+    bool AppendTopEntry(unsigned int Prop, float Strg, K Key, V* pVal) {
+        if(Prop >= m_TopNum || pVal->size() <= Prop)
+            return false;
+        if(m_TopLists.size() <= Prop)
+            m_TopLists.resize(Prop+1, CTop<K,V>(m_MaxTopLength, m_bReserve));
+        if((*pVal)[Prop] !=
+           CTopBase::Pos2Strg(m_TopLists[Prop].GetNextEntry()))
+            return false;
+        return m_TopLists[Prop].Append(Strg, Key, pVal, Prop);
+    }
+    
+    // Find the entry with the given key. This does not modify the table.
+
+    CStrgPos Find(K Key) {
+        return m_pHash->Find(Key);
     }
     
     // Get the value object 
 
-    V* GetVal(K& Key) {
-        return m_pHash->Val(Key);
+    V* GetVal(K Key) {
+        return m_pHash->Find(Key).Val();
     }
     
     // Get the complete strength vector (to be used when the strength of
     // several properties for the same entry have to be looked up).
 
-    CRvector<float>* GetStrengthVector(K& Key) {
-        return (CRvector<float>*)GetVal(Key);
+    V* GetStrengthVector(K Key) {
+        return GetVal(Key);
     }
 
     // Retrieve the position in top list (0 - first position) for the
     // given key and property. Returns -1 if no top list exists for the
     // property or the entry is not in the top list.
     
-    int GetTopListPos(K& Key, unsigned int Prop) {
+    int GetTopListPos(K Key, unsigned int Prop) {
         return GetTopListPosFromVec(GetStrengthVector(Key), Prop);
     }
     
     // Is the entry in the top list for the given property ?
     
-    bool IsInTopList(K& Key, unsigned int Prop) {
+    bool IsInTopList(K Key, unsigned int Prop) {
         return (GetTopListPos(Key, Prop) >= 0);
     }
     
     // Retrieve the strength of a given property from a property vector
     
-    float GetStrengthFromVec(CRvector<float>* pVec, unsigned int Prop) {
+    float GetStrengthFromVec(V* pVec, unsigned int Prop) {
         if(!pVec || Prop >= pVec->size())
             return 0;
         if((*pVec)[Prop] < 0) {
@@ -436,7 +705,7 @@ public:
 
     // Get the strength of the given property for the given key
 
-    float GetStrength(K& Key, unsigned int Prop) {
+    float GetStrength(K Key, unsigned int Prop) {
         return GetStrengthFromVec(GetStrengthVector(Key), Prop);
     }
     
@@ -483,8 +752,8 @@ public:
                 ++(*pIter))
                 pIter->Val()->at(Prop) = 0;
         } else {
-            for(CPtr<CHashIter<K, V> > pIter = m_pHash->Begin() ; *pIter ;
-                ++(*pIter))
+            for(CPtr<CStrgIter> pIter =
+                    m_pHash->Begin() ; *pIter ; ++(*pIter))
                 if(pIter->GetVal()->size() > Prop)
                     pIter->GetVal()->at(Prop) = 0;
         }
@@ -503,6 +772,11 @@ public:
     bool IsEmpty() {
         return !m_pHash->NumElements();
     }
+
+    // Returns the number of entries in the table
+    unsigned int NumEntries() {
+        return m_pHash->NumElements();
+    }
 };
 
 #endif /* __STRENGTH_H__ */
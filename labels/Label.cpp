@@ -19,12 +19,12 @@
 using namespace std;
 
 void
-CLabel::LabelString(string& Output)
+CLabel::LabelString(string& Output) const
 {
     string Prefix;
     string Suffix;
     
-    unsigned int Type = m_Type;
+    unsigned int Type = m_Packed & LB_TYPE_MASK;
 
     if(Type & 1)
         Prefix += '.';
@@ -38,5 +38,5 @@ CLabel::LabelString(string& Output)
         Type = Type >> 2;
     }
 
-    Output = Prefix + (string const&)*m_StrKey + Suffix;
+    Output = Prefix + GetStrKey()->GetStr() + Suffix;
 }
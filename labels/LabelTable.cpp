@@ -29,21 +29,28 @@ using namespace std;
 // Returns the value object of the label.
 
 CLabelVal*
-CLabelTable::AddLabel(CLabel* pLabel, unsigned int Prop, float Strg)
+CLabelTable::AddLabel(CLabel Label, unsigned int Prop, float Strg)
 {
-    if(!pLabel)
+    if(Label.IsNull())
         return NULL;
 
-    CpCLabelVal pVal = GetVal(*pLabel);
+    CpCLabelVal pVal = GetVal(Label);
 
     if(!pVal)
-        return IncStrength(*pLabel, Prop, Strg);
+        return IncStrength(Label, Prop, Strg).Val();
     
     return AddLabel(pVal, Prop, Strg);
 }
 
 CLabelVal*
 CLabelTable::AddLabel(CLabelVal* pVal, unsigned int Prop, float Strg)
+{
+    return AddLabel(CLabel(), pVal, Prop, Strg);
+}
+
+CLabelVal*
+CLabelTable::AddLabel(CLabel Key, CLabelVal* pVal, unsigned int Prop,
+                      float Strg)
 {
     if(!pVal)
         return NULL;
@@ -51,25 +58,25 @@ CLabelTable::AddLabel(CLabelVal* pVal, unsigned int Prop, float Strg)
     float TableStrg = GetStrengthFromVec(pVal, Prop);
     
     if(TableStrg < Strg)
-        return IncStrength(pVal, Prop, Strg - TableStrg);
+        return IncStrength(Key, pVal, Prop, Strg - TableStrg);
     else
         return pVal;
 }
 
 CLabelVal*
-CLabelTable::FlipAndAddLabel(CLabel* pLabel, unsigned int Prop,
+CLabelTable::FlipAndAddLabel(CLabel Label, unsigned int Prop,
                              bool bOp, float Strg)
 {
-    if(!pLabel)
+    if(Label.IsNull())
         return NULL;
 
     // flip the label
-    CpCLabel pFlipped;
+    CLabel Flipped;
     
     // if the label is an 'opposite side' label, flipping the label
     // also consists of inserting the 'opposite side bits'.
     if(bOp) {
-        unsigned int Type = (unsigned int)*pLabel;
+        unsigned int Type = Label.GetType();
 
         // label,1 -> label,0,1,0
         // label,0 -> label,1,1,1
@@ -79,13 +86,13 @@ CLabelTable::FlipAndAddLabel(CLabel* pLabel, unsigned int Prop,
         Type |= 2;
         Type |= ((Type & 4) >> 2);
 
-        pFlipped = new CLabel(Type, *pLabel);
+        Flipped = CLabel(Type, Label);
     } else
         // flips the first bit of the label
-        pFlipped = new CLabel(*pLabel);
+        Flipped = Label.Flipped();
     
     // add the label
-    return AddLabel(pFlipped, Prop, Strg);
+    return AddLabel(Flipped, Prop, Strg);
 }
 
 void
@@ -101,10 +108,7 @@ CLabelTable::CopyLabels(CLabelTable* pLabels, unsigned int Prop)
 }
 
 float
-CLabelTable::Strg(CLabel* pLabel, unsigned int Prop)
+CLabelTable::Strg(CLabel Label, unsigned int Prop)
 {
-    if(!pLabel)
-        return 0;
-
-    return GetStrength(*pLabel, Prop);
+    return GetStrength(Label, Prop);
 }
@@ -197,6 +197,19 @@ CCmdArgOpts::SetDefaults(CCmdArgOpts* pGlobalOpts)
         m_Evaluators.clear();
     // No lexicon printing by default
     m_bPrintLexicon = pGlobalOpts ? pGlobalOpts->m_bPrintLexicon : false;
+    // No lexicon snapshots by default. These are not inherited, as
+    // each snapshot should only be loaded or saved once.
+    m_LoadLexiconFile = "";
+    m_SaveLexiconFile = "";
+    m_MapLexiconFile = "";
+    m_SaveMappedLexiconFile = "";
+    // No checkpoints by default. The checkpoint file is not inherited
+    // (each step must write its own checkpoints) but the intervals are.
+    m_CheckpointFile = "";
+    m_CheckpointObjs = pGlobalOpts ? pGlobalOpts->m_CheckpointObjs : 0;
+    m_CheckpointSecs = pGlobalOpts ? pGlobalOpts->m_CheckpointSecs : 0;
+    // Start from the beginning by default
+    m_bResume = pGlobalOpts ? pGlobalOpts->m_bResume : false;
 }
 
 bool
@@ -241,6 +254,31 @@ CCmdArgOpts::ArgSwitch(int& ac, char**& av)
             m_bPrintLexicon = true;
             ac--; av++;
             break;
+        case 'r':
+            ReadArg(ac, av, m_LoadLexiconFile);
+            break;
+        case 'w':
+            ReadArg(ac, av, m_SaveLexiconFile);
+            break;
+        case 'm':
+            ReadArg(ac, av, m_MapLexiconFile);
+            break;
+        case 'W':
+            ReadArg(ac, av, m_SaveMappedLexiconFile);
+            break;
+        case 'k':
+            ReadArg(ac, av, m_CheckpointFile);
+            break;
+        case 'K':
+            ReadArg(ac, av, m_CheckpointObjs);
+            break;
+        case 'T':
+            ReadArg(ac, av, m_CheckpointSecs);
+            break;
+        case 'u':
+            m_bResume = true;
+            ac--; av++;
+            break;
         case '-':
             // Just a separator (end of multi-value argument).
             ac--; av++;
@@ -102,6 +102,53 @@ CMultiInFile::GetLine()
     return true;
 }
 
+bool
+CMultiInFile::GetPos(unsigned int& FileNum, unsigned long long& Offset)
+{
+    if(m_Bad)
+        return false;
+
+    // The file currently open is the one before the file iterator. If
+    // no more lines can be read from it, the next line is read from the
+    // beginning of the next file.
+    
+    if(m_Eof || !m_InStream.is_open() || !m_InStream.good()) {
+        FileNum = m_Files.Position();
+        Offset = 0;
+        return true;
+    }
+
+    streampos Pos = m_InStream.tellg();
+
+    if(Pos < 0)
+        return false;
+    
+    FileNum = m_Files.Position() - 1;
+    Offset = Pos;
+    return true;
+}
+
+bool
+CMultiInFile::SetPos(unsigned int FileNum, unsigned long long Offset)
+{
+    m_Bad = m_Eof = false;
+    m_Files.Begin();
+
+    for(unsigned int i = 0 ; i < FileNum ; i++) {
+        if(!m_Files)
+            return !(m_Bad = true); // no such file
+        ++m_Files;
+    }
+
+    if(!OpenNextFile())
+        return !m_Bad && !Offset; // at the end of all files
+
+    if(Offset && !m_InStream.seekg(Offset))
+        return !(m_Bad = true);
+
+    return true;
+}
+
 bool
 CMultiInFile::Clear()
 {
@@ -25,11 +25,12 @@ CHashBase::CHashBase(unsigned int Size) : m_NElements(0)
     
     if(!Size)
         Size = HASH_DEFAULT_SIZE;
-    else
-        // round to the nearest (larger) power of 2
-        for(HashSize = 1 ; HashSize < Size ; HashSize = (HashSize << 1));
+
+    // round to the nearest (larger) power of 2
+    for(HashSize = 1 ; HashSize < Size ; HashSize = (HashSize << 1));
 
     m_pSlots = new CHashEnt*[HashSize];
+    CObjStats::Add(eOSHashSlots, HashSize * sizeof(CHashEnt*));
 
     for(int i = 0 ; i < HashSize ; i++)
         m_pSlots[i] = NULL;
@@ -40,6 +41,7 @@ CHashBase::CHashBase(unsigned int Size) : m_NElements(0)
 CHashBase::~CHashBase()
 {
     Clear();
+    CObjStats::Remove(eOSHashSlots, (m_HashMask + 1) * sizeof(CHashEnt*));
     delete[] m_pSlots; 
 }
 
@@ -83,6 +85,7 @@ CHashBase::Resize(unsigned int Log2Fac)
     
     // allocate the new table
     ppNewSlots = new CHashEnt* [NewMask+1];
+    CObjStats::Add(eOSHashSlots, (NewMask + 1) * sizeof(CHashEnt*));
 
     for(int i = 0 ; i <= NewMask ; i++)
         ppNewSlots[i] = NULL;
@@ -100,6 +103,7 @@ CHashBase::Resize(unsigned int Log2Fac)
         }
     }
 
+    CObjStats::Remove(eOSHashSlots, (m_HashMask + 1) * sizeof(CHashEnt*));
     delete[] m_pSlots;
     m_pSlots = ppNewSlots;
     m_HashMask = NewMask;
@@ -202,13 +206,62 @@ CHashBase::Insert(CRef* pVal)
 CRef*
 CHashBase::Val(CKey& Key)
 {
-    CHashEnt** pEnt = Lookup(Key);
+    return Find(Key).Val();
+}
 
-    // remove the lookup from the cache
-    m_pLastLookup = NULL;
-    m_pLastKey = NULL;
+// Stateless lookup functions
+
+CHashPosBase
+CHashBase::Find(CKey& Key)
+{
+    CHashEnt* pEnt;
+
+    for(pEnt = m_pSlots[m_HashMask & Key.HashFunc()] ; pEnt ;
+        pEnt = pEnt->pNext) {
+        if(Key.HashEqual((CKey*)(pEnt->m_Key)))
+            break; // found matching entry
+    }
+
+    return CHashPosBase(pEnt);
+}
+
+CHashPosBase
+CHashBase::FindOrInsert(CKey& Key)
+{
+    CHashEnt** ppEnt;
+
+    for(ppEnt = m_pSlots+(m_HashMask & Key.HashFunc()) ; *ppEnt ;
+        ppEnt = &((*ppEnt)->pNext)) {
+        if(Key.HashEqual((CKey*)((*ppEnt)->m_Key)))
+            return CHashPosBase(*ppEnt); // found matching entry
+    }
+
+    CHashEnt* pEnt = *ppEnt = new CHashEnt;
+    pEnt->pNext = NULL;
+    pEnt->m_Key = Key;
+    m_NElements++;
+
+    // If the last lookup pointed at the position where the entry was
+    // inserted, it needs to be refreshed.
+    if(m_pLastLookup == ppEnt)
+        Lookup((CKey&)m_pLastKey);
+    
+    // Check whether the table needs to be resized (this does not move
+    // the entries, so the position remains valid)
+    if(((m_HashMask + 1) << HASH_FULL_DEPTH_FACTOR) < m_NElements)
+        Resize(HASH_DEFAULT_RESIZE_FACTOR);
+
+    return CHashPosBase(pEnt);
+}
+
+void
+CHashBase::SetVal(CHashPosBase const& Pos, CRef* pVal)
+{
+    if(!Pos.m_pEnt) {
+        yPError(ERR_MISSING, "setting value at an empty position");
+    }
 
-    return (pEnt && *pEnt) ? (CRef*)((*pEnt)->m_Val) : NULL;
+    Pos.m_pEnt->m_Val = pVal;
 }
 
 // Base iterator class
@@ -0,0 +1,476 @@
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+//
+// Hash table benchmark suite. This compares the chaining (CHashBase),
+// open addressing (COpenHashBase) and typed open addressing
+// (COpenHashTable<>) hash table implementations through the CHash<>
+// and CHashIter<> interface. This is not part of the parser. It is built
+// by 'make bench' (in the top directory) and run as:
+//
+// hashbench [<number of keys> [<number of lookups> [<number of tables>]]]
+//
+// Two sizes of tables are measured:
+//
+// 1. Lexicon sized: a single table with <number of keys> string keys
+//    (default 1000000).
+// 2. Label table sized: <number of tables> tables (default 20000), each
+//    with 10-16 keys (as the label and statistics tables).
+//
+// For each table size and each implementation the following are measured
+// (in nanoseconds per operation):
+//
+// insert: inserting all keys into initially small tables (this includes
+//         the cost of resizing the tables).
+// worst:  the longest single insertion (usually one which resized
+//         the table).
+// hit:    lookups (operator[]) of existing keys. The keys are drawn from
+//         a Zipfian distribution (as words in a corpus).
+// find:   the same, with the stateless Find().
+// miss:   lookups of keys which are not in the table.
+// iter:   iterating over all entries (per entry).
+// delete: deleting all keys.
+//
+// In addition, the memory allocated by the tables once all keys were
+// inserted and the peak memory during insertion are printed (in bytes per
+// table). The keys themselves are not included. Each implementation is
+// measured in a separate process, so that memory freed by one measurement
+// is not reused by the next.
+//
+
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+#include <new>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "Hash.h"
+
+using namespace std;
+
+// global defined by the parser (in main/Globals.cpp) and needed by the
+// utility library (error printing)
+string g_CommentStr = "#";
+
+//
+// Memory accounting
+//
+
+// All heap allocations are counted by replacing the global operator new
+// and delete. The size of each block is stored in front of the block.
+
+#define BENCH_BLOCK_HEADER 16
+
+static size_t s_CurBytes = 0;  // number of bytes currently allocated
+static size_t s_PeakBytes = 0; // maximal value of s_CurBytes
+
+void*
+operator new(size_t Size)
+{
+    char* pBlock = (char*)malloc(Size + BENCH_BLOCK_HEADER);
+
+    if(!pBlock)
+        throw bad_alloc();
+
+    *(size_t*)pBlock = Size;
+    s_CurBytes += Size;
+    if(s_CurBytes > s_PeakBytes)
+        s_PeakBytes = s_CurBytes;
+
+    return pBlock + BENCH_BLOCK_HEADER;
+}
+
+void
+operator delete(void* p) throw()
+{
+    if(!p)
+        return;
+
+    char* pBlock = (char*)p - BENCH_BLOCK_HEADER;
+
+    s_CurBytes -= *(size_t*)pBlock;
+    free(pBlock);
+}
+
+void*
+operator new[](size_t Size)
+{
+    return operator new(Size);
+}
+
+void
+operator delete[](void* p) throw()
+{
+    operator delete(p);
+}
+
+// current time in nanoseconds
+
+static double
+NowNs()
+{
+    struct timespec Time;
+
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    return Time.tv_sec * 1e9 + Time.tv_nsec;
+}
+
+//
+// Keys and lookup sequences
+//
+
+class CBenchVal : public CRef
+{
+public:
+    unsigned int m_Count;
+    CBenchVal() : m_Count(0) {}
+};
+
+// Simple pseudo random number generator (so that all implementations
+// and platforms are given exactly the same sequences)
+
+class CBenchRand
+{
+private:
+    unsigned long long m_State;
+public:
+    CBenchRand(unsigned long long Seed) : m_State(Seed) {}
+    unsigned int Next() {
+        m_State = m_State * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (unsigned int)(m_State >> 33);
+    }
+    // uniform in [0,1)
+    double NextDouble() {
+        return Next() / 2147483648.0;
+    }
+};
+
+// Generate 'Num' distinct word-like keys (prefixed by 'Prefix').
+
+static void
+MakeKeys(vector<CpCStrKey>& Keys, unsigned int Num, char const* Prefix)
+{
+    CBenchRand Rand(17);
+    char Buf[64];
+
+    Keys.clear();
+    Keys.reserve(Num);
+
+    for(unsigned int i = 0 ; i < Num ; i++) {
+        unsigned int Len = 2 + Rand.Next() % 8;
+        unsigned int Pos = sprintf(Buf, "%s", Prefix);
+        for(unsigned int j = 0 ; j < Len ; j++)
+            Buf[Pos++] = 'a' + Rand.Next() % 26;
+        sprintf(Buf + Pos, "%u", i);
+        Keys.push_back(new CStrKey(Buf));
+    }
+}
+
+// Generate 'Num' indices in [0, KeyNum) drawn from a Zipfian distribution
+// (index r is drawn with probability proportional to 1/(r+1)), as the
+// frequencies of words in a corpus.
+
+static void
+MakeZipfIndices(vector<unsigned int>& Indices, unsigned int KeyNum,
+                unsigned int Num, unsigned long long Seed)
+{
+    vector<double> Cumulative(KeyNum);
+    double Sum = 0;
+    CBenchRand Rand(Seed);
+
+    for(unsigned int r = 0 ; r < KeyNum ; r++)
+        Cumulative[r] = (Sum += 1.0 / (r + 1));
+
+    Indices.resize(Num);
+
+    for(unsigned int i = 0 ; i < Num ; i++) {
+        unsigned int r = lower_bound(Cumulative.begin(), Cumulative.end(),
+                                     Rand.NextDouble() * Sum) -
+            Cumulative.begin();
+        Indices[i] = r < KeyNum ? r : KeyNum - 1;
+    }
+}
+
+//
+// Benchmark
+//
+
+// Results of a single benchmark run (times in ns/op, memory in bytes
+// per table)
+
+struct SBenchResult {
+    double m_Insert;
+    double m_Worst;
+    double m_Hit;
+    double m_Find;
+    double m_Miss;
+    double m_Iter;
+    double m_Delete;
+    double m_Mem;
+    double m_PeakMem;
+    unsigned long m_Check; // checksum (keeps the compiler from optimizing
+                           // the loops away and allows comparing the
+                           // results of the different implementations)
+};
+
+// Select the resize mode (only the open addressing tables support
+// incremental resizing)
+
+static void
+SetResizeMode(CHashBase* pHash, bool bIncremental)
+{
+}
+
+template <class K, class V>
+static void
+SetResizeMode(COpenHashTable<K,V>* pHash, bool bIncremental)
+{
+    pHash->SetIncrementalResize(bIncremental);
+}
+
+// Run the benchmark on Start.size()-1 tables. Table t holds the keys
+// Keys[Start[t]] ... Keys[Start[t+1]-1]. 'Lookups' are the Zipfian
+// ranks of the keys looked up inside a table (lookup i is in table
+// i % <number of tables>).
+
+template <class B>
+static void
+RunBench(SBenchResult& Res, vector<CpCStrKey>& Keys,
+         vector<CpCStrKey>& Missing, vector<unsigned int>& Start,
+         vector<unsigned int>& Lookups, unsigned int InitSize,
+         bool bIncremental)
+{
+    typedef CHash<CStrKey, CBenchVal, B> CBenchHash;
+    typedef CHashIter<CStrKey, CBenchVal, B> CBenchIter;
+
+    unsigned int TableNum = Start.size() - 1;
+    unsigned int KeyNum = Start[TableNum];
+    vector<CPtr<CBenchHash> > Tables(TableNum);
+    double Time;
+
+    Res.m_Check = 0;
+
+    // insertion (lookup followed by insertion at the lookup position, as
+    // in the lexicon)
+
+    size_t BaseBytes = s_CurBytes;
+    s_PeakBytes = s_CurBytes;
+
+    Time = NowNs();
+    for(unsigned int t = 0 ; t < TableNum ; t++) {
+        Tables[t] = new CBenchHash(InitSize);
+        SetResizeMode(Tables[t].Ptr(), bIncremental);
+        for(unsigned int k = Start[t] ; k < Start[t+1] ; k++) {
+            if(!(*Tables[t])[*Keys[k]].Found())
+                *Tables[t] = new CBenchVal();
+        }
+    }
+    Res.m_Insert = (NowNs() - Time) / KeyNum;
+    Res.m_Mem = (double)(s_CurBytes - BaseBytes) / TableNum;
+    Res.m_PeakMem = (double)(s_PeakBytes - BaseBytes) / TableNum;
+
+    // successful lookups
+
+    Time = NowNs();
+    for(unsigned int i = 0 ; i < Lookups.size() ; i++) {
+        unsigned int t = i % TableNum;
+        unsigned int Size = Start[t+1] - Start[t];
+        CBenchVal* pVal =
+            (*Tables[t])[*Keys[Start[t] + Lookups[i] % Size]];
+        if(pVal) {
+            pVal->m_Count++;
+            Res.m_Check++;
+        }
+    }
+    Res.m_Hit = (NowNs() - Time) / Lookups.size();
+
+    // successful stateless lookups
+
+    Time = NowNs();
+    for(unsigned int i = 0 ; i < Lookups.size() ; i++) {
+        unsigned int t = i % TableNum;
+        unsigned int Size = Start[t+1] - Start[t];
+        if(Tables[t]->Find(*Keys[Start[t] + Lookups[i] % Size]).Found())
+            Res.m_Check++;
+    }
+    Res.m_Find = (NowNs() - Time) / Lookups.size();
+
+    // unsuccessful (passive) lookups
+
+    Time = NowNs();
+    for(unsigned int i = 0 ; i < Lookups.size() ; i++) {
+        if(Tables[i % TableNum]->Val(*Missing[(i * 7919) % Missing.size()]))
+            Res.m_Check++;
+    }
+    Res.m_Miss = (NowNs() - Time) / Lookups.size();
+
+    // iteration
+
+    Time = NowNs();
+    for(unsigned int t = 0 ; t < TableNum ; t++) {
+        for(CPtr<CBenchIter> pIter = Tables[t]->Begin() ; *pIter ;
+            ++(*pIter))
+            Res.m_Check += pIter->GetVal()->m_Count;
+    }
+    Res.m_Iter = (NowNs() - Time) / KeyNum;
+
+    // deletion
+
+    Time = NowNs();
+    for(unsigned int t = 0 ; t < TableNum ; t++) {
+        for(unsigned int k = Start[t] ; k < Start[t+1] ; k++)
+            Tables[t]->Delete(*Keys[k]);
+    }
+    Res.m_Delete = (NowNs() - Time) / KeyNum;
+
+    for(unsigned int t = 0 ; t < TableNum ; t++)
+        Res.m_Check += Tables[t]->NumElements();
+
+    Tables.clear();
+
+    // worst case insertion (measured separately, as timing every
+    // insertion slows the insertion down)
+
+    Res.m_Worst = 0;
+
+    for(unsigned int t = 0 ; t < TableNum ; t++) {
+        CPtr<CBenchHash> pHash = new CBenchHash(InitSize);
+        SetResizeMode(pHash.Ptr(), bIncremental);
+        for(unsigned int k = Start[t] ; k < Start[t+1] ; k++) {
+            Time = NowNs();
+            if(!(*pHash)[*Keys[k]].Found())
+                *pHash = new CBenchVal();
+            Time = NowNs() - Time;
+            if(Time > Res.m_Worst)
+                Res.m_Worst = Time;
+        }
+    }
+}
+
+// Run the benchmark for the given implementation in a separate process
+// and print the results
+
+template <class B>
+static void
+BenchLine(char const* Name, vector<CpCStrKey>& Keys,
+          vector<CpCStrKey>& Missing, vector<unsigned int>& Start,
+          vector<unsigned int>& Lookups, unsigned int InitSize,
+          bool bIncremental = false)
+{
+    fflush(stdout);
+
+    pid_t Pid = fork();
+
+    if(Pid > 0) {
+        int Status;
+        waitpid(Pid, &Status, 0);
+        return;
+    }
+
+    // the child process (or the process itself if fork() failed)
+
+    SBenchResult Res;
+
+    RunBench<B>(Res, Keys, Missing, Start, Lookups, InitSize, bIncremental);
+
+    printf("%-22s %7.1f %9.0f %7.1f %7.1f %7.1f %7.1f %7.1f %12.0f %12.0f"
+           "  (check %lu)\n", Name, Res.m_Insert, Res.m_Worst, Res.m_Hit,
+           Res.m_Find, Res.m_Miss, Res.m_Iter, Res.m_Delete, Res.m_Mem,
+           Res.m_PeakMem, Res.m_Check);
+
+    if(!Pid) {
+        fflush(stdout);
+        _exit(0);
+    }
+}
+
+// Run all implementations on the given tables
+
+static void
+BenchAll(vector<CpCStrKey>& Keys, vector<CpCStrKey>& Missing,
+         vector<unsigned int>& Start, vector<unsigned int>& Lookups,
+         unsigned int InitSize)
+{
+    printf("%-22s %7s %9s %7s %7s %7s %7s %7s %12s %12s\n", "(ns/op, bytes)",
+           "insert", "worst", "hit", "find", "miss", "iter", "delete",
+           "memory", "peak");
+
+    BenchLine<CHashBase>("chaining", Keys, Missing, Start, Lookups,
+                         InitSize);
+    BenchLine<COpenHashBase>("open addressing", Keys, Missing, Start,
+                             Lookups, InitSize);
+    BenchLine<COpenHashBase>("open (incremental)", Keys, Missing, Start,
+                             Lookups, InitSize, true);
+    BenchLine<COpenHashTable<CStrKey, CBenchVal> >("typed open addressing",
+                                                   Keys, Missing, Start,
+                                                   Lookups, InitSize);
+    BenchLine<COpenHashTable<CStrKey, CBenchVal> >("typed (incremental)",
+                                                   Keys, Missing, Start,
+                                                   Lookups, InitSize, true);
+}
+
+int
+main(int ac, char** av)
+{
+    unsigned int KeyNum = ac > 1 ? atoi(av[1]) : 1000000;
+    unsigned int LookupNum = ac > 2 ? atoi(av[2]) : 4000000;
+    unsigned int TableNum = ac > 3 ? atoi(av[3]) : 20000;
+    vector<CpCStrKey> Keys;
+    vector<CpCStrKey> Missing;
+    vector<unsigned int> Start;
+    vector<unsigned int> Lookups;
+
+    if(!KeyNum)
+        KeyNum = 1;
+    if(!LookupNum)
+        LookupNum = 1;
+    if(!TableNum)
+        TableNum = 1;
+
+    // lexicon sized table
+
+    MakeKeys(Keys, KeyNum, "");
+    MakeKeys(Missing, KeyNum, "_");
+    MakeZipfIndices(Lookups, KeyNum, LookupNum, 5);
+    Start.push_back(0);
+    Start.push_back(KeyNum);
+
+    printf("Lexicon sized table: %u keys, %u Zipfian lookups\n\n",
+           KeyNum, LookupNum);
+
+    BenchAll(Keys, Missing, Start, Lookups, 16);
+
+    // label table sized tables (10-16 keys each)
+
+    Start.clear();
+    Start.push_back(0);
+    for(unsigned int t = 0 ; t < TableNum ; t++)
+        Start.push_back(Start.back() + 10 + t % 7);
+
+    MakeKeys(Keys, Start.back(), "");
+    MakeKeys(Missing, TableNum, "_");
+    MakeZipfIndices(Lookups, 16, LookupNum, 7);
+
+    printf("\nLabel table sized tables: %u tables of 10-16 keys, "
+           "%u Zipfian lookups\n\n", TableNum, LookupNum);
+
+    BenchAll(Keys, Missing, Start, Lookups, 16);
+
+    return 0;
+}
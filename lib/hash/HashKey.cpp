@@ -15,31 +15,200 @@
 // along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <typeinfo>
+#include <string.h>
 #include "HashKey.h"
 
+//
+// String hash function
+//
+
+// This is a word-at-a-time multiply-mix hash (in the style of wyhash).
+// The string is read 8 bytes at a time and each pair of words is mixed
+// into the state by a full 64x64->128 bit multiplication (folded back to
+// 64 bits). Short strings (which are most of the words in the lexicon)
+// are handled by at most two overlapping reads.
+
+typedef unsigned long long tHashWord;
+
+// arbitrary odd constants with well distributed bits
+static const tHashWord HashSecret0 = 0xa0761d6478bd642fULL;
+static const tHashWord HashSecret1 = 0xe7037ed1a0b428dbULL;
+static const tHashWord HashSecret2 = 0x8ebc6af09c88c6e3ULL;
+
+static inline tHashWord
+HashMix(tHashWord A, tHashWord B)
+{
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 R = A;
+    R *= B;
+    return (tHashWord)(R >> 64) ^ (tHashWord)R;
+#else
+    // 64x64->128 bit multiplication from 32 bit halves
+    tHashWord AH = A >> 32, AL = (unsigned int)A;
+    tHashWord BH = B >> 32, BL = (unsigned int)B;
+    tHashWord LL = AL * BL, LH = AL * BH, HL = AH * BL, HH = AH * BH;
+    tHashWord Mid = (LL >> 32) + (unsigned int)LH + (unsigned int)HL;
+    tHashWord Lo = (Mid << 32) | (unsigned int)LL;
+    tHashWord Hi = HH + (LH >> 32) + (HL >> 32) + (Mid >> 32);
+    return Hi ^ Lo;
+#endif
+}
+
+static inline tHashWord
+Read8(unsigned char const* p)
+{
+    tHashWord W;
+    memcpy(&W, p, sizeof(W));
+    return W;
+}
+
+static inline tHashWord
+Read4(unsigned char const* p)
+{
+    unsigned int W;
+    memcpy(&W, p, sizeof(W));
+    return W;
+}
+
+// ASCII lower case conversion of all bytes of a word (as tolower() in
+// the "C" locale). Bytes which are not upper case letters (including all
+// bytes above 0x7f) are not changed.
+
+#define HASH_BYTES(b) (0x0101010101010101ULL * (b))
+
+static inline tHashWord
+FoldWord(tHashWord W)
+{
+    tHashWord Low = W & HASH_BYTES(0x7f);
+    // high bit of each byte is set if the byte is >= 'A' or > 'Z'
+    tHashWord GeA = Low + HASH_BYTES(0x80 - 'A');
+    tHashWord GtZ = Low + HASH_BYTES(0x7f - 'Z');
+    tHashWord Upper = (GeA ^ GtZ) & ~W & HASH_BYTES(0x80);
+
+    return W | (Upper >> 2); // 0x80 >> 2 = 'a' - 'A'
+}
+
+static inline tHashWord
+FoldByte(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+// The hash function. If bFold is true, the hash value is calculated
+// for the lower case version of the string.
+
+template <bool bFold>
+static inline unsigned int
+StrHashImpl(char const* pStr, unsigned int Len)
+{
+    unsigned char const* p = (unsigned char const*)pStr;
+    tHashWord Seed = HashSecret0 ^ Len;
+    tHashWord A, B;
+    unsigned int Left = Len;
+
+    if(Left <= 16) {
+        if(Left >= 4) {
+            A = (Read4(p) << 32) | Read4(p + ((Left >> 3) << 2));
+            B = (Read4(p + Left - 4) << 32) |
+                Read4(p + Left - 4 - ((Left >> 3) << 2));
+            if(bFold) {
+                A = FoldWord(A);
+                B = FoldWord(B);
+            }
+        } else if(Left > 0) {
+            if(bFold)
+                A = (FoldByte(p[0]) << 16) | (FoldByte(p[Left >> 1]) << 8) |
+                    FoldByte(p[Left - 1]);
+            else
+                A = ((tHashWord)p[0] << 16) | ((tHashWord)p[Left >> 1] << 8) |
+                    p[Left - 1];
+            B = 0;
+        } else
+            A = B = 0;
+    } else {
+        while(Left > 16) {
+            tHashWord W0 = Read8(p), W1 = Read8(p + 8);
+            if(bFold) {
+                W0 = FoldWord(W0);
+                W1 = FoldWord(W1);
+            }
+            Seed = HashMix(W0 ^ HashSecret1, W1 ^ Seed);
+            p += 16;
+            Left -= 16;
+        }
+        // last 16 bytes (may overlap with bytes already read)
+        A = Read8(p + Left - 16);
+        B = Read8(p + Left - 8);
+        if(bFold) {
+            A = FoldWord(A);
+            B = FoldWord(B);
+        }
+    }
+
+    tHashWord H = HashMix(HashSecret1 ^ Len,
+                          HashMix(A ^ HashSecret1, B ^ Seed ^ HashSecret2));
+
+    return (unsigned int)(H ^ (H >> 32));
+}
+
 unsigned int
-CStrKey::HashFunc()
+CStrKey::StrHash(char const* pStr, unsigned int Len)
 {
-    unsigned int h;
-    const char* str = m_Str.c_str();
-    
-    for(h =0 ; str && *str ; str++)
-        h = ((h >> 3) ^ (h << 5)) + *str;
+    return StrHashImpl<false>(pStr, Len);
+}
+
+unsigned int
+CStrKey::StrHashLower(char const* pStr, unsigned int Len)
+{
+    return StrHashImpl<true>(pStr, Len);
+}
+
+bool
+CStrKey::EqualLower(char const* pStr, unsigned int Len)
+{
+    if(m_Len != Len)
+        return false;
+
+    char const* pKeyStr = m_pStr;
     
-    return h;
+    for(unsigned int i = 0 ; i < Len ; i++)
+        if((char)FoldByte(pStr[i]) != pKeyStr[i])
+            return false;
+
+    return true;
 }
 
+// It is assumed that pKey is a string key (see CKey). The cheap checks
+// (hash value and length) are made before the strings are compared.
+
 bool
 CStrKey::HashEqual(CKey* pKey)
 {
-    if(!pKey || (typeid(*pKey) != typeid(*this)))
+    if(!pKey)
+        return false;
+
+#ifdef DEBUG
+    if(typeid(*pKey) != typeid(*this))
         return false;
+#endif
     
-    return (bool)!(m_Str.compare(((CStrKey*)pKey)->m_Str.c_str()));
+    return Equal(*(CStrKey*)pKey);
 }
 
 bool
 CStrKey::operator==(CStrKey& StrKey)
 {
-    return (bool)!(m_Str.compare(StrKey.m_Str.c_str()));
+    return Equal(StrKey);
+}
+
+int
+CStrKey::Compare(CStrKey& Key)
+{
+    int Cmp = memcmp(m_pStr, Key.m_pStr,
+                     m_Len < Key.m_Len ? m_Len : Key.m_Len);
+
+    if(Cmp)
+        return Cmp;
+
+    return m_Len < Key.m_Len ? -1 : (m_Len > Key.m_Len ? 1 : 0);
 }
@@ -0,0 +1,210 @@
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <string.h>
+#include "Intern.h"
+
+using namespace std;
+
+#define INTERN_INITIAL_SIZE 4096
+
+// These are created on first use (and are never destroyed), so strings
+// may be interned during static initialization.
+
+CInternHash* CInternTable::m_pHash = NULL;
+vector<CStrKey*>* CInternTable::m_pKeys = NULL;
+CStrArena* CInternTable::m_pArena = NULL;
+vector<unsigned int>* CInternTable::m_pFreeIds = NULL;
+vector<bool>* CInternTable::m_pMarks = NULL;
+// (the mutex needs no dynamic initialization, so it may also be used
+// during static initialization)
+CMutex CInternTable::m_Mutex;
+
+// Number of references the table itself holds to an interned key (as the
+// key and as the value of its entry). A key with no other references is
+// used by nothing but the table (see EndCollect()).
+#define INTERN_TABLE_REFS 2
+
+unsigned int
+CInternTable::Insert(CStrKey& Key)
+{
+    CMutexLock Lock(m_Mutex);
+
+    return InsertLocked(Key);
+}
+
+unsigned int
+CInternTable::InsertLocked(CStrKey& Key)
+{
+    if(!m_pHash) {
+        m_pHash = new CInternHash(INTERN_INITIAL_SIZE);
+        m_pHash->Ref();
+        m_pKeys = new vector<CStrKey*>(1, (CStrKey*)NULL); // no ID 0
+        m_pArena = new CStrArena();
+        m_pFreeIds = new vector<unsigned int>();
+    }
+
+    CInternPos Pos = m_pHash->FindOrInsert(Key);
+
+    // if the string was already interned (under another key), the ID of
+    // that key is returned (this key is not interned)
+    if(Pos.Val())
+        return Pos.Val()->m_Id;
+
+    m_pHash->SetVal(Pos, &Key);
+
+    unsigned int Id;
+
+    if(m_pFreeIds->empty()) {
+        Id = m_pKeys->size();
+        m_pKeys->push_back(&Key);
+    } else {
+        // reuse the ID of a released string
+        Id = m_pFreeIds->back();
+        m_pFreeIds->pop_back();
+        (*m_pKeys)[Id] = &Key;
+    }
+    
+    Key.SetInterned(m_pArena->Add(Key.m_pStr, Key.m_Len), Id);
+
+    return Id;
+}
+
+// Matches the interned key of a given string (see
+// COpenHashTable::FindMatch()), so that a string can be looked up without
+// creating a key for it.
+
+class CInternStrMatch
+{
+private:
+    char const* m_pStr;
+    unsigned int m_Len;
+public:
+    CInternStrMatch(char const* pStr, unsigned int Len) :
+            m_pStr(pStr), m_Len(Len) {}
+    bool operator()(CStrKey* pKey) {
+        return pKey->Length() == m_Len &&
+            !memcmp(pKey->GetStr(), m_pStr, m_Len);
+    }
+};
+
+CStrKey*
+CInternTable::Find(char const* pStr, unsigned int Len)
+{
+    CMutexLock Lock(m_Mutex);
+
+    return FindLocked(pStr, Len);
+}
+
+CStrKey*
+CInternTable::FindLocked(char const* pStr, unsigned int Len)
+{
+    if(!m_pHash)
+        return NULL;
+    
+    CInternStrMatch Match(pStr, Len);
+
+    return m_pHash->FindMatch(Match, CStrKey::StrHash(pStr, Len)).Val();
+}
+
+unsigned int
+CInternTable::Intern(char const* pStr, unsigned int Len)
+{
+    CMutexLock Lock(m_Mutex);
+    
+    CStrKey* pKey = FindLocked(pStr, Len);
+
+    if(pKey)
+        return pKey->m_Id;
+
+    return InsertLocked(*(new CStrKey(pStr, Len)));
+}
+
+//
+// Collection
+//
+
+void
+CInternTable::BeginCollect()
+{
+    CMutexLock Lock(m_Mutex);
+    
+    if(!m_pKeys)
+        return; // nothing interned
+
+    delete m_pMarks;
+    m_pMarks = new vector<bool>(m_pKeys->size(), false);
+}
+
+unsigned int
+CInternTable::EndCollect()
+{
+    CMutexLock Lock(m_Mutex);
+    
+    if(!m_pMarks)
+        return 0;
+
+    unsigned int Released = 0;
+
+    for(unsigned int Id = 1 ; Id < m_pKeys->size() ; Id++) {
+        CStrKey* pKey = (*m_pKeys)[Id];
+        if(pKey && !(*m_pMarks)[Id] && pKey->RefCount() <= INTERN_TABLE_REFS) {
+            (*m_pKeys)[Id] = NULL;
+            Released++;
+        }
+    }
+
+    delete m_pMarks;
+    m_pMarks = NULL;
+    
+    if(!Released)
+        return 0;
+
+    // The IDs at the end are removed. The other free IDs are stored in
+    // decreasing order, so that the lowest is assigned first.
+
+    while(m_pKeys->size() > 1 && !m_pKeys->back())
+        m_pKeys->pop_back();
+
+    m_pFreeIds->clear();
+    for(unsigned int Id = m_pKeys->size() - 1 ; Id > 0 ; Id--)
+        if(!(*m_pKeys)[Id])
+            m_pFreeIds->push_back(Id);
+    
+    // Rebuild the table and the arena with the remaining keys only. The
+    // keys released are destroyed together with the old table (their
+    // characters are in the old arena, so they are not freed by the keys).
+
+    CInternHash* pHash = new CInternHash(INTERN_INITIAL_SIZE);
+    pHash->Ref();
+    CStrArena* pArena = new CStrArena();
+    
+    for(unsigned int Id = 1 ; Id < m_pKeys->size() ; Id++) {
+        CStrKey* pKey = (*m_pKeys)[Id];
+        if(!pKey)
+            continue;
+        pKey->SetInterned(pArena->Add(pKey->m_pStr, pKey->m_Len), Id);
+        pHash->SetVal(pHash->FindOrInsert(*pKey), pKey);
+    }
+
+    if(m_pHash->UnRef() <= 0)
+        delete m_pHash;
+    m_pHash = pHash;
+    delete m_pArena;
+    m_pArena = pArena;
+    
+    return Released;
+}
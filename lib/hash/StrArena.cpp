@@ -0,0 +1,62 @@
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <string.h>
+#include "ObjStats.h"
+#include "StrArena.h"
+
+using namespace std;
+
+CStrArena::CStrArena() :
+        m_pNext(NULL), m_pEnd(NULL), m_StrBytes(0), m_ChunkBytes(0)
+{
+}
+
+CStrArena::~CStrArena()
+{
+    for(vector<pair<char*, size_t> >::iterator Iter = m_Chunks.begin() ;
+        Iter != m_Chunks.end() ; Iter++) {
+        CObjStats::Remove(eOSStrArena, Iter->second);
+        delete[] Iter->first;
+    }
+}
+
+char const*
+CStrArena::Add(char const* pStr, unsigned int Len)
+{
+    size_t Size = (size_t)Len + 1;
+
+    if((size_t)(m_pEnd - m_pNext) < Size) {
+        // the rest of the last chunk is wasted (it is at most the length
+        // of a single string)
+        size_t ChunkSize =
+            Size > STR_ARENA_CHUNK_SIZE ? Size : STR_ARENA_CHUNK_SIZE;
+        m_pNext = new char[ChunkSize];
+        m_pEnd = m_pNext + ChunkSize;
+        m_Chunks.push_back(make_pair(m_pNext, ChunkSize));
+        m_ChunkBytes += ChunkSize;
+        CObjStats::Add(eOSStrArena, ChunkSize);
+    }
+
+    char* pCopy = m_pNext;
+
+    memcpy(pCopy, pStr, Len);
+    pCopy[Len] = 0;
+    m_pNext += Size;
+    m_StrBytes += Size;
+
+    return pCopy;
+}
@@ -26,7 +26,9 @@ CLoop::CLoop(vector<string> const & InFilePatterns, CCmdArgOpts* pArgs,
              CpCMessageLine& MsgLine, COutFile* pOutFile) :
         m_Args(pArgs), m_MsgLine(MsgLine),
         m_InFiles(InFilePatterns), m_pOutFile(pOutFile),
-        m_Error(false), m_ErrorStr(""), m_ObjNum(0), m_bCountOnly(false)
+        m_Error(false), m_ErrorStr(""), m_ObjNum(0), m_LineNum(0),
+        m_bCountOnly(false), m_ObjsProcessed(0), m_pCheckpointer(NULL),
+        m_bResume(false)
 {
 #ifdef DETAILED_DEBUG
     IncObjCount();
@@ -37,7 +39,8 @@ CLoop::CLoop(vector<string> const & InFilePatterns, CCmdArgOpts* pArgs,
              COutFile* pOutFile) :
         m_Args(pArgs), m_MsgLine(NULL), m_InFiles(InFilePatterns),
         m_pOutFile(pOutFile), m_Error(false), m_ErrorStr(""),
-        m_ObjNum(0), m_bCountOnly(false)
+        m_ObjNum(0), m_LineNum(0), m_bCountOnly(false), m_ObjsProcessed(0),
+        m_pCheckpointer(NULL), m_bResume(false)
 {
 #ifdef DETAILED_DEBUG
     IncObjCount();
@@ -62,11 +65,20 @@ CLoop::ResetLoop()
 bool
 CLoop::DoLoop()
 {
-    unsigned int LineNum = 0;
-    
     m_ObjNum = 1;
-    
-    if(!m_InFiles.Good()) {
+    m_LineNum = 0;
+
+    if(m_bResume) {
+        // continue from the given position
+        m_bResume = false;
+        if(!m_InFiles.SetPos(m_ResumePos.m_FileNum, m_ResumePos.m_Offset)) {
+            m_ErrorStr = "Failed to resume reading the input files";
+            return !(m_Error = true);
+        }
+        m_ObjNum = m_ResumePos.m_ObjNum;
+        m_LineNum = m_ResumePos.m_LineNum;
+        m_ObjsProcessed = m_ResumePos.m_ObjsProcessed;
+    } else if(!m_InFiles.Good()) {
         m_ErrorStr = m_InFiles.Eof() ? 
             "At end of file (no files or must be restarted?)" :
             m_ErrorStr = "Problem while opening/reading from file";
@@ -74,21 +86,26 @@ CLoop::DoLoop()
     }
 
     while(m_InFiles.Good()) {
+
+        // (this can only happen when resuming after the last object)
+        if(m_Args->GetLastObjToProcess() &&
+           m_ObjNum > m_Args->GetLastObjToProcess())
+            break;
         
         if(!m_InFiles.GetLine())
             break;
 
-        LineNum++;
+        m_LineNum++;
         
         if(!NextLine(m_InFiles.LastLine())) {
             
             ostringstream Ostr(ios::out);
             if(m_ErrorStr.length())
                 Ostr << endl << "In object " << m_ObjNum << "(line "
-                     << LineNum << ")";
+                     << m_LineNum << ")";
             else
-                Ostr << "In object " << m_ObjNum << "(line " << LineNum << ")"
-                     << ": error while processing";
+                Ostr << "In object " << m_ObjNum << "(line " << m_LineNum
+                     << ")" << ": error while processing";
             m_ErrorStr.append(Ostr.str());
             return !(m_Error = true);
         }
@@ -113,6 +130,16 @@ CLoop::DoLoop()
                     if(m_MsgLine)
                         m_MsgLine->AppendMessage(Ostr.str());
                 }
+                
+                if(m_pCheckpointer && !CountOnly()) {
+                    SLoopPos Pos;
+                    if(!GetPos(Pos)) {
+                        m_ErrorStr = "Failed to determine the input position";
+                        return !(m_Error = true);
+                    }
+                    if(!m_pCheckpointer->ObjectDone(this, Pos))
+                        return !(m_Error = true);
+                }
             }
         }
     }
@@ -141,6 +168,16 @@ CLoop::DoLoop()
 }
 
 
+bool
+CLoop::GetPos(SLoopPos& Pos)
+{
+    Pos.m_ObjNum = m_ObjNum;
+    Pos.m_LineNum = m_LineNum;
+    Pos.m_ObjsProcessed = m_ObjsProcessed;
+    
+    return m_InFiles.GetPos(Pos.m_FileNum, Pos.m_Offset);
+}
+
 ////////////////////////////
 // Loop printing routines //
 ////////////////////////////
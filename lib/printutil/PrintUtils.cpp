@@ -37,6 +37,8 @@ static struct SPrintingModeNames {
     "source_text", PMODE_SOURCE_TEXT,
     "extra_eval", PMODE_EXTRA_EVAL,
     "config", PMODE_CONFIG,
+    "alloc_count", PMODE_ALLOC_COUNT,
+    "mem_count", PMODE_MEM_COUNT,
     "", 0
 };
 
@@ -17,122 +17,65 @@
 #include "yError.h"
 #include "Strength.h"
 
-// pushes the entry at position Pos up until only entries with strictly
-// higher strengths are above it in the list
-
-int
-CTopBase::PushUp(unsigned int Pos, unsigned int PropNum)
+CTopBase::CTopBase(CTopBase const& Top) :
+        m_Strgs(Top.m_Strgs), m_Keys(Top.m_Keys), m_Props(Top.m_Props),
+        m_MaxEntries(Top.m_MaxEntries), m_NextEntry(Top.m_NextEntry)
 {
-    static char Rname[] = "CTopBase::PushUp";
-    
-    if(Pos >= m_NextEntry) {
-        // should not happen
-        yPError(ERR_OUT_OF_RANGE, "position not in table");
+    for(unsigned int Pos = 0 ; Pos < m_NextEntry ; Pos++) {
+        if(m_Props[Pos])
+            m_Props[Pos]->Ref();
+        CObjStats::Add(eOSTopEntry, TOP_ENTRY_BYTES);
     }
-    
-    if(!Pos || m_Entries[Pos].m_Strg < m_Entries[Pos-1].m_Strg)
-        return Pos; // nothing to do
-    
-    unsigned int NewPos = Pos;
-    CTopEntry PosEntry(m_Entries[Pos]);
-
-    do {
-        // move the entry down
-        m_Entries[NewPos] = m_Entries[NewPos-1];
-        if(m_Entries[NewPos].m_Props)
-            (*(m_Entries[NewPos].m_Props))[PropNum] = Pos2Strg(NewPos);
-        NewPos--;
-    } while(NewPos > 0 && m_Entries[NewPos-1].m_Strg <= PosEntry.m_Strg);
-
-    if(PosEntry.m_Props)
-        (*(PosEntry.m_Props))[PropNum] = Pos2Strg(NewPos);
-    m_Entries[NewPos] = PosEntry;
-    return NewPos;
 }
 
-// Add the given entry to the top list.
-
-int
-CTopBase::Add(float Strg, CRef* pData, CRvector<float>* pProps,
-              unsigned int PropNum)
+CTopBase&
+CTopBase::operator=(CTopBase const& Top)
 {
-    if(m_MaxEntries > m_NextEntry) {
-        m_NextEntry++;
-        if(m_Entries.size() < m_NextEntry)
-            m_Entries.resize(m_NextEntry);
-    }
+    if(&Top == this)
+        return *this;
 
-    if(!m_NextEntry)
-        return -1; // top list length is 0
-    
-    CTopEntry& Last = m_Entries[m_NextEntry-1];
-    
-    if(Strg < Last.m_Strg)
-        return -1; // list is full
+    Clear();
     
-    // If an entry with a property vector is being replaced, update its
-    // property vector
-    if(Last.m_Props)
-        (*(Last.m_Props))[PropNum] = Last.m_Strg;
-
-    // replace (or initialize) the last entry
-
-    Last.m_Strg = Strg;
-    Last.m_Data = pData;
-    Last.m_Props = pProps;
-    if(pProps)
-        (*(Last.m_Props))[PropNum] = Pos2Strg(m_NextEntry-1);
+    m_MaxEntries = Top.m_MaxEntries;
+    m_Strgs = Top.m_Strgs;
+    m_Keys = Top.m_Keys;
+    m_Props = Top.m_Props;
+    m_NextEntry = Top.m_NextEntry;
     
-    // Reorder the entries, if needed.
+    for(unsigned int Pos = 0 ; Pos < m_NextEntry ; Pos++) {
+        if(m_Props[Pos])
+            m_Props[Pos]->Ref();
+        CObjStats::Add(eOSTopEntry, TOP_ENTRY_BYTES);
+    }
 
-    return PushUp(m_NextEntry-1, PropNum);
+    return *this;
 }
 
-int
-CTopBase::Inc(unsigned int Pos, float Strg, unsigned int PropNum)
+void
+CTopBase::Truncate(unsigned int EntryNum)
 {
-    static char Rname[] = "CTopBase::Inc(unsigned int Pos, float Strg)";
-    
-    if(Pos >= m_NextEntry) {
-        // should not happen
-        yPError(ERR_OUT_OF_RANGE, "position requested is out of range");
+    while(m_NextEntry > EntryNum) {
+        SetEntry(m_NextEntry-1, 0, NULL);
+        m_NextEntry--;
+        CObjStats::Remove(eOSTopEntry, TOP_ENTRY_BYTES);
     }
 
-    if(Strg < 0) {
-        yPError(ERR_OUT_OF_RANGE, "negative strength increment");
-    }
-    
-    m_Entries[Pos].m_Strg += Strg;
-
-    // Reorder the entries, if needed
-    return PushUp(Pos, PropNum);
+    m_Strgs.resize(m_NextEntry);
+    m_Keys.resize(m_NextEntry);
+    m_Props.resize(m_NextEntry);
 }
 
 void
-CTopBase::Clear()
+CTopBase::SetEntry(unsigned int Pos, unsigned int Key, CRef* pProps)
 {
-    m_Entries.clear();
-    m_NextEntry = 0;
-}
-
-/////////////////////////
-// Auxiliary Functions //
-/////////////////////////
-
-int
-GetTopListPosFromVec(CRvector<float>* pVec, unsigned int Prop)
-{
-    if(!pVec || Prop >= pVec->size())
-        return -1;
-    if((*pVec)[Prop] < 0)
-        return CTopBase::Strg2Pos((*pVec)[Prop]);
-    return -1;
-}
+    // add the new reference before releasing the old one (in case
+    // these are the same object)
+    if(pProps)
+        pProps->Ref();
 
-// Is the entry in the top list for the given property ?
+    if(m_Props[Pos] && m_Props[Pos]->UnRef() <= 0)
+        delete m_Props[Pos];
 
-bool
-IsInTheTopList(CRvector<float>* pVec, unsigned int Prop) {
-    return (GetTopListPosFromVec(pVec, Prop) >= 0);
+    m_Keys[Pos] = Key;
+    m_Props[Pos] = pProps;
 }
-
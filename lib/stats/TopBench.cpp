@@ -0,0 +1,213 @@
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+//
+// Top strength list benchmark. This measures the top lists of the strength
+// tables (CTop<> in Strength.h), which hold the strongest labels of the
+// statistics and label tables. This is not part of the parser. It is built
+// by 'make bench' (in the top directory) and run as:
+//
+// topbench [<number of tables> [<number of updates>]]
+//
+// <number of tables> strength tables (default 20000) are created, each
+// with a single top list of 10 entries (as the statistics tables) and
+// 32 candidate entries. The following are measured (in nanoseconds per
+// operation):
+//
+// update: incrementing the strength of an entry (drawn from a Zipfian
+//         distribution) by a small random amount, through
+//         CStrengths::IncStrength() without a hash table lookup. This
+//         exercises Add(), Inc() and PushUp() of the top list.
+//         <number of updates> (default 10000000) updates are made,
+//         spread evenly over the tables.
+// iter:   iterating over all top list entries, reading the strength,
+//         data and value of each entry (per entry, including the creation
+//         of the iterator).
+// scan:   the same, but only reading the strength of each entry.
+// copy:   copying a top list (per entry).
+//
+// The 'check' value printed allows comparing the results of different
+// implementations.
+//
+
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "Strength.h"
+
+using namespace std;
+
+// global defined by the parser (in main/Globals.cpp) and needed by the
+// utility library (error printing)
+string g_CommentStr = "#";
+
+// number of entries in each top list
+#define BENCH_TOP_LENGTH 10
+// number of candidate entries for each table
+#define BENCH_CANDIDATES 32
+
+// current time in nanoseconds
+
+static double
+NowNs()
+{
+    struct timespec Time;
+
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    return Time.tv_sec * 1e9 + Time.tv_nsec;
+}
+
+// Simple pseudo random number generator (as in hashbench)
+
+class CBenchRand
+{
+private:
+    unsigned long long m_State;
+public:
+    CBenchRand(unsigned long long Seed) : m_State(Seed) {}
+    unsigned int Next() {
+        m_State = m_State * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (unsigned int)(m_State >> 33);
+    }
+    // uniform in [0,1)
+    double NextDouble() {
+        return Next() / 2147483648.0;
+    }
+};
+
+// The keys of the tables (identified by the candidate number plus 1, as
+// 0 is the null key).
+
+class CBenchKey
+{
+private:
+    unsigned int m_Id;
+public:
+    explicit CBenchKey(unsigned int Id) : m_Id(Id) {}
+    unsigned int GetPacked() const { return m_Id; }
+};
+
+typedef CRvector<float> CBenchVal;
+typedef CStrengths<CBenchKey, CBenchVal> CBenchTable;
+typedef CTopIter<CBenchKey, CBenchVal> CBenchIter;
+
+int
+main(int ac, char** av)
+{
+    unsigned int TableNum = ac > 1 ? atoi(av[1]) : 20000;
+    unsigned int UpdateNum = ac > 2 ? atoi(av[2]) : 10000000;
+
+    if(!TableNum || !UpdateNum) {
+        fprintf(stderr, "usage: %s [<number of tables> "
+                "[<number of updates>]]\n", av[0]);
+        return 1;
+    }
+
+    // the candidate entries (values) of each table
+
+    vector<CBenchTable*> Tables(TableNum);
+    vector<CPtr<CBenchVal> > Vals((size_t)TableNum * BENCH_CANDIDATES);
+
+    for(unsigned int t = 0 ; t < TableNum ; t++) {
+        Tables[t] = new CBenchTable(1, BENCH_TOP_LENGTH, false);
+        for(unsigned int k = 0 ; k < BENCH_CANDIDATES ; k++)
+            Vals[t * BENCH_CANDIDATES + k] = new CBenchVal(1);
+    }
+
+    // the updates (the candidate, drawn from a Zipfian distribution, and
+    // the increment)
+
+    vector<double> Cumulative(BENCH_CANDIDATES);
+    vector<unsigned char> Candidates(UpdateNum);
+    vector<unsigned char> Incs(UpdateNum);
+    CBenchRand Rand(17);
+    double Sum = 0;
+
+    for(unsigned int r = 0 ; r < BENCH_CANDIDATES ; r++)
+        Cumulative[r] = (Sum += 1.0 / (r + 1));
+
+    for(unsigned int i = 0 ; i < UpdateNum ; i++) {
+        unsigned int r = lower_bound(Cumulative.begin(), Cumulative.end(),
+                                     Rand.NextDouble() * Sum) -
+            Cumulative.begin();
+        Candidates[i] = r < BENCH_CANDIDATES ? r : BENCH_CANDIDATES - 1;
+        Incs[i] = 1 + Rand.Next() % 4;
+    }
+
+    printf("%u tables, top lists of %u entries, %u candidates, "
+           "%u updates\n\n", TableNum, BENCH_TOP_LENGTH, BENCH_CANDIDATES,
+           UpdateNum);
+
+    unsigned long Check = 0;
+    unsigned long EntryNum = 0;
+    double Time;
+
+    // update
+
+    Time = NowNs();
+    for(unsigned int i = 0 ; i < UpdateNum ; i++) {
+        unsigned int t = i % TableNum;
+        unsigned int k = Candidates[i];
+        Tables[t]->IncStrength(CBenchKey(k + 1),
+                               (CBenchVal*)Vals[t * BENCH_CANDIDATES + k], 0,
+                               (float)Incs[i]);
+    }
+    printf("%-8s %8.1f ns/update\n", "update", (NowNs() - Time) / UpdateNum);
+
+    for(unsigned int t = 0 ; t < TableNum ; t++)
+        EntryNum += Tables[t]->GetTopLength(0);
+
+    // iteration (strength, data and value)
+
+    Time = NowNs();
+    for(unsigned int t = 0 ; t < TableNum ; t++) {
+        for(CPtr<CBenchIter> pIter = Tables[t]->GetIter(0) ; *pIter ;
+            ++(*pIter))
+            Check += (unsigned long)pIter->Strg() +
+                pIter->Data().GetPacked() + pIter->Val()->size();
+    }
+    printf("%-8s %8.1f ns/entry\n", "iter", (NowNs() - Time) / EntryNum);
+
+    // scan (strength only)
+
+    Time = NowNs();
+    for(unsigned int t = 0 ; t < TableNum ; t++) {
+        for(CPtr<CBenchIter> pIter = Tables[t]->GetIter(0) ; *pIter ;
+            ++(*pIter))
+            Check += (unsigned long)pIter->Strg();
+    }
+    printf("%-8s %8.1f ns/entry\n", "scan", (NowNs() - Time) / EntryNum);
+
+    // copy
+
+    Time = NowNs();
+    for(unsigned int t = 0 ; t < TableNum ; t++) {
+        CBenchTable* pCopy = new CBenchTable(*Tables[t]);
+        Check += pCopy->GetTopLength(0);
+        delete pCopy;
+    }
+    printf("%-8s %8.1f ns/entry\n", "copy", (NowNs() - Time) / EntryNum);
+
+    printf("\n(check %lu)\n", Check);
+
+    for(unsigned int t = 0 ; t < TableNum ; t++)
+        delete Tables[t];
+
+    return 0;
+}
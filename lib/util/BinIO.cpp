@@ -0,0 +1,180 @@
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cstring>
+#include "BinIO.h"
+
+using namespace std;
+
+////////////
+// Writer //
+////////////
+
+void
+CBinWriter::PutBytes(char const* pBytes, unsigned int Num)
+{
+    for(unsigned int i = 0 ; i < Num ; i++)
+        m_Checksum = (m_Checksum ^ (unsigned char)pBytes[i]) *
+            BINIO_FNV_PRIME;
+
+    m_Out.write(pBytes, Num);
+}
+
+void
+CBinWriter::PutU32(unsigned int Val)
+{
+    char Bytes[4];
+
+    for(unsigned int i = 0 ; i < 4 ; i++)
+        Bytes[i] = (char)((Val >> (8*i)) & 0xff);
+
+    PutBytes(Bytes, 4);
+}
+
+void
+CBinWriter::PutFloat(float Val)
+{
+    unsigned int Bits;
+
+    memcpy(&Bits, &Val, sizeof(Bits));
+    PutU32(Bits);
+}
+
+void
+CBinWriter::PutStr(string const& Str)
+{
+    PutU32(Str.size());
+    PutBytes(Str.data(), Str.size());
+}
+
+void
+CBinWriter::PutStr(char const* pStr, unsigned int Len)
+{
+    PutU32(Len);
+    PutBytes(pStr, Len);
+}
+
+void
+CBinWriter::PutChecksum()
+{
+    // the checksum does not include itself
+    unsigned int Checksum = m_Checksum;
+    PutU32(Checksum);
+}
+
+////////////
+// Reader //
+////////////
+
+bool
+CBinReader::GetBytes(char* pBytes, unsigned int Num)
+{
+    if(m_bError)
+        return false;
+
+    if(m_pIn) {
+        if(!m_pIn->read(pBytes, Num)) {
+            m_bError = true;
+            return false;
+        }
+    } else {
+        if(m_BufLen - m_BufPos < Num) {
+            m_bError = true;
+            return false;
+        }
+        memcpy(pBytes, m_pBuf + m_BufPos, Num);
+        m_BufPos += Num;
+    }
+
+    for(unsigned int i = 0 ; i < Num ; i++)
+        m_Checksum = (m_Checksum ^ (unsigned char)pBytes[i]) *
+            BINIO_FNV_PRIME;
+
+    return true;
+}
+
+bool
+CBinReader::GetU32(unsigned int& Val)
+{
+    unsigned char Bytes[4];
+
+    if(!GetBytes((char*)Bytes, 4))
+        return false;
+
+    Val = 0;
+    for(unsigned int i = 0 ; i < 4 ; i++)
+        Val |= ((unsigned int)Bytes[i]) << (8*i);
+
+    return true;
+}
+
+bool
+CBinReader::GetInt(int& Val)
+{
+    unsigned int U;
+
+    if(!GetU32(U))
+        return false;
+
+    Val = (int)U;
+    return true;
+}
+
+bool
+CBinReader::GetFloat(float& Val)
+{
+    unsigned int Bits;
+
+    if(!GetU32(Bits))
+        return false;
+
+    memcpy(&Val, &Bits, sizeof(Val));
+    return true;
+}
+
+bool
+CBinReader::GetStr(string& Str, unsigned int MaxLen)
+{
+    unsigned int Len;
+
+    if(!GetU32(Len))
+        return false;
+
+    if(Len > MaxLen) {
+        m_bError = true;
+        return false;
+    }
+
+    string Read(Len, '\0');
+
+    if(Len && !GetBytes(&Read[0], Len))
+        return false;
+
+    Str.swap(Read);
+    return true;
+}
+
+bool
+CBinReader::CheckChecksum()
+{
+    unsigned int Expected = m_Checksum;
+    unsigned int Checksum;
+
+    if(!GetU32(Checksum))
+        return false;
+
+    return Checksum == Expected;
+}
@@ -0,0 +1,80 @@
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <iomanip>
+#include "ObjStats.h"
+
+using namespace std;
+
+// These are zero initialized before any object is constructed, so
+// objects may be counted during static initialization.
+
+THREAD_LOCAL CObjStats::SObjCount CObjStats::m_Counts[eOSTypeNum];
+
+// names of the types (in the order of EObjStatType)
+char const* CObjStats::m_Names[eOSTypeNum] = {
+    "string keys",
+    "hash entries",
+    "hash slot arrays",
+    "label slot arrays",
+    "lexicon entries",
+    "statistics",
+    "statistics values",
+    "top list entries",
+    "statistics copies",
+    "label tables",
+    "label values",
+    "links",
+    "units",
+    "string arena chunks"
+};
+
+size_t
+CObjStats::TotalBytes()
+{
+    size_t Total = 0;
+
+    for(unsigned int Type = 0 ; Type < eOSTypeNum ; Type++)
+        Total += m_Counts[Type].m_Bytes;
+
+    return Total;
+}
+
+void
+CObjStats::Print(ostream& Out, string const& Prefix)
+{
+#ifdef NO_OBJ_STATS
+    Out << Prefix << "Object counts not available (compiled with NO_OBJ_STATS)"
+        << endl;
+#else
+    Out << Prefix << "Live objects by type (" << TotalBytes()
+        << " bytes in total):" << endl;
+    Out << Prefix << "  " << left << setw(20) << "type" << right
+        << setw(12) << "live" << setw(12) << "peak"
+        << setw(14) << "bytes" << setw(14) << "peak bytes"
+        << setw(14) << "created" << endl;
+    
+    for(unsigned int Type = 0 ; Type < eOSTypeNum ; Type++) {
+        SObjCount& Count = m_Counts[Type];
+        if(!Count.m_Total)
+            continue;
+        Out << Prefix << "  " << left << setw(20) << m_Names[Type] << right
+            << setw(12) << Count.m_Live << setw(12) << Count.m_PeakLive
+            << setw(14) << Count.m_Bytes << setw(14) << Count.m_PeakBytes
+            << setw(14) << Count.m_Total << endl;
+    }
+#endif
+}
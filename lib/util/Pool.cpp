@@ -0,0 +1,132 @@
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <new>
+#include "Pool.h"
+
+using namespace std;
+
+// These are zero initialized before any object is constructed (in each
+// thread, in multi-threaded builds), so the allocator may be used during
+// static initialization.
+
+THREAD_LOCAL CPoolAlloc::SSizeClass CPoolAlloc::m_Classes[POOL_SIZE_CLASSES];
+THREAD_LOCAL unsigned long CPoolAlloc::m_HeapAllocs;
+THREAD_LOCAL unsigned long CPoolAlloc::m_HeapInUse;
+THREAD_LOCAL bool CPoolAlloc::m_bInRegion;
+THREAD_LOCAL char* CPoolAlloc::m_pRegionNext;
+THREAD_LOCAL char* CPoolAlloc::m_pRegionEnd;
+THREAD_LOCAL unsigned long CPoolAlloc::m_RegionChunks;
+
+void
+CPoolAlloc::AllocChunk(unsigned int Class)
+{
+    size_t ObjSize = (Class + 1) * POOL_GRAIN;
+    unsigned int ObjNum = POOL_CHUNK_SIZE / ObjSize;
+    char* pChunk = (char*)::operator new(ObjNum * ObjSize);
+
+    // thread the objects of the chunk onto the free list (in order, so that
+    // consecutive allocations are adjacent in memory)
+
+    SFreeObj* pFree = m_Classes[Class].m_pFree;
+
+    for(unsigned int i = ObjNum ; i > 0 ; i--) {
+        SFreeObj* pObj = (SFreeObj*)(pChunk + (i - 1) * ObjSize);
+        pObj->m_pNext = pFree;
+        pFree = pObj;
+    }
+
+    m_Classes[Class].m_pFree = pFree;
+    m_Classes[Class].m_Chunks++;
+}
+
+void*
+CPoolAlloc::RegionAlloc(unsigned int Class)
+{
+    size_t ObjSize = (Class + 1) * POOL_GRAIN;
+
+    if((size_t)(m_pRegionEnd - m_pRegionNext) < ObjSize) {
+        // the end of the current chunk is too small for this object, so
+        // add it (as a single object) to the free list of its size
+        size_t Left = m_pRegionEnd - m_pRegionNext;
+        if(Left >= POOL_GRAIN) {
+            SFreeObj* pObj = (SFreeObj*)m_pRegionNext;
+            unsigned int LeftClass = SizeClass(Left);
+            pObj->m_pNext = m_Classes[LeftClass].m_pFree;
+            m_Classes[LeftClass].m_pFree = pObj;
+        }
+        m_pRegionNext = (char*)::operator new(POOL_REGION_CHUNK_SIZE);
+        m_pRegionEnd = m_pRegionNext + POOL_REGION_CHUNK_SIZE;
+        m_RegionChunks++;
+    }
+
+    void* pObj = m_pRegionNext;
+    m_pRegionNext += ObjSize;
+    return pObj;
+}
+
+unsigned long
+CPoolAlloc::TotalAllocs()
+{
+    unsigned long Total = m_HeapAllocs;
+
+    for(unsigned int Class = 0 ; Class < POOL_SIZE_CLASSES ; Class++)
+        Total += m_Classes[Class].m_Allocs;
+
+    return Total;
+}
+
+unsigned long
+CPoolAlloc::TotalHeapAllocs()
+{
+    unsigned long Total = m_HeapAllocs + m_RegionChunks;
+
+    for(unsigned int Class = 0 ; Class < POOL_SIZE_CLASSES ; Class++)
+        Total += m_Classes[Class].m_Chunks;
+
+    return Total;
+}
+
+void
+CPoolAlloc::PrintStats(ostream& Out, string const& Prefix)
+{
+    unsigned long Chunks = 0;
+    unsigned long InUse = m_HeapInUse;
+
+    for(unsigned int Class = 0 ; Class < POOL_SIZE_CLASSES ; Class++) {
+        Chunks += m_Classes[Class].m_Chunks;
+        InUse += m_Classes[Class].m_InUse;
+    }
+
+    Out << Prefix << "Pooled object allocations: " << TotalAllocs()
+        << " (" << InUse << " in use)" << endl;
+    Out << Prefix << "Heap allocations for these objects: "
+        << TotalHeapAllocs() << " (" << Chunks << " chunks of "
+        << POOL_CHUNK_SIZE << " bytes, " << m_HeapAllocs
+        << " objects too large for the pool)" << endl;
+    if(m_RegionChunks)
+        Out << Prefix << "Region chunks: " << m_RegionChunks << " (of "
+            << POOL_REGION_CHUNK_SIZE << " bytes)" << endl;
+
+    for(unsigned int Class = 0 ; Class < POOL_SIZE_CLASSES ; Class++) {
+        if(!m_Classes[Class].m_Allocs)
+            continue;
+        Out << Prefix << "  size " << (Class + 1) * POOL_GRAIN
+            << ": " << m_Classes[Class].m_Allocs << " allocations, "
+            << m_Classes[Class].m_InUse << " in use, "
+            << m_Classes[Class].m_Chunks << " chunks" << endl;
+    }
+}
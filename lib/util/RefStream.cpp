@@ -52,3 +52,24 @@ CRefOFStream::~CRefOFStream()
     DecObjCount();
 #endif
 }
+
+CRefOStrStream::CRefOStrStream()  : m_Stream()
+{
+#ifdef DETAILED_DEBUG
+    IncObjCount();
+#endif
+}
+
+CRefOStrStream::~CRefOStrStream()
+{
+#ifdef DETAILED_DEBUG
+    DecObjCount();
+#endif
+}
+
+void
+CRefOStrStream::WriteTo(ostream& Out)
+{
+    Out << m_Stream.str();
+    m_Stream.str("");
+}
@@ -28,6 +28,16 @@ using namespace std;
 unsigned int g_StatisticsTopListMaxLen = 10;
 // maximal number of labels (on each side of a labeled object)
 unsigned int g_MaxLabels = 10;
+// expected number of entries in the lexicon (the lexicon hash table is
+// initially sized to hold this number of entries). Use 0 for the default
+// (LEX_DEFAULT_HASH_SIZE).
+unsigned int g_LexHashSize = 0;
+// if not 0, the lexicon hash table is resized incrementally (spreading
+// the cost of resizing over many insertions)
+unsigned int g_LexIncrementalResize = 1;
+unsigned int g_LexMaxEntries = 0;
+unsigned int g_LexMaxMemory = 0;
+unsigned int g_LexCompact = 0;
 
 //
 // Input reading
@@ -85,6 +95,11 @@ unsigned int g_GroupedEvalMaxPrint = 100;
 std::string g_CommentStr("#");
 // minimal count for an entry in the lexicon to be printed
 unsigned int g_LexMinPrint = 5;
+// maximal number of lexicon entries to print (0 - no limit)
+unsigned int g_LexMaxPrint = 0;
+// number of threads used to sort the lexicon for printing (the entries
+// are printed by a single thread)
+unsigned int g_LexPrintThreads = 1;
 // Printing mode (see PrintUtils.h and PrintUtils.cpp for possible values).
 // These values should appear in a list, separated by whitespace.
 std::string g_PrintingMode("");
@@ -120,6 +135,11 @@ CGlobals::InitGlobals(vector<string> const& List)
     // ----------------- Add all globals here ---------------------------
     AddArg("StatisticsTopListMaxLen", &g_StatisticsTopListMaxLen);
     AddArg("MaxLabels", &g_MaxLabels);
+    AddArg("LexHashSize", &g_LexHashSize);
+    AddArg("LexIncrementalResize", &g_LexIncrementalResize);
+    AddArg("LexMaxEntries", &g_LexMaxEntries);
+    AddArg("LexMaxMemory", &g_LexMaxMemory);
+    AddArg("LexCompact", &g_LexCompact);
     AddArg("UseTagsAsWords", &g_UseTagsAsWords);
     AddArg("UseTagsAsLabels", &g_UseTagsAsLabels);
     AddArg("CurrencySymbolIsPunct", &g_CurrencySymbolIsPunct);
@@ -132,6 +152,8 @@ CGlobals::InitGlobals(vector<string> const& List)
     AddArg("GroupedEvalMaxPrint", &g_GroupedEvalMaxPrint);
     AddArg("CommentStr", &g_CommentStr);
     AddArg("LexMinPrint", &g_LexMinPrint);
+    AddArg("LexMaxPrint", &g_LexMaxPrint);
+    AddArg("LexPrintThreads", &g_LexPrintThreads);
     AddArg("PrintingMode", &g_PrintingMode);
     AddArg("TraceBits", &g_TraceBits);
     AddArg("CCLBasicUseBothInValues", &g_CCLBasicUseBothInValues);
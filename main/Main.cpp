@@ -18,6 +18,11 @@
 #include <string>
 #include <ostream>
 #include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include "BinIO.h"
 #include "Main.h"
 #include "Parser.h"
 #include "CCLParser.h"
@@ -27,10 +32,13 @@
 #include "Process.h"
 #include "yError.h"
 #include "StringUtil.h"
+#include "Pool.h"
+#include "ObjStats.h"
 
 using namespace std;
 
-CMain::CMain(int ac, char** av) : m_Error(false)
+CMain::CMain(int ac, char** av) :
+        m_StepNum(0), m_CheckpointObj(0), m_CheckpointTime(0), m_Error(false)
 {
 #ifdef DETAILED_DEBUG
     IncObjCount();
@@ -99,18 +107,31 @@ CMain::Run()
     // map to store the size of each input pattern so that it does not
     // have to be calculated again.
     map<string, unsigned int> InFileSizes;
+
+    // When resuming, the steps before the last step with a checkpoint
+    // are skipped and that step is resumed from the checkpoint.
+    unsigned int ResumeStep = 0;
+    SLoopPos ResumePos;
+    bool bResume = false;
+
+    if(m_pArgs->Resume() && !FindResumeStep(ResumeStep, ResumePos, bResume))
+        return false;
     
     // loop over the loop configuration list and execute every loop which
     // appears there.
 
+    m_StepNum = 0;
+    
     for(vector<CpCLoopEntry>::iterator Iter = m_pLoopConf->Begin() ;
-        Iter != m_pLoopConf->End() ; Iter++) {
+        Iter != m_pLoopConf->End() ; Iter++, m_StepNum++) {
         
         if(!*Iter) {
             yPError(ERR_SHOULDNT, "missing loop entry pointer");
         }
 
+        m_pStepEntry = *Iter;
         CpCCmdArgOpts pArgs = (*Iter)->GetCmdArgOpts();
+        bool bResumeStep = bResume && m_StepNum == ResumeStep;
         
         // Update the globals
         SetGlobals(pArgs);
@@ -132,6 +153,62 @@ CMain::Run()
                      g_ParserType + "'");
             return false;
         }
+
+        // Steps before the step being resumed were already completed
+        if(bResume && m_StepNum < ResumeStep)
+            continue;
+
+        if(!pArgs->GetCheckpointFile().empty() &&
+           (*Iter)->GetAction() != CLoopEntry::eLearn) {
+            SetError("Checkpoints can only be written in learn steps: " +
+                     (*Iter)->GetEntryString());
+            return false;
+        }
+        
+        // Load the checkpoint being resumed. This replaces the lexicon
+        // accumulated by the previous steps and any lexicon loaded or
+        // mapped by this step.
+        if(bResumeStep) {
+            ostringstream Ostr(ios::out);
+            Ostr << "Resuming from checkpoint (at object "
+                 << ResumePos.m_ObjNum << ") ... ";
+            m_pMsgLine->NewMessage(Ostr.str());
+            if(!ReadCheckpoint(pArgs->GetCheckpointFile(), m_StepNum, *Iter,
+                               ResumePos, true))
+                return false;
+            m_pMsgLine->AppendMessage("done");
+            m_pMsgLine->NewMessageLine();
+        }
+        
+        // Load the lexicon snapshot (if requested). This replaces the
+        // lexicon accumulated by the previous steps.
+        if(!bResumeStep && !pArgs->GetLoadLexiconFile().empty()) {
+            string Error;
+            if(!m_pParser) {
+                SetError("Cannot load lexicon '" +
+                         pArgs->GetLoadLexiconFile() + "': no parser");
+                return false;
+            }
+            m_pMsgLine->NewMessage("Loading lexicon ... ");
+            if(!m_pParser->LoadLexicon(pArgs->GetLoadLexiconFile(), Error)) {
+                SetError("Error when loading lexicon: " + Error);
+                return false;
+            }
+            m_pMsgLine->AppendMessage("done");
+            m_pMsgLine->NewMessageLine();
+        }
+
+        // Map the lexicon file (if requested). This also replaces the
+        // lexicon accumulated by the previous steps.
+        if(!bResumeStep && !pArgs->GetMapLexiconFile().empty()) {
+            string Error;
+            if(!m_pParser ||
+               !m_pParser->MapLexicon(pArgs->GetMapLexiconFile(), Error)) {
+                SetError("Error when mapping lexicon: " +
+                         (m_pParser ? Error : string("no parser")));
+                return false;
+            }
+        }
         
         if(m_pParser) {
             m_pParser->
@@ -199,20 +276,72 @@ CMain::Run()
         m_pMsgLine->NewMessage((*Iter)->ProcessingMessage()+": ");
         m_pLoop->ResetLoop();
 
+        if(bResumeStep)
+            m_pLoop->SetResumePos(ResumePos);
+        
         // record loop start time
         time_t StartTime = time(NULL);
+
+        if(!pArgs->GetCheckpointFile().empty()) {
+            m_CheckpointObj = bResumeStep ? ResumePos.m_ObjNum : 1;
+            m_CheckpointTime = StartTime;
+            m_pLoop->SetCheckpointer(this);
+        }
         
         if(!m_pLoop->DoLoop()) {
-            SetError(m_pLoop->GetErrorStr());
+            // (the error may have been set while writing a checkpoint)
+            if(!IsError())
+                SetError(m_pLoop->GetErrorStr());
             return false;
         }
 
         // record loop end time
         time_t EndTime = time(NULL);
+
+        // Write the checkpoint at the end of the step (after the loop, the
+        // object number is that of the last object read).
+        if(!pArgs->GetCheckpointFile().empty()) {
+            SLoopPos Pos;
+            if(!m_pLoop->GetPos(Pos)) {
+                SetError("Failed to determine the input position for "
+                         "checkpoint");
+                return false;
+            }
+            Pos.m_ObjNum++;
+            if(!WriteCheckpoint(Pos))
+                return false;
+        }
         
         // Post-loop actions (mostly, printing)
         PostLoopActions(*Iter, StartTime, EndTime);
 
+        // Compact the lexicon learned (if requested)
+        if(g_LexCompact && m_pParser &&
+           ((*Iter)->GetAction() & CLoopEntry::eLearn))
+            m_pParser->CompactLexicon();
+
+        // Save the lexicon snapshot (if requested)
+        if(!pArgs->GetSaveLexiconFile().empty()) {
+            string Error;
+            if(!m_pParser ||
+               !m_pParser->SaveLexicon(pArgs->GetSaveLexiconFile(), Error)) {
+                SetError("Error when saving lexicon: " +
+                         (m_pParser ? Error : string("no parser")));
+                return false;
+            }
+        }
+        if(!pArgs->GetSaveMappedLexiconFile().empty()) {
+            string Error;
+            if(!m_pParser ||
+               !m_pParser->SaveMappedLexicon(pArgs->
+                                             GetSaveMappedLexiconFile(),
+                                             Error)) {
+                SetError("Error when saving mapped lexicon: " +
+                         (m_pParser ? Error : string("no parser")));
+                return false;
+            }
+        }
+
         ostringstream Ostr(ios::out);
         Ostr << "done: " << m_pLoop->GetObjsProcessedNum() << " objects";
         m_pMsgLine->AppendMessage(Ostr.str());
@@ -222,6 +351,204 @@ CMain::Run()
     return true;
 }
 
+/////////////////
+// Checkpoints //
+/////////////////
+
+// A checkpoint file begins with a header holding the following values
+// (see BinIO.h):
+//
+// <magic> <version> <step number> <step entry string>
+// <object number> <line number> <objects processed>
+// <file number> <file offset (low word)> <file offset (high word)>
+// <checksum>
+//
+// This is followed by the learned state of the parser, as written by
+// CParser::SaveCheckpoint() (for the CCL parser, a lexicon snapshot).
+// The step number and entry string identify the step which wrote the
+// checkpoint in the execution sequence.
+
+#define CHECKPOINT_MAGIC 0x4b4c4343 // 'CCLK'
+#define CHECKPOINT_VERSION 1
+
+bool
+CMain::ObjectDone(CLoop* pLoop, SLoopPos const& Pos)
+{
+    CCmdArgOpts* pArgs = pLoop->GetArgs();
+
+    if((pArgs->GetCheckpointObjs() &&
+        Pos.m_ObjNum - m_CheckpointObj >= pArgs->GetCheckpointObjs()) ||
+       (pArgs->GetCheckpointSecs() &&
+        time(NULL) - m_CheckpointTime >= (time_t)pArgs->GetCheckpointSecs()))
+        return WriteCheckpoint(Pos);
+
+    return true;
+}
+
+bool
+CMain::WriteCheckpoint(SLoopPos const& Pos)
+{
+    if(!m_pStepEntry || !m_pParser) {
+        yPError(ERR_MISSING, "step entry or parser missing");
+    }
+
+    string const& FileName = m_pStepEntry->GetCmdArgOpts()->GetCheckpointFile();
+    string TmpFileName = FileName + ".tmp";
+    string Error;
+
+    ofstream Out(TmpFileName.c_str(), ios::out | ios::binary | ios::trunc);
+
+    if(!Out) {
+        SetError("could not open checkpoint file '" + TmpFileName +
+                 "' for writing");
+        return false;
+    }
+
+    CBinWriter Header(Out);
+
+    Header.PutU32(CHECKPOINT_MAGIC);
+    Header.PutU32(CHECKPOINT_VERSION);
+    Header.PutU32(m_StepNum);
+    Header.PutStr(m_pStepEntry->GetEntryString());
+    Header.PutU32(Pos.m_ObjNum);
+    Header.PutU32(Pos.m_LineNum);
+    Header.PutU32(Pos.m_ObjsProcessed);
+    Header.PutU32(Pos.m_FileNum);
+    Header.PutU32((unsigned int)Pos.m_Offset);
+    Header.PutU32((unsigned int)(Pos.m_Offset >> 32));
+    Header.PutChecksum();
+
+    if(!m_pParser->SaveCheckpoint(Out, TmpFileName, Error)) {
+        SetError("Error when writing checkpoint: " + Error);
+        return false;
+    }
+
+    Out.close();
+
+    if(Header.IsError() || Out.fail()) {
+        SetError("error while writing checkpoint file '" + TmpFileName + "'");
+        return false;
+    }
+
+    // make sure the checkpoint is on disk before it replaces the
+    // previous one
+    int Fd = open(TmpFileName.c_str(), O_RDONLY);
+
+    if(Fd < 0 || fsync(Fd)) {
+        if(Fd >= 0)
+            close(Fd);
+        SetError("error while writing checkpoint file '" + TmpFileName + "'");
+        return false;
+    }
+    
+    close(Fd);
+    
+    if(rename(TmpFileName.c_str(), FileName.c_str())) {
+        SetError("could not rename checkpoint file '" + TmpFileName +
+                 "' to '" + FileName + "'");
+        return false;
+    }
+
+    m_CheckpointObj = Pos.m_ObjNum;
+    m_CheckpointTime = time(NULL);
+    
+    return true;
+}
+
+bool
+CMain::ReadCheckpoint(string const& FileName, unsigned int StepNum,
+                      CLoopEntry* pEntry, SLoopPos& Pos, bool bLoadState)
+{
+    if(!pEntry) {
+        yPError(ERR_MISSING, "step entry missing");
+    }
+    
+    ifstream In(FileName.c_str(), ios::in | ios::binary);
+
+    if(!In) {
+        SetError("could not open checkpoint file '" + FileName + "'");
+        return false;
+    }
+
+    CBinReader Reader(In);
+    unsigned int Magic, Version, Step, OffsetLow, OffsetHigh;
+    string Entry;
+
+    if(!Reader.GetU32(Magic) || Magic != CHECKPOINT_MAGIC) {
+        SetError("'" + FileName + "' is not a checkpoint file");
+        return false;
+    }
+
+    if(!Reader.GetU32(Version) || Version != CHECKPOINT_VERSION) {
+        SetError("checkpoint file '" + FileName +
+                 "' has an unsupported version");
+        return false;
+    }
+
+    if(!Reader.GetU32(Step) || !Reader.GetStr(Entry) ||
+       !Reader.GetU32(Pos.m_ObjNum) || !Reader.GetU32(Pos.m_LineNum) ||
+       !Reader.GetU32(Pos.m_ObjsProcessed) || !Reader.GetU32(Pos.m_FileNum) ||
+       !Reader.GetU32(OffsetLow) || !Reader.GetU32(OffsetHigh) ||
+       !Reader.CheckChecksum()) {
+        SetError("checkpoint file '" + FileName + "' is corrupt");
+        return false;
+    }
+
+    Pos.m_Offset = ((unsigned long long)OffsetHigh << 32) | OffsetLow;
+    
+    if(Step != StepNum || Entry != pEntry->GetEntryString()) {
+        SetError("checkpoint file '" + FileName + "' was not written by "
+                 "this step of the execution sequence: " +
+                 pEntry->GetEntryString());
+        return false;
+    }
+
+    if(!bLoadState)
+        return true;
+
+    string Error;
+    
+    if(!m_pParser || !m_pParser->LoadCheckpoint(In, FileName, Error)) {
+        SetError("Error when loading checkpoint: " +
+                 (m_pParser ? Error : string("no parser")));
+        return false;
+    }
+
+    return true;
+}
+
+bool
+CMain::FindResumeStep(unsigned int& StepNum, SLoopPos& Pos, bool& bFound)
+{
+    unsigned int Num = 0;
+
+    bFound = false;
+    
+    for(vector<CpCLoopEntry>::iterator Iter = m_pLoopConf->Begin() ;
+        Iter != m_pLoopConf->End() ; Iter++, Num++) {
+        
+        string const& FileName =
+            (*Iter)->GetCmdArgOpts()->GetCheckpointFile();
+
+        if(FileName.empty() || access(FileName.c_str(), F_OK))
+            continue; // no checkpoint
+
+        if(!ReadCheckpoint(FileName, Num, *Iter, Pos, false))
+            return false;
+
+        StepNum = Num;
+        bFound = true;
+    }
+
+    if(!bFound) {
+        m_pMsgLine->NewMessage("No checkpoint found, starting from the "
+                               "beginning");
+        m_pMsgLine->NewMessageLine();
+    }
+    
+    return true;
+}
+
 void
 CMain::SetGlobals(CCmdArgOpts* pArgs)
 {
@@ -354,6 +681,25 @@ CMain::PostLoopActions(CLoopEntry* pEntry, time_t& StartTime, time_t& EndTime)
                                      << endl;
     }
 
+    if(PrintingModeOn(PMODE_ALLOC_COUNT) &&
+       m_pOutputFile && m_pOutputFile->IsOpen()) {
+        // Print the allocation counts (totals since the program started)
+        CPoolAlloc::PrintStats((ostream&)(*m_pOutputFile), g_CommentStr + " ");
+    }
+
+    if(PrintingModeOn(PMODE_MEM_COUNT) &&
+       m_pOutputFile && m_pOutputFile->IsOpen()) {
+        // Print the live object counts (at the end of this step)
+        CObjStats::Print((ostream&)(*m_pOutputFile), g_CommentStr + " ");
+    }
+
+    if(m_pParser && m_pParser->GetLexicon() &&
+       m_pOutputFile && m_pOutputFile->IsOpen()) {
+        // Print the number of lexicon entries evicted (if any)
+        m_pParser->GetLexicon()->PrintPruneStats((ostream&)(*m_pOutputFile),
+                                                 g_CommentStr + " ");
+    }
+
     if(m_pParser && m_pParser->GetLexicon() &&
        pEntry->GetCmdArgOpts()->PrintLexicon() && m_pOutputFile) {
 
@@ -0,0 +1,323 @@
+// Copyright 2007 Yoav Seginer
+
+// This file is part of CCL-Parser.
+// CCL-Parser is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// CCL-Parser is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
+
+//
+// Lexicon snapshot merging. This merges lexicon snapshots learned
+// separately (for example, on different parts of a corpus, by different
+// processes) into a single snapshot (see CCCLLexicon::MergeSnapshots()).
+// This is run as:
+//
+// cclmerge <output snapshot> <input snapshot> ... <input snapshot>
+//
+// The merged snapshot can then be loaded by the parser ('-r' option).
+//
+// The following experiment mode compares parsing with a merged lexicon
+// with parsing with a lexicon learned sequentially on the same input:
+//
+// cclmerge -x <number of shards> <input file> <file prefix>
+//
+// The input file is read as plain text with one utterance per line and
+// the words separated by white space (as in cclbench, there is no
+// punctuation processing). The input is split into the given number of
+// consecutive shards and a lexicon is learned on each shard separately
+// and saved to <file prefix>.<shard number>.snap. These are then merged
+// into <file prefix>.merged.snap. A lexicon is also learned sequentially
+// on the whole input. The whole input is then parsed with the merged
+// lexicon, with the lexicons of the first and the last shard and with the
+// sequential lexicon. The parses with the first three are evaluated
+// against those with the sequential lexicon (bracket precision and recall,
+// as in the 'P&R' evaluator, and the number of identical parses). Since
+// the first shard is learned exactly as the beginning of the sequential
+// learning, the last shard is the more neutral baseline.
+//
+
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include "Globals.h"
+#include "SynBrackets.h"
+#include "CCLParser.h"
+
+using namespace std;
+
+// current time in seconds
+
+static double
+NowSecs()
+{
+    struct timespec Time;
+
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    return Time.tv_sec + Time.tv_nsec * 1e-9;
+}
+
+static int
+Usage(char const* pProg)
+{
+    fprintf(stderr, "usage: %s <output snapshot> <input snapshot> ...\n"
+            "       %s -x <number of shards> <input file> <file prefix>\n",
+            pProg, pProg);
+    return 1;
+}
+
+static int
+Merge(vector<string> const& InFiles, string const& OutFile)
+{
+    string Error;
+    double Time = NowSecs();
+
+    if(!CCCLLexicon::MergeSnapshots(InFiles, OutFile, Error)) {
+        fprintf(stderr, "%s\n", Error.c_str());
+        return 1;
+    }
+
+    printf("merged %u snapshots into %s (%.2f sec)\n",
+           (unsigned int)InFiles.size(), OutFile.c_str(), NowSecs() - Time);
+    return 0;
+}
+
+//
+// Experiment mode
+//
+
+// the input utterances
+typedef vector<vector<string> > tUtterances;
+
+static unsigned int
+ReadUtterances(char const* pFileName, tUtterances& Utterances)
+{
+    ifstream In(pFileName);
+    string Line;
+    unsigned int TokenNum = 0;
+
+    while(getline(In, Line)) {
+        istringstream Words(Line);
+        string Word;
+        vector<string> Utterance;
+
+        while(Words >> Word)
+            Utterance.push_back(Word);
+
+        if(Utterance.empty())
+            continue;
+
+        TokenNum += Utterance.size();
+        Utterances.push_back(Utterance);
+    }
+
+    return TokenNum;
+}
+
+// Learns a new lexicon from the utterances [Begin, End). Returns the
+// lexicon and the learning time (in seconds) in 'Time'.
+
+static CpCCCLLexicon
+Learn(tUtterances& Utterances, unsigned int Begin, unsigned int End,
+      double& Time)
+{
+    CpCCCLLexicon pLexicon = new CCCLLexicon();
+    CpCCCLParser pParser = new CCCLParser(pLexicon);
+    vector<string> Labels; // no labels
+
+    pParser->SetLearnCycle(true);
+    pParser->SetParseCycle(false);
+
+    Time = NowSecs();
+
+    for(unsigned int i = Begin ; i < End ; i++) {
+        for(vector<string>::iterator Iter = Utterances[i].begin() ;
+            Iter != Utterances[i].end() ; Iter++)
+            pParser->PushInputUnit(*Iter, Labels);
+        pParser->PushInputPunct(eEoUtterance);
+        pParser->ClearUtterance();
+    }
+
+    Time = NowSecs() - Time;
+
+    return pLexicon;
+}
+
+// Parses all utterances with the given lexicon and with the reference
+// lexicon and prints the evaluation of the first against the second
+// (the brackets are compared as by the 'P&R' evaluator).
+
+static void
+Compare(char const* pName, tUtterances& Utterances, CCCLLexicon* pLexicon,
+        CCCLLexicon* pRefLexicon)
+{
+    // (the syntactic structure is accessed through the parser interface)
+    CpCParser pParser = new CCCLParser(pLexicon);
+    CpCParser pRefParser = new CCCLParser(pRefLexicon);
+    vector<string> Labels; // no labels
+    unsigned int Matched = 0, ParsedNum = 0, RefNum = 0, Identical = 0;
+
+    pParser->SetLearnCycle(false);
+    pParser->SetParseCycle(true);
+    pRefParser->SetLearnCycle(false);
+    pRefParser->SetParseCycle(true);
+
+    for(tUtterances::iterator Iter = Utterances.begin() ;
+        Iter != Utterances.end() ; Iter++) {
+        for(vector<string>::iterator WIter = Iter->begin() ;
+            WIter != Iter->end() ; WIter++) {
+            pParser->PushInputUnit(*WIter, Labels);
+            pRefParser->PushInputUnit(*WIter, Labels);
+        }
+        pParser->PushInputPunct(eEoUtterance);
+        pRefParser->PushInputPunct(eEoUtterance);
+
+        CpCSynBrackets pParsed =
+            new CSynBrackets(pParser->GetSynStruct(), CSynBrackets::eNone,
+                             true, true, !g_CountTopBracket);
+        CpCSynBrackets pRef =
+            new CSynBrackets(pRefParser->GetSynStruct(), CSynBrackets::eNone,
+                             true, true, !g_CountTopBracket);
+        unsigned int Match = pParsed->Precision(*pRef);
+        
+        if(Match == pParsed->NonTermNum() && Match == pRef->NonTermNum())
+            Identical++;
+
+        Matched += Match;
+        ParsedNum += pParsed->NonTermNum();
+        RefNum += pRef->NonTermNum();
+        
+        pParser->ClearUtterance();
+        pRefParser->ClearUtterance();
+    }
+
+    double Precision = ParsedNum ? (double)Matched / ParsedNum : 0;
+    double Recall = RefNum ? (double)Matched / RefNum : 0;
+
+    printf("%-16s %10.2f %10.2f %10.2f %10.2f\n", pName, 100 * Precision,
+           100 * Recall,
+           (Precision + Recall) ?
+           200 * Precision * Recall / (Precision + Recall) : 0,
+           100.0 * Identical / Utterances.size());
+}
+
+static int
+Experiment(unsigned int ShardNum, char const* pInFile, string const& Prefix)
+{
+    tUtterances Utterances;
+    unsigned int TokenNum = ReadUtterances(pInFile, Utterances);
+
+    if(!TokenNum) {
+        fprintf(stderr, "no tokens in '%s'\n", pInFile);
+        return 1;
+    }
+
+    if(ShardNum < 2 || ShardNum > Utterances.size()) {
+        fprintf(stderr, "the number of shards must be between 2 and the "
+                "number of utterances\n");
+        return 1;
+    }
+
+    printf("%u utterances, %u tokens, %u shards\n\n",
+           (unsigned int)Utterances.size(), TokenNum, ShardNum);
+
+    double Time;
+    CpCCCLLexicon pSeqLexicon = Learn(Utterances, 0, Utterances.size(), Time);
+
+    printf("sequential learning: %.2f sec, %u entries\n", Time,
+           pSeqLexicon->NumElements());
+
+    // learn and save the shards
+
+    vector<string> ShardFiles;
+    CpCCCLLexicon pFirstLexicon;
+    CpCCCLLexicon pLastLexicon;
+    double MaxTime = 0;
+    string Error;
+
+    for(unsigned int Shard = 0 ; Shard < ShardNum ; Shard++) {
+        ostringstream FileName(ios::out);
+        FileName << Prefix << "." << Shard + 1 << ".snap";
+        ShardFiles.push_back(FileName.str());
+
+        CpCCCLLexicon pLexicon =
+            Learn(Utterances,
+                  (unsigned int)((unsigned long long)Utterances.size() *
+                                 Shard / ShardNum),
+                  (unsigned int)((unsigned long long)Utterances.size() *
+                                 (Shard + 1) / ShardNum), Time);
+
+        if(Time > MaxTime)
+            MaxTime = Time;
+
+        if(!pLexicon->Save(ShardFiles.back(), Error)) {
+            fprintf(stderr, "%s\n", Error.c_str());
+            return 1;
+        }
+
+        if(!Shard)
+            pFirstLexicon = pLexicon;
+        pLastLexicon = pLexicon;
+    }
+
+    printf("shard learning: %.2f sec (slowest shard)\n", MaxTime);
+
+    // merge
+
+    string MergedFile = Prefix + ".merged.snap";
+
+    Time = NowSecs();
+
+    if(!CCCLLexicon::MergeSnapshots(ShardFiles, MergedFile, Error)) {
+        fprintf(stderr, "%s\n", Error.c_str());
+        return 1;
+    }
+
+    Time = NowSecs() - Time;
+
+    CpCCCLLexicon pMergedLexicon = new CCCLLexicon();
+
+    if(!pMergedLexicon->Load(MergedFile, Error)) {
+        fprintf(stderr, "%s\n", Error.c_str());
+        return 1;
+    }
+
+    printf("merging: %.2f sec, %u entries\n\n", Time,
+           pMergedLexicon->NumElements());
+
+    // compare with the sequential lexicon
+
+    printf("%-16s %10s %10s %10s %10s\n", "vs. sequential", "precision",
+           "recall", "F1", "identical");
+    Compare("merged", Utterances, pMergedLexicon, pSeqLexicon);
+    Compare("first shard", Utterances, pFirstLexicon, pSeqLexicon);
+    Compare("last shard", Utterances, pLastLexicon, pSeqLexicon);
+
+    return 0;
+}
+
+int
+main(int ac, char** av)
+{
+    if(ac > 1 && string(av[1]) == "-x") {
+        if(ac != 5)
+            return Usage(av[0]);
+        return Experiment(atoi(av[2]), av[3], av[4]);
+    }
+
+    if(ac < 3)
+        return Usage(av[0]);
+
+    return Merge(vector<string>(av + 2, av + ac), av[1]);
+}
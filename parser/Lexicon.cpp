@@ -15,11 +15,21 @@
 // along with CCL-Parser.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <algorithm>
+#if __cplusplus >= 201103L
+#include <thread>
+#endif
 #include "Lexicon.h"
 #include "ListPrint.h"
+#include "Globals.h"
+#include "Intern.h"
 
 using namespace std;
 
+// size (in characters) of the buffer used when printing the lexicon
+#define LEX_PRINT_BUFFER_SIZE (1 << 16)
+// minimal number of entries per thread when sorting the lexicon in parallel
+#define LEX_PRINT_MIN_THREAD_SORT 4096
+
 /////////////////////////////
 // Base String Key Lexicon //
 /////////////////////////////
@@ -29,6 +39,10 @@ CStrLexicon::CStrLexicon() : CLexHash(LEX_DEFAULT_HASH_SIZE)
 #ifdef DETAILED_DEBUG
     IncObjCount();
 #endif
+    // pre-size the table if the vocabulary size is known in advance
+    if(g_LexHashSize)
+        Reserve(g_LexHashSize);
+    SetIncrementalResize(g_LexIncrementalResize != 0);
 }
 
 CStrLexicon::~CStrLexicon()
@@ -38,72 +52,205 @@ CStrLexicon::~CStrLexicon()
 #endif
 }
 
-CStrKey*
-CStrLexicon::GetKeyByString(string const& Name)
+CLexPos
+CStrLexicon::FindOrCreate(string const& Name)
 {
     if(Name == "")
-        return NULL;
+        return CLexPos();
     
-    CpCStrKey pName = new CStrKey(Name); 
+    // If the name is already interned, its interned key is used, so that
+    // the lexicon key is also the interned key of the string.
+    CpCStrKey pName = CInternTable::Find(Name.data(), Name.length());
+
+    if(!pName)
+        pName = new CStrKey(Name); 
 
     // Is the name in the lexicon ?
     
-    if(!(*this)[*pName].Found()) {
-        // name not in lexicon, create new entry
-        Insert(NewEmptyLexEntry());
+    CLexPos Pos = FindOrInsert(*pName);
+
+    if(!Pos.Val()) {
+        // name not in lexicon, create new entry (and intern the name, if
+        // not yet interned)
+        SetVal(Pos, NewLexEntry(Name));
+        CInternTable::Intern(Pos.Key());
     }
 
+    return Pos;
+}
+
+CStrKey*
+CStrLexicon::GetKeyByString(string const& Name)
+{
     // return the key stored in lexicon
-    return Key();
+    return FindOrCreate(Name).Key();
 }
 
 CStrKey*
 CStrLexicon::GetEntryByString(std::string const& Name, CpCLexEntry& pEntry)
 {
-    if(!GetKeyByString(Name)) {
-        pEntry = NULL;
-        return NULL;
-    } else {
-        pEntry = Val();
-        // return the key stored in lexicon
-        return Key();
+    CLexPos Pos = FindOrCreate(Name);
+
+    pEntry = Pos.Val();
+    // return the key stored in lexicon
+    return Pos.Key();
+}
+
+CStrKey*
+CStrLexicon::FindEntryByString(std::string const& Name, CpCLexEntry& pEntry)
+{
+    CLexPos Pos;
+
+    if(Name != "") {
+        CStrKey Key(Name);
+        Pos = Find(Key);
+    }
+
+    pEntry = Pos.Val();
+    // return the key stored in lexicon
+    return Pos.Key();
+}
+
+// Matches the keys equal to the lower case version of a string
+// (see COpenHashTable::FindMatch())
+
+class CLowerStrMatch
+{
+private:
+    std::string const& m_Str;
+public:
+    CLowerStrMatch(std::string const& Str) : m_Str(Str) {}
+    bool operator()(CStrKey* pKey) {
+        return pKey->EqualLower(m_Str.data(), m_Str.length());
+    }
+};
+
+CStrKey*
+CStrLexicon::FindEntryByLowerString(std::string const& Name,
+                                    CLexEntry*& pEntry)
+{
+    CLexPos Pos;
+
+    if(Name != "") {
+        CLowerStrMatch Match(Name);
+        Pos = FindMatch(Match,
+                        CStrKey::StrHashLower(Name.data(), Name.length()));
+    }
+
+    pEntry = Pos.Val();
+    return Pos.Key();
+}
+
+void
+CStrLexicon::FreezeEntries()
+{
+    // complete any incremental resize, so that lookups only read the table
+    SetIncrementalResize(false);
+    
+    for(CpCLexIter Iter = Begin() ; *Iter ; ++(*Iter)) {
+        Iter->GetKey()->MakeImmortal();
+        if(Iter->GetVal())
+            Iter->GetVal()->Freeze();
     }
 }
 
 // sorted printing of the lexicon, with lower bound
 
+// Sort the given entries, using the given number of threads. The entries
+// are divided into (about) equal blocks which are sorted in parallel and
+// then merged. Only the sort is parallel: the entries are printed by the
+// calling thread (printing changes reference counts and uses the state
+// of the output stream, neither of which is thread safe).
+
+static void
+SortLexBlock(vector<LexPair>* pEntries, size_t Begin, size_t End,
+             tLexComp Comp)
+{
+    sort(pEntries->begin() + Begin, pEntries->begin() + End, Comp);
+}
+
+static void
+SortLexPairs(vector<LexPair>& Entries, tLexComp Comp, unsigned int Threads)
+{
+#if __cplusplus >= 201103L
+    // not worth the overhead of the threads for small lexicons
+    if(Threads > 1 && Entries.size() >= Threads * LEX_PRINT_MIN_THREAD_SORT) {
+        vector<size_t> Bounds;
+        for(unsigned int i = 0 ; i <= Threads ; i++)
+            Bounds.push_back(Entries.size() * i / Threads);
+
+        vector<std::thread> Sorters;
+        for(unsigned int i = 0 ; i < Threads ; i++)
+            Sorters.push_back(std::thread(SortLexBlock, &Entries,
+                                          Bounds[i], Bounds[i+1], Comp));
+        for(unsigned int i = 0 ; i < Threads ; i++)
+            Sorters[i].join();
+
+        // merge the sorted blocks pairwise
+        for(size_t Width = 1 ; Width < Threads ; Width *= 2)
+            for(size_t i = 0 ; i + Width < Threads ; i += 2 * Width)
+                inplace_merge(Entries.begin() + Bounds[i],
+                              Entries.begin() + Bounds[i+Width],
+                              Entries.begin() +
+                              Bounds[min(i + 2 * Width, (size_t)Threads)],
+                              Comp);
+        return;
+    }
+#endif
+    sort(Entries.begin(), Entries.end(), Comp);
+}
+
 bool
 CStrLexicon::PrintLexicon(CRefOStream* pOut)
 {
-    LexPair Array[NumElements()];
-    LexPair* Current = Array;
+    if(!pOut)
+        return false;
+
+    tLexComp Comp = PrintComp();
+    LexPair const& Bound = PrintBound();
+
+    // select the entries to be printed (those not below the bound)
+
+    vector<LexPair> Entries;
+
+    for(CpCLexIter pIter = Begin() ; *pIter ; ++(*pIter)) {
+        LexPair Entry(pIter->GetKey(), pIter->GetVal());
+        if(!Comp(Bound, Entry))
+            Entries.push_back(Entry);
+    }
+
+    // if only the strongest entries are printed, the others do not need
+    // to be sorted
     
-    CpCLexIter Iter = Begin();
-
-    // populate the array
-    while(*Iter) {
-        (*Current).first = Iter->GetKey();
-        (*Current).second = Iter->GetVal();
-        ++(*Iter);
-        ++Current;
+    if(g_LexMaxPrint && g_LexMaxPrint < Entries.size()) {
+        nth_element(Entries.begin(), Entries.begin() + g_LexMaxPrint,
+                    Entries.end(), Comp);
+        Entries.resize(g_LexMaxPrint);
     }
 
-    sort(Array, Array+NumElements(), PrintComp());
+    SortLexPairs(Entries, Comp, g_LexPrintThreads);
 
-    CListPrint LexList(pOut, 0, 0, 1, 0);
+    // The entries are printed into a buffer, which is written to the
+    // output stream whenever it is full.
+    
+    CpCRefOStrStream pBuffer = new CRefOStrStream();
+    CListPrint LexList(pBuffer, 0, 0, 1, 0);
     
-    for(Current = Array ; Current < Array+NumElements() ; Current++) {
-        if(PrintComp()(PrintBound(), *Current))
-            break;
+    for(vector<LexPair>::iterator Iter = Entries.begin() ;
+        Iter != Entries.end() ; Iter++) {
+
+        LexList << "\"" << (Iter->first->GetStr()) << "\" ";
+        if(Iter->second->Count() >= 0)
+            LexList << "(" << (Iter->second->Count()) << ")";
 
-        LexList << "\"" << ((*Current).first->GetStr()) << "\" ";
-        if((*Current).second->Count() >= 0)
-            LexList << "(" << ((*Current).second->Count()) << ")";
+        LexList.PrintNextEntry(Iter->second, 0);
 
-        LexList.PrintNextEntry((*Current).second.Ptr(),0);
+        if(pBuffer->Size() >= LEX_PRINT_BUFFER_SIZE)
+            pBuffer->WriteTo(*pOut);
     }
 
     LexList.CloseList();
+    pBuffer->WriteTo(*pOut);
 
     return true;
 }
@@ -74,9 +74,12 @@ INCDIRS				+=	$(MROOT)/include
 
 INCLUDES			=	$(INCDIRS:%=-I%)
 
-CPPFLAGS			=	$(COPT) $(CDEBUG) $(INCLUDES)
+# Additional definitions may be given in CDEFS (e.g. -DATOMIC_REF_COUNT
+# for multi-threaded builds, see 'make stress' in the top directory)
 
-LINKER_FLAGS		=	-lc
+CPPFLAGS			=	$(COPT) $(CDEBUG) $(CDEFS) $(INCLUDES)
+
+LINKER_FLAGS		=	-lc -lpthread
 
 
 CREATE_DIRECTORIES	+=	$O